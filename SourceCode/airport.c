@@ -0,0 +1,58 @@
+/* airport.c
+ This file instantiates the hash table and the tree of generic.h
+ for the airport records, with the AIRPORT policy of header.h. A
+ code has at most three letters, so it is packed into one unsigned
+ integer (CODE_KEY) whose order is the same as strcmp on the code:
+ comparing two codes becomes a single integer comparison. hash.c
+ and bstADT.c wrap these functions with the filter, the latency
+ counters and the error handling of the program.
+
+ Functions:
+ airportHashCreate
+ airportHashInsert
+ airportHashFind
+ airportHashRemove
+ airportHashResize
+ airportHashValues
+ airportHashDestroy
+ airportTreeCreate
+ airportTreeInsert
+ airportTreeBuild
+ airportTreeRemove
+ airportTreeFind
+ airportTreeTraverse
+ airportTreeDestroy
+ retrieveCode
+
+ Private Functions:
+ the passes of airportHashResize and the recursive steps of
+ airportTreeBuild, airportTreeRemove and airportTreeTraverse
+ (see generic.h)
+
+ */
+
+#include "header.h"
+
+DEFINE_HASH(AIRPORT, airportHash, HASH, HASH_NODE, COLLISION, CHAIN_LINK)
+
+DEFINE_TREE(AIRPORT, airportTree, BST_TREE, NODE, NODE_LINK)
+
+
+/*	================== retrieveCode =================
+ Searches the tree for a packed code and times the
+ search.
+ Pre		tree - pointer to the tree
+ key - CODE_KEY of the searched code
+ Return	pointer to the record or NULL if not found
+ */
+void* retrieveCode (BST_TREE* tree, unsigned key)
+{
+	//	Local Declarations
+    void* pFound;
+    unsigned long long start = latencyStart();
+
+	//	Statements
+    pFound = airportTreeFind(tree, key);
+    latencyRecord(LAT_TREE_SEARCH, start);
+    return pFound;
+}	// retrieveCode
@@ -0,0 +1,510 @@
+/* asyncfile.c
+ This file contains the definitons of the functions that read
+ and write the data files in large blocks without waiting for
+ the disk. On Linux the blocks go through an io_uring: a reader
+ keeps ASYNC_DEPTH - 1 reads in flight ahead of the block being
+ parsed, and a writer hands a full block to the kernel and goes
+ on formatting into the next one. Where io_uring is missing
+ (other systems, old kernels, or a ring that cannot be set up)
+ the same functions use plain fread and fwrite.
+
+ Functions:
+ asyncOpen
+ asyncLine
+ asyncWrite
+ asyncClose
+
+ Private Functions:
+ _nextBlock
+ _flushBlock
+ _ringCreate
+ _ringDestroy
+ _ringSubmit
+ _ringWait
+ _ringRestart
+ */
+
+#include "header.h"
+#ifdef __linux__
+#include <linux/io_uring.h>
+#ifdef IORING_OFF_SQES                  // headers of a kernel with io_uring (5.1)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <errno.h>
+#define ASYNC_RING
+#endif
+#endif
+
+#ifdef ASYNC_RING
+//	State of the io_uring of one file
+typedef struct{
+    int       ringFd;
+    int       fileFd;
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned* sqMask;
+    unsigned* sqArray;
+    struct io_uring_sqe* sqes;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned* cqMask;
+    struct io_uring_cqe* cqes;
+    void*     sqMap;
+    size_t    sqMapSize;
+    void*     cqMap;
+    size_t    cqMapSize;
+    size_t    sqesSize;
+    struct iovec vectors[ASYNC_DEPTH];  // buffer of the request of each block
+    bool      pending[ASYNC_DEPTH];     // request of the block in flight
+    bool      done[ASYNC_DEPTH];
+    int       result[ASYNC_DEPTH];
+}ASYNC_RING_STATE;
+
+static ASYNC_RING_STATE* _ringCreate (FILE* fp);
+static void _ringDestroy (ASYNC_RING_STATE* pRing);
+static void _ringSubmit (ASYNC_FILE* pFile, int block, int length);
+static int _ringWait (ASYNC_FILE* pFile, int block);
+static void _ringRestart (ASYNC_FILE* pFile, long long offset);
+#endif
+
+static bool _nextBlock (ASYNC_FILE* pFile);
+static void _flushBlock (ASYNC_FILE* pFile);
+
+/*	================== asyncOpen =================
+ This function opens a file for block reading or
+ writing. A reader starts its first reads at once.
+ Pre		fileName - name of the file
+ write - true to create the file for writing
+ Post		file is open
+ Return	pointer to the open file or
+ NULL if the file cannot be opened
+ */
+ASYNC_FILE* asyncOpen (const char* fileName, bool write)
+{
+	//	Local Declarations
+    ASYNC_FILE* pFile;
+    FILE* fp;
+#ifdef ASYNC_RING
+    int b;
+#endif
+
+	//	Statements
+    if (!(fp = fopen(fileName, write ? "wb" : "rb")))
+        return NULL;
+    if (!(pFile = (ASYNC_FILE*) memCalloc(MEM_HEADER, 1, sizeof(ASYNC_FILE))) ||
+        !(pFile->buffers = (char*) memAlloc(MEM_INDEX, ASYNC_DEPTH * ASYNC_BLOCK))) {
+        printf("Error allocating file buffers\n");
+        exit(170);
+    }
+    pFile->fp = fp;
+    pFile->write = write;
+    pFile->current = write ? 0 : ASYNC_DEPTH - 1;
+    pFile->pRing = NULL;
+
+#ifdef ASYNC_RING
+    if ((pFile->pRing = _ringCreate(fp)) && !write)
+    {
+        // every block but the current one is read ahead
+        for (b = 0; b < ASYNC_DEPTH - 1; b++) {
+            pFile->offsets[b] = pFile->nextOffset;
+            pFile->nextOffset += ASYNC_BLOCK;
+            _ringSubmit(pFile, b, ASYNC_BLOCK);
+        }
+    }
+#endif
+    return pFile;
+}	// asyncOpen
+
+
+/*	================== asyncLine =================
+ This function reads the next line of a file opened
+ for reading, like fgets.
+ Pre		pFile - file opened by asyncOpen
+ line - receives the line with its '\n'
+ size - size of line
+ Post		line is '\0' terminated, a longer line is
+ cut and the rest comes with the next call
+ Return	true if a line was read
+ false at the end of the file
+ */
+bool asyncLine (ASYNC_FILE* pFile, char* line, int size)
+{
+	//	Local Declarations
+    int count = 0;
+    char c = '\0';
+
+	//	Statements
+    while (count < size - 1 && c != '\n')
+    {
+        if (pFile->position >= pFile->lengths[pFile->current] && !_nextBlock(pFile))
+            break;
+        c = pFile->buffers[pFile->current * ASYNC_BLOCK + pFile->position++];
+        line[count++] = c;
+    }
+    line[count] = '\0';
+    return count > 0;
+}	// asyncLine
+
+
+/*	================== asyncWrite =================
+ This function adds text to a file opened for writing.
+ Every full block is written in the background while
+ the next one is filled.
+ Pre		pFile - file opened by asyncOpen
+ text - bytes to be written
+ length - number of bytes
+ Post		text is buffered or written
+ Return
+ */
+void asyncWrite (ASYNC_FILE* pFile, const char* text, int length)
+{
+	//	Local Declarations
+    int part;
+
+	//	Statements
+    while (length > 0)
+    {
+        part = ASYNC_BLOCK - pFile->position;
+        if (part > length)
+            part = length;
+        memcpy(pFile->buffers + pFile->current * ASYNC_BLOCK + pFile->position, text, part);
+        pFile->position += part;
+        text += part;
+        length -= part;
+        if (pFile->position == ASYNC_BLOCK)
+            _flushBlock(pFile);
+    }
+    return;
+}	// asyncWrite
+
+
+/*	================== asyncClose =================
+ This function writes what is left in the buffers,
+ waits for every request still in flight and closes
+ the file.
+ Pre		pFile - file opened by asyncOpen
+ Post		file is closed and freed
+ Return	true if every write succeeded
+ */
+bool asyncClose (ASYNC_FILE* pFile)
+{
+	//	Local Declarations
+    bool success;
+#ifdef ASYNC_RING
+    int b;
+#endif
+
+	//	Statements
+    if (pFile->write && pFile->position > 0)
+        _flushBlock(pFile);
+#ifdef ASYNC_RING
+    if (pFile->pRing)
+    {
+        for (b = 0; b < ASYNC_DEPTH; b++)
+            if (((ASYNC_RING_STATE*) pFile->pRing)->pending[b])
+                _ringWait(pFile, b);
+        _ringDestroy((ASYNC_RING_STATE*) pFile->pRing);
+    }
+#endif
+    if (fclose(pFile->fp) != 0)
+        pFile->failed = true;
+    success = !pFile->failed;
+
+    memFree(MEM_INDEX, pFile->buffers, ASYNC_DEPTH * ASYNC_BLOCK);
+    memFree(MEM_HEADER, pFile, sizeof(ASYNC_FILE));
+    return success;
+}	// asyncClose
+
+
+/*	================== _nextBlock =================
+ Makes the next block of the file the current one.
+ With a ring the block just used is sent for the read
+ after the last one in flight.
+ Return	false at the end of the file
+ */
+static bool _nextBlock (ASYNC_FILE* pFile)
+{
+	//	Local Declarations
+    int length;
+
+	//	Statements
+    pFile->position = 0;
+    if (pFile->atEnd)
+        return false;
+#ifdef ASYNC_RING
+    if (pFile->pRing)
+    {
+        pFile->offsets[pFile->current] = pFile->nextOffset;
+        pFile->nextOffset += ASYNC_BLOCK;
+        _ringSubmit(pFile, pFile->current, ASYNC_BLOCK);
+
+        pFile->current = (pFile->current + 1) % ASYNC_DEPTH;
+        if ((length = _ringWait(pFile, pFile->current)) < 0) {
+            printf("Error reading input file\n");
+            exit(171);
+        }
+        pFile->lengths[pFile->current] = length;
+        // a short read before the end: the reads behind it start too far
+        if (length > 0 && length < ASYNC_BLOCK)
+            _ringRestart(pFile, pFile->offsets[pFile->current] + length);
+        pFile->atEnd = length == 0;
+        return length > 0;
+    }
+#endif
+    pFile->current = 0;
+    length = (int) fread(pFile->buffers, 1, ASYNC_BLOCK, pFile->fp);
+    pFile->lengths[0] = length;
+    pFile->atEnd = length == 0;
+    return length > 0;
+}	// _nextBlock
+
+
+/*	================== _flushBlock =================
+ Writes the current block and moves to the next one.
+ With a ring the write is only started; the next block
+ is reused once its own earlier write has finished.
+ */
+static void _flushBlock (ASYNC_FILE* pFile)
+{
+	//	Statements
+#ifdef ASYNC_RING
+    if (pFile->pRing)
+    {
+        pFile->offsets[pFile->current] = pFile->nextOffset;
+        pFile->lengths[pFile->current] = pFile->position;
+        pFile->nextOffset += pFile->position;
+        _ringSubmit(pFile, pFile->current, pFile->position);
+
+        pFile->current = (pFile->current + 1) % ASYNC_DEPTH;
+        if (((ASYNC_RING_STATE*) pFile->pRing)->pending[pFile->current])
+            _ringWait(pFile, pFile->current);
+        pFile->position = 0;
+        return;
+    }
+#endif
+    if (fwrite(pFile->buffers, 1, pFile->position, pFile->fp) != (size_t) pFile->position)
+        pFile->failed = true;
+    pFile->position = 0;
+    return;
+}	// _flushBlock
+
+
+#ifdef ASYNC_RING
+/*	================== _ringCreate =================
+ Sets up an io_uring for the file and maps its queues.
+ The blocks are read and written with READV and WRITEV,
+ which every kernel with io_uring (5.1 on) supports.
+ Return	ring state, or NULL when io_uring cannot be used
+ */
+static ASYNC_RING_STATE* _ringCreate (FILE* fp)
+{
+	//	Local Declarations
+    struct io_uring_params params;
+    ASYNC_RING_STATE* pRing;
+    char* sq;
+    char* cq;
+
+	//	Statements
+    memset(&params, 0, sizeof(params));
+    if (!(pRing = (ASYNC_RING_STATE*) memCalloc(MEM_HEADER, 1, sizeof(ASYNC_RING_STATE))))
+        return NULL;
+    pRing->ringFd = (int) syscall(__NR_io_uring_setup, ASYNC_DEPTH, &params);
+    if (pRing->ringFd < 0) {
+        memFree(MEM_HEADER, pRing, sizeof(ASYNC_RING_STATE));
+        return NULL;
+    }
+
+    pRing->sqMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    pRing->cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+#ifdef IORING_FEAT_SINGLE_MMAP
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (pRing->cqMapSize > pRing->sqMapSize)
+            pRing->sqMapSize = pRing->cqMapSize;
+        pRing->cqMapSize = 0;
+    }
+#endif
+    pRing->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    pRing->sqMap = mmap(NULL, pRing->sqMapSize, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, pRing->ringFd, IORING_OFF_SQ_RING);
+    pRing->cqMap = pRing->cqMapSize == 0 ? pRing->sqMap :
+                   mmap(NULL, pRing->cqMapSize, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, pRing->ringFd, IORING_OFF_CQ_RING);
+    pRing->sqes = (struct io_uring_sqe*) mmap(NULL, pRing->sqesSize, PROT_READ | PROT_WRITE,
+                                              MAP_SHARED | MAP_POPULATE, pRing->ringFd, IORING_OFF_SQES);
+    if (pRing->sqMap == MAP_FAILED || pRing->cqMap == MAP_FAILED || pRing->sqes == MAP_FAILED) {
+        // give back what was mapped; the file falls back to stdio
+        if (pRing->sqes != MAP_FAILED)
+            munmap(pRing->sqes, pRing->sqesSize);
+        if (pRing->cqMapSize > 0 && pRing->cqMap != MAP_FAILED)
+            munmap(pRing->cqMap, pRing->cqMapSize);
+        if (pRing->sqMap != MAP_FAILED)
+            munmap(pRing->sqMap, pRing->sqMapSize);
+        close(pRing->ringFd);
+        memFree(MEM_HEADER, pRing, sizeof(ASYNC_RING_STATE));
+        return NULL;
+    }
+
+    sq = (char*) pRing->sqMap;
+    cq = (char*) pRing->cqMap;
+    pRing->sqHead = (unsigned*) (sq + params.sq_off.head);
+    pRing->sqTail = (unsigned*) (sq + params.sq_off.tail);
+    pRing->sqMask = (unsigned*) (sq + params.sq_off.ring_mask);
+    pRing->sqArray = (unsigned*) (sq + params.sq_off.array);
+    pRing->cqHead = (unsigned*) (cq + params.cq_off.head);
+    pRing->cqTail = (unsigned*) (cq + params.cq_off.tail);
+    pRing->cqMask = (unsigned*) (cq + params.cq_off.ring_mask);
+    pRing->cqes = (struct io_uring_cqe*) (cq + params.cq_off.cqes);
+    pRing->fileFd = fileno(fp);
+    return pRing;
+}	// _ringCreate
+
+
+/*	================== _ringDestroy =================
+ Unmaps the queues and closes the ring.
+ Pre		no request is in flight
+ */
+static void _ringDestroy (ASYNC_RING_STATE* pRing)
+{
+	//	Statements
+    munmap(pRing->sqes, pRing->sqesSize);
+    if (pRing->cqMapSize > 0)
+        munmap(pRing->cqMap, pRing->cqMapSize);
+    munmap(pRing->sqMap, pRing->sqMapSize);
+    close(pRing->ringFd);
+    memFree(MEM_HEADER, pRing, sizeof(ASYNC_RING_STATE));
+    return;
+}	// _ringDestroy
+
+
+/*	================== _ringSubmit =================
+ Starts the read (or write) of a block at the offset
+ stored for it. If the kernel does not take the
+ request, it is taken back from the queue and the
+ block is read (or written) at once with pread (or
+ pwrite), so _ringWait finds it already done.
+ */
+static void _ringSubmit (ASYNC_FILE* pFile, int block, int length)
+{
+	//	Local Declarations
+    ASYNC_RING_STATE* pRing = (ASYNC_RING_STATE*) pFile->pRing;
+    struct io_uring_sqe* pEntry;
+    char* buffer = pFile->buffers + block * ASYNC_BLOCK;
+    unsigned tail;
+    unsigned index;
+    long entered;
+    ssize_t result;
+
+	//	Statements
+    tail = *pRing->sqTail;
+    index = tail & *pRing->sqMask;
+    pEntry = &pRing->sqes[index];
+    memset(pEntry, 0, sizeof(*pEntry));
+    pRing->vectors[block].iov_base = buffer;
+    pRing->vectors[block].iov_len = length;
+    pEntry->opcode = pFile->write ? IORING_OP_WRITEV : IORING_OP_READV;
+    pEntry->fd = pRing->fileFd;
+    pEntry->addr = (unsigned long) &pRing->vectors[block];
+    pEntry->len = 1;
+    pEntry->off = pFile->offsets[block];
+    pEntry->user_data = block;
+    pRing->sqArray[index] = index;
+    __atomic_store_n(pRing->sqTail, tail + 1, __ATOMIC_RELEASE);
+
+    pRing->pending[block] = true;
+    pRing->done[block] = false;
+    while ((entered = syscall(__NR_io_uring_enter, pRing->ringFd, 1, 0, 0, NULL, 0)) < 0 &&
+           errno == EINTR)
+        ;
+    if (entered < 1 && __atomic_load_n(pRing->sqHead, __ATOMIC_ACQUIRE) == tail)
+    {
+        __atomic_store_n(pRing->sqTail, tail, __ATOMIC_RELEASE);
+        if (pFile->write)
+            result = pwrite(pRing->fileFd, buffer, length, pFile->offsets[block]);
+        else
+            result = pread(pRing->fileFd, buffer, length, pFile->offsets[block]);
+        pRing->done[block] = true;
+        pRing->result[block] = result < 0 ? -errno : (int) result;
+    }
+    return;
+}	// _ringSubmit
+
+
+/*	================== _ringWait =================
+ Waits for the request of a block, collecting the
+ others that finish first. If the kernel cannot be
+ waited on, the block fails with -errno. A write that
+ went through only in part (or failed) is completed
+ with plain writes.
+ Return	result of the request (bytes, or -errno)
+ */
+static int _ringWait (ASYNC_FILE* pFile, int block)
+{
+	//	Local Declarations
+    ASYNC_RING_STATE* pRing = (ASYNC_RING_STATE*) pFile->pRing;
+    struct io_uring_cqe* pEvent;
+    unsigned head;
+    int result;
+    int done;
+
+	//	Statements
+    while (!pRing->done[block])
+    {
+        head = *pRing->cqHead;
+        if (head == __atomic_load_n(pRing->cqTail, __ATOMIC_ACQUIRE)) {
+            if (syscall(__NR_io_uring_enter, pRing->ringFd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 &&
+                errno != EINTR) {
+                pRing->done[block] = true;
+                pRing->result[block] = -errno;
+            }
+            continue;
+        }
+        pEvent = &pRing->cqes[head & *pRing->cqMask];
+        pRing->done[pEvent->user_data] = true;
+        pRing->result[pEvent->user_data] = pEvent->res;
+        __atomic_store_n(pRing->cqHead, head + 1, __ATOMIC_RELEASE);
+    }
+    pRing->pending[block] = false;
+    result = pRing->result[block];
+
+    if (pFile->write && result != pFile->lengths[block])
+    {
+        done = result < 0 ? 0 : result;
+        while (done < pFile->lengths[block] &&
+               (result = (int) pwrite(pRing->fileFd, pFile->buffers + block * ASYNC_BLOCK + done,
+                                      pFile->lengths[block] - done, pFile->offsets[block] + done)) > 0)
+            done += result;
+        if (done < pFile->lengths[block])
+            pFile->failed = true;
+        result = done;
+    }
+    return result;
+}	// _ringWait
+
+
+/*	================== _ringRestart =================
+ Waits out the reads in flight and starts them again
+ from the given offset, behind the current block.
+ */
+static void _ringRestart (ASYNC_FILE* pFile, long long offset)
+{
+	//	Local Declarations
+    int block;
+    int b;
+
+	//	Statements
+    for (b = 1; b < ASYNC_DEPTH; b++)
+    {
+        block = (pFile->current + b) % ASYNC_DEPTH;
+        if (((ASYNC_RING_STATE*) pFile->pRing)->pending[block])
+            _ringWait(pFile, block);
+        pFile->offsets[block] = offset;
+        offset += ASYNC_BLOCK;
+        _ringSubmit(pFile, block, ASYNC_BLOCK);
+    }
+    pFile->nextOffset = offset;
+    return;
+}	// _ringRestart
+#endif
@@ -0,0 +1,652 @@
+/* cityindex.c
+ This file contains the definitons of the functions to maintain
+ and search the index of airports by city. The index keeps one
+ entry per distinct city name, sorted by the name without regard
+ to case, and each entry lists the records in that city. Exact
+ and prefix searches are binary searches over the entries; the
+ fuzzy search allows a few typing mistakes.
+
+ For the fuzzy search every name is also listed under each of
+ its three letter groups (trigrams, the name padded with two
+ marks on each side, case folded). A name within k mistakes of
+ a query of length n shares at least n + 2 - 3k trigrams with
+ it, so only the names reaching that count in the lists of the
+ query's trigrams are compared letter by letter. Queries too
+ short for the count to rule anything out compare every name.
+ The trigram lists are built by the first fuzzy search and then
+ kept up to date with the entries.
+
+ Functions:
+ cityIndexCreate
+ cityIndexAdd
+ cityIndexRemove
+ citySearch
+ cityIndexDestroy
+
+ Private Functions:
+ _compareFolded
+ _lowerBound
+ _findEntry
+ _editDistance
+ _collect
+ _fuzzySearch
+ _gramsOf
+ _findGram
+ _growGrams
+ _addGrams
+ _removeGrams
+ _compareHandles
+ */
+
+#include "header.h"
+
+#define CITY_INDEX_START  16
+#define CITY_MAX_NAME     128
+#define CITY_GRAM_START   256
+#define CITY_GRAM_PAD     1     // mark around a name, not a letter
+
+static int _compareFolded (const char* name1, const char* name2, int length);
+static int _lowerBound (CITY_INDEX* pIndex, const char* name);
+static int _findEntry (CITY_INDEX* pIndex, unsigned city);
+static int _editDistance (const char* name1, const char* name2, int limit);
+static int _collect (CITY_ENTRY* pEntry, DATA** results, int count, int maxResults);
+static int _fuzzySearch (CITY_INDEX* pIndex, const char* name, int limit,
+                         DATA** results, int maxResults);
+static int _gramsOf (const char* name, unsigned* grams);
+static CITY_GRAM* _findGram (CITY_INDEX* pIndex, unsigned gram, bool create);
+static void _growGrams (CITY_INDEX* pIndex);
+static void _addGrams (CITY_INDEX* pIndex, unsigned city);
+static void _removeGrams (CITY_INDEX* pIndex, unsigned city);
+static int _compareHandles (const void* handle1, const void* handle2);
+
+/*	================== cityIndexCreate =================
+ This function creates an empty city index.
+ Pre
+ Post		index is allocated
+ Return	pointer to the index
+ */
+CITY_INDEX* cityIndexCreate (void)
+{
+	//	Local Declarations
+    CITY_INDEX* pIndex;
+
+	//	Statements
+    if (!(pIndex = (CITY_INDEX*) memAlloc(MEM_HEADER, sizeof(CITY_INDEX))) ||
+        !(pIndex->entries = (CITY_ENTRY*) memAlloc(MEM_INDEX, CITY_INDEX_START * sizeof(CITY_ENTRY)))) {
+        printf("Error allocating city index\n");
+        exit(140);
+    }
+    pIndex->count = 0;
+    pIndex->capacity = CITY_INDEX_START;
+    pIndex->grams = NULL;
+    pIndex->gramSize = 0;
+    pIndex->countGrams = 0;
+
+    return pIndex;
+}	// cityIndexCreate
+
+
+/*	================== cityIndexAdd =================
+ This function adds a record under its city, creating
+ the entry of the city if it is the first record.
+ Pre		pIndex - pointer to the index
+ pData - record to be added
+ Post		record is listed under its city
+ Return
+ */
+void cityIndexAdd (CITY_INDEX* pIndex, DATA* pData)
+{
+	//	Local Declarations
+    CITY_ENTRY* pEntry;
+    CITY_ENTRY* newEntries;
+    DATA** newRecords;
+    int position;
+
+	//	Statements
+    position = _findEntry(pIndex, pData->city);
+    pEntry = &pIndex->entries[position];
+
+    if (position == pIndex->count || pEntry->city != pData->city)
+    {
+        if (pIndex->count == pIndex->capacity)
+        {
+            if (!(newEntries = (CITY_ENTRY*) memAlloc(MEM_INDEX, pIndex->capacity * 2 * sizeof(CITY_ENTRY)))) {
+                printf("Error allocating city index\n");
+                exit(140);
+            }
+            memcpy(newEntries, pIndex->entries, pIndex->count * sizeof(CITY_ENTRY));
+            memFree(MEM_INDEX, pIndex->entries, pIndex->capacity * sizeof(CITY_ENTRY));
+            pIndex->entries = newEntries;
+            pIndex->capacity *= 2;
+            pEntry = &pIndex->entries[position];
+        }
+        memmove(pEntry + 1, pEntry, (pIndex->count - position) * sizeof(CITY_ENTRY));
+        pIndex->count++;
+
+        pEntry->city = pData->city;
+        pEntry->countRecords = 0;
+        pEntry->capacity = 0;
+        pEntry->records = NULL;
+        if (pIndex->grams)
+            _addGrams(pIndex, pData->city);
+    }
+
+    if (pEntry->countRecords == pEntry->capacity)
+    {
+        if (!(newRecords = (DATA**) memAlloc(MEM_INDEX, (pEntry->capacity * 2 + 1) * sizeof(DATA*)))) {
+            printf("Error allocating city index\n");
+            exit(140);
+        }
+        if (pEntry->records)
+            memcpy(newRecords, pEntry->records, pEntry->countRecords * sizeof(DATA*));
+        memFree(MEM_INDEX, pEntry->records, pEntry->capacity * sizeof(DATA*));
+        pEntry->records = newRecords;
+        pEntry->capacity = pEntry->capacity * 2 + 1;
+    }
+    pEntry->records[pEntry->countRecords++] = pData;
+
+    return;
+}	// cityIndexAdd
+
+
+/*	================== cityIndexRemove =================
+ This function removes a record from the index. The
+ entry of the city is removed with its last record.
+ Pre		pIndex - pointer to the index
+ pData - record to be removed
+ Post		record is no longer listed
+ Return
+ */
+void cityIndexRemove (CITY_INDEX* pIndex, DATA* pData)
+{
+	//	Local Declarations
+    CITY_ENTRY* pEntry;
+    int position;
+    int i;
+
+	//	Statements
+    position = _findEntry(pIndex, pData->city);
+    if (position == pIndex->count || pIndex->entries[position].city != pData->city)
+        return;
+
+    pEntry = &pIndex->entries[position];
+    for (i = 0; i < pEntry->countRecords && pEntry->records[i] != pData; i++)
+        ;
+    if (i == pEntry->countRecords)
+        return;
+    memmove(&pEntry->records[i], &pEntry->records[i + 1],
+            (pEntry->countRecords - i - 1) * sizeof(DATA*));
+    pEntry->countRecords--;
+
+    if (pEntry->countRecords == 0)
+    {
+        if (pIndex->grams)
+            _removeGrams(pIndex, pEntry->city);
+        memFree(MEM_INDEX, pEntry->records, pEntry->capacity * sizeof(DATA*));
+        memmove(pEntry, pEntry + 1, (pIndex->count - position - 1) * sizeof(CITY_ENTRY));
+        pIndex->count--;
+    }
+    return;
+}	// cityIndexRemove
+
+
+/*	================== citySearch =================
+ This function finds the records of the cities that
+ match a name. Case is ignored.
+ Pre		pIndex - pointer to the index
+ name - name (or start of the name) searched
+ mode - CITY_EXACT : whole name matches
+ CITY_PREFIX : name starts with the query
+ CITY_FUZZY : at most a few letters differ
+ results - receives the matching records
+ maxResults - size of results
+ Post		results are filled in city order
+ Return	number of matching records (may be more
+ than maxResults)
+ */
+int citySearch (CITY_INDEX* pIndex, const char* name, CITY_MATCH mode,
+                DATA** results, int maxResults)
+{
+	//	Local Declarations
+    int count = 0;
+    int length;
+    int i;
+
+	//	Statements
+    length = (int) strlen(name);
+    if (mode == CITY_FUZZY)
+    {
+        // one mistake for short names, two for longer ones
+        return _fuzzySearch(pIndex, name, length < 6 ? 1 : 2, results, maxResults);
+    }
+
+    for (i = _lowerBound(pIndex, name); i < pIndex->count; i++)
+    {
+        if (mode == CITY_EXACT) {
+            if (_compareFolded(cityName(pIndex->entries[i].city), name, -1) != 0)
+                break;
+        }
+        else if (_compareFolded(cityName(pIndex->entries[i].city), name, length) != 0)
+            break;
+        count = _collect(&pIndex->entries[i], results, count, maxResults);
+    }
+    return count;
+}	// citySearch
+
+
+/*	================== cityIndexDestroy =================
+ This function frees the index.
+ Pre		pIndex - pointer to the index (may be NULL)
+ Post		index is freed
+ Return	NULL
+ */
+CITY_INDEX* cityIndexDestroy (CITY_INDEX* pIndex)
+{
+	//	Local Declarations
+    int i;
+
+	//	Statements
+    if (pIndex)
+    {
+        for (i = 0; i < pIndex->count; i++)
+            memFree(MEM_INDEX, pIndex->entries[i].records,
+                    pIndex->entries[i].capacity * sizeof(DATA*));
+        for (i = 0; i < pIndex->gramSize; i++)
+            memFree(MEM_INDEX, pIndex->grams[i].cities,
+                    pIndex->grams[i].capacity * sizeof(unsigned));
+        memFree(MEM_INDEX, pIndex->grams, pIndex->gramSize * sizeof(CITY_GRAM));
+        memFree(MEM_INDEX, pIndex->entries, pIndex->capacity * sizeof(CITY_ENTRY));
+        memFree(MEM_HEADER, pIndex, sizeof(CITY_INDEX));
+    }
+    return NULL;
+}	// cityIndexDestroy
+
+
+/*	================== _compareFolded =================
+ Compares two names without regard to case.
+ Pre		length - number of characters to compare,
+ or -1 for the whole names
+ Return	<0, 0 or >0 like strcmp
+ */
+static int _compareFolded (const char* name1, const char* name2, int length)
+{
+	//	Local Declarations
+    int diff;
+
+	//	Statements
+    for ( ; length != 0; length--, name1++, name2++)
+    {
+        diff = toupper((unsigned char) *name1) - toupper((unsigned char) *name2);
+        if (diff != 0 || *name1 == '\0')
+            return diff;
+    }
+    return 0;
+}	// _compareFolded
+
+
+/*	================== _lowerBound =================
+ Binary search for the first entry whose name is not
+ before the given name.
+ Return	position of that entry (count if none)
+ */
+static int _lowerBound (CITY_INDEX* pIndex, const char* name)
+{
+	//	Local Declarations
+    int low = 0;
+    int high = pIndex->count;
+    int middle;
+
+	//	Statements
+    while (low < high)
+    {
+        middle = (low + high) / 2;
+        if (_compareFolded(cityName(pIndex->entries[middle].city), name, -1) < 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}	// _lowerBound
+
+
+/*	================== _findEntry =================
+ Finds the entry of a city handle. Names that only
+ differ by case sort together, so the handle is looked
+ for among those.
+ Return	position of the entry, or the position where
+ it has to be inserted
+ */
+static int _findEntry (CITY_INDEX* pIndex, unsigned city)
+{
+	//	Local Declarations
+    const char* name;
+    int position;
+
+	//	Statements
+    name = cityName(city);
+    position = _lowerBound(pIndex, name);
+    while (position < pIndex->count && pIndex->entries[position].city != city &&
+           _compareFolded(cityName(pIndex->entries[position].city), name, -1) == 0)
+        position++;
+    return position;
+}	// _findEntry
+
+
+/*	================== _editDistance =================
+ Levenshtein distance between two names, ignoring case.
+ Gives up early once every path is over the limit.
+ Return	distance, or limit + 1 if it is over the limit
+ */
+static int _editDistance (const char* name1, const char* name2, int limit)
+{
+	//	Local Declarations
+    int previous[CITY_MAX_NAME + 1];
+    int current[CITY_MAX_NAME + 1];
+    int length1;
+    int length2;
+    int best;
+    int cost;
+    int i;
+    int j;
+
+	//	Statements
+    length1 = (int) strlen(name1);
+    length2 = (int) strlen(name2);
+    if (length1 > CITY_MAX_NAME || length2 > CITY_MAX_NAME ||
+        abs(length1 - length2) > limit)
+        return limit + 1;
+
+    for (j = 0; j <= length2; j++)
+        previous[j] = j;
+    for (i = 1; i <= length1; i++)
+    {
+        current[0] = best = i;
+        for (j = 1; j <= length2; j++)
+        {
+            cost = toupper((unsigned char) name1[i - 1]) != toupper((unsigned char) name2[j - 1]);
+            current[j] = previous[j - 1] + cost;
+            if (previous[j] + 1 < current[j])
+                current[j] = previous[j] + 1;
+            if (current[j - 1] + 1 < current[j])
+                current[j] = current[j - 1] + 1;
+            if (current[j] < best)
+                best = current[j];
+        }
+        if (best > limit)
+            return limit + 1;
+        memcpy(previous, current, (length2 + 1) * sizeof(int));
+    }
+    return previous[length2];
+}	// _editDistance
+
+
+/*	================== _collect =================
+ Appends the records of an entry to the results.
+ Return	new number of matching records
+ */
+static int _collect (CITY_ENTRY* pEntry, DATA** results, int count, int maxResults)
+{
+	//	Local Declarations
+    int i;
+
+	//	Statements
+    for (i = 0; i < pEntry->countRecords; i++, count++) {
+        if (count < maxResults)
+            results[count] = pEntry->records[i];
+    }
+    return count;
+}	// _collect
+
+
+/*	================== _fuzzySearch =================
+ Finds the cities within limit mistakes of the name.
+ The candidates are the names holding at least the
+ required number of the query's trigrams; each one is
+ then checked with _editDistance.
+ Return	number of matching records
+ */
+static int _fuzzySearch (CITY_INDEX* pIndex, const char* name, int limit,
+                         DATA** results, int maxResults)
+{
+	//	Local Declarations
+    unsigned grams[CITY_MAX_NAME + 2];
+    unsigned* candidates;
+    unsigned* positions;
+    CITY_GRAM* pGram;
+    int countGrams;
+    int countCandidates = 0;
+    int countPositions = 0;
+    int needed;
+    int count = 0;
+    int run;
+    int i;
+    int j;
+
+	//	Statements
+    countGrams = _gramsOf(name, grams);
+    needed = (int) strlen(name) + 2 - 3 * limit;
+    if (countGrams == 0 || needed <= 0)
+    {
+        for (i = 0; i < pIndex->count; i++) {
+            if (_editDistance(name, cityName(pIndex->entries[i].city), limit) <= limit)
+                count = _collect(&pIndex->entries[i], results, count, maxResults);
+        }
+        return count;
+    }
+
+    if (!pIndex->grams)
+        for (i = 0; i < pIndex->count; i++)
+            _addGrams(pIndex, pIndex->entries[i].city);
+
+    // every handle appears once per query trigram it holds
+    for (i = 0; i < countGrams; i++)
+        if ((pGram = _findGram(pIndex, grams[i], false)))
+            countCandidates += pGram->count;
+    if (!(candidates = (unsigned*) memAlloc(MEM_INDEX, (countCandidates + 1) * sizeof(unsigned))) ||
+        !(positions = (unsigned*) memAlloc(MEM_INDEX, (countCandidates + 1) * sizeof(unsigned)))) {
+        printf("Error allocating city index\n");
+        exit(140);
+    }
+    countCandidates = 0;
+    for (i = 0; i < countGrams; i++)
+        if ((pGram = _findGram(pIndex, grams[i], false))) {
+            memcpy(candidates + countCandidates, pGram->cities, pGram->count * sizeof(unsigned));
+            countCandidates += pGram->count;
+        }
+    qsort(candidates, countCandidates, sizeof(unsigned), _compareHandles);
+
+    for (i = 0; i < countCandidates; i = j)
+    {
+        for (j = i + 1; j < countCandidates && candidates[j] == candidates[i]; j++)
+            ;
+        run = j - i;
+        if (run >= needed && _editDistance(name, cityName(candidates[i]), limit) <= limit)
+            positions[countPositions++] = (unsigned) _findEntry(pIndex, candidates[i]);
+    }
+
+    // results in city order, like the other searches
+    qsort(positions, countPositions, sizeof(unsigned), _compareHandles);
+    for (i = 0; i < countPositions; i++)
+        count = _collect(&pIndex->entries[positions[i]], results, count, maxResults);
+
+    memFree(MEM_INDEX, candidates, (countCandidates + 1) * sizeof(unsigned));
+    memFree(MEM_INDEX, positions, (countCandidates + 1) * sizeof(unsigned));
+    return count;
+}	// _fuzzySearch
+
+
+/*	================== _gramsOf =================
+ Lists the trigrams of a name padded with two marks on
+ each side, letters folded to upper case.
+ Pre		grams - room for CITY_MAX_NAME + 2 trigrams
+ Return	number of trigrams (length + 2), 0 for a name
+ too long to be matched
+ */
+static int _gramsOf (const char* name, unsigned* grams)
+{
+	//	Local Declarations
+    unsigned gram = CITY_GRAM_PAD << 8 | CITY_GRAM_PAD;
+    int length;
+    int i;
+
+	//	Statements
+    length = (int) strlen(name);
+    if (length > CITY_MAX_NAME)
+        return 0;
+    for (i = 0; i < length + 2; i++)
+    {
+        gram = (gram << 8 | (i < length ? toupper((unsigned char) name[i]) : CITY_GRAM_PAD)) & 0xFFFFFF;
+        grams[i] = gram;
+    }
+    return length + 2;
+}	// _gramsOf
+
+
+/*	================== _findGram =================
+ Looks up the list of a trigram.
+ Pre		create - add an empty list if it is missing
+ Return	pointer to the list, or NULL if missing
+ */
+static CITY_GRAM* _findGram (CITY_INDEX* pIndex, unsigned gram, bool create)
+{
+	//	Local Declarations
+    CITY_GRAM* pGram;
+    unsigned slot;
+
+	//	Statements
+    if (create && (pIndex->countGrams + 1) * 2 > pIndex->gramSize)
+        _growGrams(pIndex);
+    if (pIndex->gramSize == 0)
+        return NULL;
+
+    slot = (gram * 2654435761u) & (pIndex->gramSize - 1);
+    while ((pGram = &pIndex->grams[slot])->gram != 0)
+    {
+        if (pGram->gram == gram)
+            return pGram;
+        slot = (slot + 1) & (pIndex->gramSize - 1);
+    }
+    if (!create)
+        return NULL;
+
+    pGram->gram = gram;
+    pIndex->countGrams++;
+    return pGram;
+}	// _findGram
+
+
+/*	================== _growGrams =================
+ Doubles the trigram table and places the lists again.
+ Pre		table is at least half full
+ Post		table is twice as large
+ */
+static void _growGrams (CITY_INDEX* pIndex)
+{
+	//	Local Declarations
+    CITY_GRAM* newGrams;
+    int newSize;
+    unsigned slot;
+    int i;
+
+	//	Statements
+    newSize = pIndex->gramSize ? pIndex->gramSize * 2 : CITY_GRAM_START;
+    if (!(newGrams = (CITY_GRAM*) memCalloc(MEM_INDEX, newSize, sizeof(CITY_GRAM)))) {
+        printf("Error allocating city index\n");
+        exit(140);
+    }
+
+    for (i = 0; i < pIndex->gramSize; i++)
+    {
+        if (pIndex->grams[i].gram != 0)
+        {
+            slot = (pIndex->grams[i].gram * 2654435761u) & (newSize - 1);
+            while (newGrams[slot].gram != 0)
+                slot = (slot + 1) & (newSize - 1);
+            newGrams[slot] = pIndex->grams[i];
+        }
+    }
+
+    memFree(MEM_INDEX, pIndex->grams, pIndex->gramSize * sizeof(CITY_GRAM));
+    pIndex->grams = newGrams;
+    pIndex->gramSize = newSize;
+    return;
+}	// _growGrams
+
+
+/*	================== _addGrams =================
+ Lists a city under each of its trigrams, once per
+ trigram even when the name holds it twice.
+ */
+static void _addGrams (CITY_INDEX* pIndex, unsigned city)
+{
+	//	Local Declarations
+    unsigned grams[CITY_MAX_NAME + 2];
+    unsigned* newCities;
+    CITY_GRAM* pGram;
+    int countGrams;
+    int i;
+
+	//	Statements
+    countGrams = _gramsOf(cityName(city), grams);
+    for (i = 0; i < countGrams; i++)
+    {
+        pGram = _findGram(pIndex, grams[i], true);
+        if (pGram->count > 0 && pGram->cities[pGram->count - 1] == city)
+            continue;
+        if (pGram->count == pGram->capacity)
+        {
+            if (!(newCities = (unsigned*) memAlloc(MEM_INDEX, (pGram->capacity * 2 + 1) * sizeof(unsigned)))) {
+                printf("Error allocating city index\n");
+                exit(140);
+            }
+            if (pGram->cities)
+                memcpy(newCities, pGram->cities, pGram->count * sizeof(unsigned));
+            memFree(MEM_INDEX, pGram->cities, pGram->capacity * sizeof(unsigned));
+            pGram->cities = newCities;
+            pGram->capacity = pGram->capacity * 2 + 1;
+        }
+        pGram->cities[pGram->count++] = city;
+    }
+    return;
+}	// _addGrams
+
+
+/*	================== _removeGrams =================
+ Takes a city out of the lists of its trigrams. The
+ lists are not ordered, so the last handle fills the
+ hole. Empty lists stay in the table.
+ */
+static void _removeGrams (CITY_INDEX* pIndex, unsigned city)
+{
+	//	Local Declarations
+    unsigned grams[CITY_MAX_NAME + 2];
+    CITY_GRAM* pGram;
+    int countGrams;
+    int i;
+    int j;
+
+	//	Statements
+    countGrams = _gramsOf(cityName(city), grams);
+    for (i = 0; i < countGrams; i++)
+    {
+        if (!(pGram = _findGram(pIndex, grams[i], false)))
+            continue;
+        for (j = 0; j < pGram->count && pGram->cities[j] != city; j++)
+            ;
+        if (j < pGram->count)
+            pGram->cities[j] = pGram->cities[--pGram->count];
+    }
+    return;
+}	// _removeGrams
+
+
+/*	================== _compareHandles =================
+ qsort order of handles and positions: smallest first.
+ */
+static int _compareHandles (const void* handle1, const void* handle2)
+{
+	//	Statements
+    if (*(const unsigned*) handle1 < *(const unsigned*) handle2)
+        return -1;
+    return *(const unsigned*) handle1 > *(const unsigned*) handle2;
+}	// _compareHandles
@@ -0,0 +1,307 @@
+/* column.c
+ This file contains the definitons of the functions to maintain
+ and scan the column store. The column store keeps the code,
+ latitude, longitude and city handle of every airport in
+ parallel arrays, one row per airport. Each record remembers
+ its row, so the hash table (findHash) also serves as the map
+ from a code to its row. Predicates on the coordinates are
+ checked four rows at a time with SSE when it is available.
+
+ Functions:
+ columnCreate
+ columnAdd
+ columnRemove
+ columnUpdate
+ columnScan
+ columnDestroy
+
+ Private Functions:
+ _growColumn
+ _scanBlock
+ _firstBit
+ */
+
+#include "header.h"
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define COLUMN_SSE
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#define COLUMN_START  64
+#define COLUMN_BLOCK  64    // rows checked per bit mask
+
+static void* _growColumn (void* column, size_t size, int count, int capacity, int newCapacity);
+static unsigned long long _scanBlock (COLUMNS* pColumns, PREDICATE* predicates,
+                                      int countPredicates, int first, int countRows);
+static int _firstBit (unsigned long long mask);
+
+/*	================== columnCreate =================
+ This function creates an empty column store.
+ Pre
+ Post		columns are allocated
+ Return	pointer to the column store
+ */
+COLUMNS* columnCreate (void)
+{
+	//	Local Declarations
+    COLUMNS* pColumns;
+
+	//	Statements
+    if (!(pColumns = (COLUMNS*) memCalloc(MEM_HEADER, 1, sizeof(COLUMNS)))) {
+        printf("Error allocating column store\n");
+        exit(150);
+    }
+    return pColumns;
+}	// columnCreate
+
+
+/*	================== columnAdd =================
+ This function appends the row of a new record.
+ Pre		pColumns - pointer to the column store
+ pData - record to be added
+ Post		record is the last row, pData->row is set
+ Return
+ */
+void columnAdd (COLUMNS* pColumns, DATA* pData)
+{
+	//	Local Declarations
+    int newCapacity;
+    int row;
+
+	//	Statements
+    if (pColumns->count == pColumns->capacity)
+    {
+        newCapacity = pColumns->capacity ? pColumns->capacity * 2 : COLUMN_START;
+        pColumns->codes = (char*) _growColumn(pColumns->codes, 4,
+                                              pColumns->count, pColumns->capacity, newCapacity);
+        pColumns->latitude = (float*) _growColumn(pColumns->latitude, sizeof(float),
+                                                  pColumns->count, pColumns->capacity, newCapacity);
+        pColumns->longitude = (float*) _growColumn(pColumns->longitude, sizeof(float),
+                                                   pColumns->count, pColumns->capacity, newCapacity);
+        pColumns->city = (unsigned*) _growColumn(pColumns->city, sizeof(unsigned),
+                                                 pColumns->count, pColumns->capacity, newCapacity);
+        pColumns->records = (DATA**) _growColumn(pColumns->records, sizeof(DATA*),
+                                                 pColumns->count, pColumns->capacity, newCapacity);
+        pColumns->capacity = newCapacity;
+    }
+
+    row = pColumns->count++;
+    memcpy(pColumns->codes + row * 4, pData->arpCode, 4);
+    pColumns->latitude[row] = pData->latitude;
+    pColumns->longitude[row] = pData->longitude;
+    pColumns->city[row] = pData->city;
+    pColumns->records[row] = pData;
+    pData->row = row;
+    return;
+}	// columnAdd
+
+
+/*	================== columnRemove =================
+ This function removes the row of a record. The last
+ row is moved into the hole so the columns stay dense.
+ Pre		pColumns - pointer to the column store
+ pData - record to be removed
+ Post		row is removed
+ Return
+ */
+void columnRemove (COLUMNS* pColumns, DATA* pData)
+{
+	//	Local Declarations
+    int row = pData->row;
+    int last;
+
+	//	Statements
+    last = --pColumns->count;
+    if (row != last)
+    {
+        memcpy(pColumns->codes + row * 4, pColumns->codes + last * 4, 4);
+        pColumns->latitude[row] = pColumns->latitude[last];
+        pColumns->longitude[row] = pColumns->longitude[last];
+        pColumns->city[row] = pColumns->city[last];
+        pColumns->records[row] = pColumns->records[last];
+        pColumns->records[row]->row = row;
+    }
+    pData->row = -1;
+    return;
+}	// columnRemove
+
+
+/*	================== columnUpdate =================
+ This function copies the coordinates and city of a
+ record changed in place into its row.
+ Pre		pColumns - pointer to the column store
+ pData - record stored in the columns
+ Post		row matches the record
+ Return
+ */
+void columnUpdate (COLUMNS* pColumns, DATA* pData)
+{
+	//	Statements
+    pColumns->latitude[pData->row] = pData->latitude;
+    pColumns->longitude[pData->row] = pData->longitude;
+    pColumns->city[pData->row] = pData->city;
+    return;
+}	// columnUpdate
+
+
+/*	================== columnScan =================
+ This function finds every row whose coordinates meet
+ all the predicates. A predicate keeps the rows where
+ low <= value <= high in one column.
+ Pre		pColumns - pointer to the column store
+ predicates - conditions (all must hold)
+ countPredicates - number of conditions
+ rows - receives the matching rows, must have
+ room for every row of the store
+ Post		rows is filled in row order
+ Return	number of matching rows
+ */
+int columnScan (COLUMNS* pColumns, PREDICATE* predicates, int countPredicates, int* rows)
+{
+	//	Local Declarations
+    unsigned long long mask;
+    int count = 0;
+    int first;
+    int bit;
+
+	//	Statements
+    for (first = 0; first < pColumns->count; first += COLUMN_BLOCK)
+    {
+        mask = _scanBlock(pColumns, predicates, countPredicates, first,
+                          pColumns->count - first < COLUMN_BLOCK ? pColumns->count - first : COLUMN_BLOCK);
+        while (mask)
+        {
+            bit = _firstBit(mask);
+            rows[count++] = first + bit;
+            mask &= mask - 1;
+        }
+    }
+    return count;
+}	// columnScan
+
+
+/*	================== columnDestroy =================
+ This function frees the column store.
+ Pre		pColumns - pointer to the store (may be NULL)
+ Post		columns are freed
+ Return	NULL
+ */
+COLUMNS* columnDestroy (COLUMNS* pColumns)
+{
+	//	Statements
+    if (pColumns)
+    {
+        memFree(MEM_INDEX, pColumns->codes, pColumns->capacity * 4);
+        memFree(MEM_INDEX, pColumns->latitude, pColumns->capacity * sizeof(float));
+        memFree(MEM_INDEX, pColumns->longitude, pColumns->capacity * sizeof(float));
+        memFree(MEM_INDEX, pColumns->city, pColumns->capacity * sizeof(unsigned));
+        memFree(MEM_INDEX, pColumns->records, pColumns->capacity * sizeof(DATA*));
+        memFree(MEM_HEADER, pColumns, sizeof(COLUMNS));
+    }
+    return NULL;
+}	// columnDestroy
+
+
+/*	================== _growColumn =================
+ Moves a column into a larger array.
+ Pre		column - old array (may be NULL)
+ size - size of one value
+ count - values in use
+ Return	pointer to the new array
+ */
+static void* _growColumn (void* column, size_t size, int count, int capacity, int newCapacity)
+{
+	//	Local Declarations
+    void* newColumn;
+
+	//	Statements
+    if (!(newColumn = memAlloc(MEM_INDEX, newCapacity * size))) {
+        printf("Error allocating column store\n");
+        exit(150);
+    }
+    if (column)
+        memcpy(newColumn, column, count * size);
+    memFree(MEM_INDEX, column, capacity * size);
+    return newColumn;
+}	// _growColumn
+
+
+/*	================== _scanBlock =================
+ Checks up to COLUMN_BLOCK rows starting at first.
+ Return	bit mask, bit i set when row first + i
+ meets every predicate
+ */
+static unsigned long long _scanBlock (COLUMNS* pColumns, PREDICATE* predicates,
+                                      int countPredicates, int first, int countRows)
+{
+	//	Local Declarations
+    unsigned long long mask;
+    unsigned long long match;
+    float* values;
+    int p;
+    int i = 0;
+#ifdef COLUMN_SSE
+    __m128 low;
+    __m128 high;
+    __m128 value;
+#endif
+
+	//	Statements
+    mask = countRows == 64 ? ~0ULL : (1ULL << countRows) - 1;
+    for (p = 0; p < countPredicates && mask; p++)
+    {
+        values = (predicates[p].column == COLUMN_LATITUDE ? pColumns->latitude
+                                                          : pColumns->longitude) + first;
+        match = 0;
+        i = 0;
+#ifdef COLUMN_SSE
+        low = _mm_set1_ps(predicates[p].low);
+        high = _mm_set1_ps(predicates[p].high);
+        for ( ; i + 4 <= countRows; i += 4)
+        {
+            value = _mm_loadu_ps(values + i);
+            match |= (unsigned long long) _mm_movemask_ps(
+                         _mm_and_ps(_mm_cmpge_ps(value, low), _mm_cmple_ps(value, high))) << i;
+        }
+#endif
+        for ( ; i < countRows; i++)
+        {
+            if (values[i] >= predicates[p].low && values[i] <= predicates[p].high)
+                match |= 1ULL << i;
+        }
+        mask &= match;
+    }
+    return mask;
+}	// _scanBlock
+
+
+/*	================== _firstBit =================
+ Returns the position of the lowest set bit.
+ Pre		mask is not zero
+ */
+static int _firstBit (unsigned long long mask)
+{
+	//	Local Declarations
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long bit;
+
+	//	Statements
+    _BitScanForward64(&bit, mask);
+    return (int) bit;
+#elif defined(__GNUC__)
+	//	Statements
+    return __builtin_ctzll(mask);
+#else
+    int bit = 0;
+
+	//	Statements
+    while (!(mask & 1)) {
+        mask >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}	// _firstBit
@@ -0,0 +1,371 @@
+/*	data_embedded.h
+ Generated by tools/embed.c from data.txt. Do not edit.
+ */
+
+#define EMBEDDED_RECORDS 25
+
+typedef struct{
+    HEAD       head;
+    HASH       hash;
+    BST_TREE   tree;
+    POOL       chainPool;
+    FILTER     filter;
+    STR_POOL   cityPool;
+    CITY_INDEX cityIndex;
+    COLUMNS    columns;
+    DATA       records[26];
+    HASH_NODE  table[125];
+    COLLISION  chains[1];
+    unsigned char filterCounters[512];
+    char       cityBuffer[237];
+    STR_NAME   cityNames[25];
+    unsigned   cityIndexSlots[64];
+    CITY_ENTRY cityEntries[25];
+    DATA*      cityRecords[26];
+    char       columnCodes[104];
+    float      columnLatitude[26];
+    float      columnLongitude[26];
+    unsigned   columnCity[26];
+    DATA*      columnRecords[26];
+}EMBEDDED_DB;
+
+static EMBEDDED_DB embedded = {
+    { &embedded.hash, &embedded.tree, &embedded.cityIndex, &embedded.columns, NULL, NULL },
+    { 125, 25, embedded.table, &embedded.chainPool, &embedded.filter },
+    { 25, &embedded.records[7].node, 25 },
+    { MEM_CHAIN, 24, 64, NULL, NULL, 0, 0 },
+    { embedded.filterCounters, 8, 25, 0, 0, 0 },
+    { embedded.cityBuffer, 236, 236, 0, embedded.cityNames, 24, 24, 0, embedded.cityIndexSlots, 64, 24 },
+    { 24, 24, embedded.cityEntries, NULL, 0, 0 },
+    { 25, 25, embedded.columnCodes, embedded.columnLatitude, embedded.columnLongitude, embedded.columnCity, embedded.columnRecords },
+    {
+        { { 5457217u, NULL, NULL }, "SEA", 0, 47.4500008f, 122.300003f, 0 },
+        { { 5457487u, &embedded.records[11].node, &embedded.records[6].node }, "SFO", 1, 37.75f, 122.68f, 1 },
+        { { 4997464u, NULL, NULL }, "LAX", 2, 33.9300003f, 118.400002f, 2 },
+        { { 4474455u, NULL, NULL }, "DFW", 3, 32.7299995f, 96.9700012f, 3 },
+        { { 5063503u, NULL, &embedded.records[14].node }, "MCO", 4, 28.4300003f, 81.3199997f, 4 },
+        { { 4281420u, NULL, &embedded.records[22].node }, "ATL", 5, 33.6500015f, 84.4199982f, 5 },
+        { { 5459011u, &embedded.records[10].node, &embedded.records[21].node }, "SLC", 6, 40.7900009f, 111.980003f, 6 },
+        { { 4998977u, &embedded.records[18].node, &embedded.records[16].node }, "LGA", 7, 40.7700005f, 73.9000015f, 7 },
+        { { 5198404u, NULL, &embedded.records[24].node }, "ORD", 8, 41.9799995f, 87.9000015f, 8 },
+        { { 4474190u, NULL, &embedded.records[3].node }, "DEN", 9, 39.75f, 104.870003f, 9 },
+        { { 5458499u, NULL, NULL }, "SJC", 10, 37.3600006f, 121.919998f, 10 },
+        { { 5456206u, NULL, &embedded.records[0].node }, "SAN", 11, 32.7299995f, 117.190002f, 11 },
+        { { 4997459u, &embedded.records[13].node, &embedded.records[2].node }, "LAS", 12, 36.0800018f, 115.150002f, 12 },
+        { { 4867659u, NULL, NULL }, "JFK", 7, 40.5999985f, 73.7799988f, 13 },
+        { { 5065025u, NULL, NULL }, "MIA", 13, 25.7999992f, 80.2900009f, 14 },
+        { { 4410452u, &embedded.records[5].node, &embedded.records[9].node }, "CLT", 14, 35.2099991f, 80.9000015f, 15 },
+        { { 5261400u, &embedded.records[23].node, &embedded.records[1].node }, "PHX", 15, 33.4300003f, 112.010002f, 16 },
+        { { 4544338u, NULL, &embedded.records[20].node }, "EWR", 16, 40.7000008f, 74.1699982f, 17 },
+        { { 4478039u, &embedded.records[15].node, &embedded.records[19].node }, "DTW", 17, 42.2099991f, 83.3499985f, 18 },
+        { { 4800836u, &embedded.records[17].node, &embedded.records[12].node }, "IAD", 18, 38.9399986f, 77.5f, 19 },
+        { { 4738636u, NULL, NULL }, "HNL", 19, 21.3199997f, 157.919998f, 20 },
+        { { 5525569u, NULL, NULL }, "TPA", 20, 27.9799995f, 82.5299988f, 21 },
+        { { 4345683u, NULL, NULL }, "BOS", 21, 42.3600006f, 71.0100021f, 22 },
+        { { 5067600u, &embedded.records[4].node, &embedded.records[8].node }, "MSP", 22, 44.8800011f, 93.2200012f, 23 },
+        { { 5261388u, NULL, NULL }, "PHL", 23, 39.8699989f, 75.2399979f, 24 },
+    },
+    {
+        { 0, 4544338u, &embedded.records[17], NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 4998977u, &embedded.records[7], NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 4410452u, &embedded.records[15], NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 4474190u, &embedded.records[9], NULL },
+        { 0, 4345683u, &embedded.records[22], NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 5063503u, &embedded.records[4], NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 4800836u, &embedded.records[19], NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 4478039u, &embedded.records[18], NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 4474455u, &embedded.records[3], NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 5458499u, &embedded.records[10], NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 5198404u, &embedded.records[8], NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 5261388u, &embedded.records[24], NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 5065025u, &embedded.records[14], NULL },
+        { 0, 5457487u, &embedded.records[1], NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 5459011u, &embedded.records[6], NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 5261400u, &embedded.records[16], NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 4997459u, &embedded.records[12], NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 5067600u, &embedded.records[23], NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 4997464u, &embedded.records[2], NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 5525569u, &embedded.records[21], NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 4867659u, &embedded.records[13], NULL },
+        { 0, 4281420u, &embedded.records[5], NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 4738636u, &embedded.records[20], NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 5456206u, &embedded.records[11], NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 5457217u, &embedded.records[0], NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+        { 0, 0, NULL, NULL },
+    },
+    {
+        { 0, NULL, NULL }
+    },
+    {
+        0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0,0,
+        0,1,0,0,0,0,0,1,0,0,1,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,
+        0,0,2,0,1,0,0,0,0,2,0,0,0,0,0,0,1,0,0,0,0,1,0,0,0,1,0,0,0,1,0,0,
+        0,0,3,0,1,0,0,1,0,1,1,0,1,1,0,0,0,0,0,0,0,2,0,1,1,0,0,0,0,1,1,0,
+        0,0,0,0,0,0,0,0,0,0,2,1,0,0,0,0,0,0,0,1,0,0,0,0,0,0,1,0,0,0,0,1,
+        0,1,0,1,1,0,1,0,1,0,0,0,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,1,0,
+        0,0,0,0,0,0,0,1,1,0,0,0,0,0,0,0,0,0,0,1,0,0,0,1,1,0,0,0,0,0,0,0,
+        1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,1,0,0,0,0,
+        0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,2,0,0,0,1,0,0,0,
+        0,1,0,0,0,0,0,0,1,1,1,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,1,0,1,0,
+        1,0,0,0,0,0,1,1,0,0,0,1,0,0,1,0,0,0,1,0,0,0,0,1,0,0,0,1,0,1,0,0,
+        1,1,0,0,0,0,0,0,0,0,1,0,0,1,1,2,0,0,0,1,0,1,0,0,0,0,0,0,0,0,2,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,1,0,1,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,1,0,0,1,1,0,0,0,0,0,1,0,0,0,
+        0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,1,0,0,0,1,0,0,
+    },
+    {
+        83,101,97,116,116,108,101,0,83,97,110,32,70,114,97,110,
+        99,105,115,99,111,0,76,111,115,32,65,110,103,101,108,101,
+        115,0,68,97,108,108,97,115,32,70,111,114,116,32,87,111,
+        114,116,104,0,79,114,108,97,110,100,111,0,65,116,108,97,
+        110,116,97,0,83,97,108,116,32,76,97,107,101,32,67,105,
+        116,121,0,78,101,119,32,89,111,114,107,0,67,104,105,99,
+        97,103,111,0,68,101,110,118,101,114,0,83,97,110,32,74,
+        111,115,101,0,83,97,110,32,68,105,101,103,111,0,76,97,
+        115,32,86,101,103,97,115,0,77,105,97,109,105,0,67,104,
+        97,114,108,111,116,116,101,0,80,104,111,101,110,105,120,0,
+        78,101,119,97,114,107,0,68,101,116,114,111,105,116,0,87,
+        97,115,104,105,110,103,116,111,110,32,68,67,0,72,111,110,
+        111,108,117,108,117,0,84,97,109,112,97,0,66,111,115,116,
+        111,110,0,77,105,110,110,101,97,112,111,108,105,115,0,80,
+        104,105,108,97,100,101,108,112,104,105,97,0, 0
+    },
+    {
+        { 0, 1 },
+        { 8, 1 },
+        { 22, 1 },
+        { 34, 1 },
+        { 52, 1 },
+        { 60, 1 },
+        { 68, 1 },
+        { 83, 2 },
+        { 92, 1 },
+        { 100, 1 },
+        { 107, 1 },
+        { 116, 1 },
+        { 126, 1 },
+        { 136, 1 },
+        { 142, 1 },
+        { 152, 1 },
+        { 160, 1 },
+        { 167, 1 },
+        { 175, 1 },
+        { 189, 1 },
+        { 198, 1 },
+        { 204, 1 },
+        { 211, 1 },
+        { 223, 1 },
+        { 0, 0 }
+    },
+    {
+        0,10,0,0,22,0,0,7,8,0,0,4,16,12,0,20,
+        23,0,0,2,19,0,0,1,0,0,0,0,0,0,0,9,
+        0,0,24,0,0,0,0,0,14,18,0,15,3,0,0,0,
+        0,13,0,0,6,11,21,17,0,0,5,0,0,0,0,0,
+    },
+    {
+        { 5, 1, 1, &embedded.cityRecords[0] },
+        { 21, 1, 1, &embedded.cityRecords[1] },
+        { 14, 1, 1, &embedded.cityRecords[2] },
+        { 8, 1, 1, &embedded.cityRecords[3] },
+        { 3, 1, 1, &embedded.cityRecords[4] },
+        { 9, 1, 1, &embedded.cityRecords[5] },
+        { 17, 1, 1, &embedded.cityRecords[6] },
+        { 19, 1, 1, &embedded.cityRecords[7] },
+        { 12, 1, 1, &embedded.cityRecords[8] },
+        { 2, 1, 1, &embedded.cityRecords[9] },
+        { 13, 1, 1, &embedded.cityRecords[10] },
+        { 22, 1, 1, &embedded.cityRecords[11] },
+        { 7, 2, 2, &embedded.cityRecords[12] },
+        { 16, 1, 1, &embedded.cityRecords[14] },
+        { 4, 1, 1, &embedded.cityRecords[15] },
+        { 23, 1, 1, &embedded.cityRecords[16] },
+        { 15, 1, 1, &embedded.cityRecords[17] },
+        { 6, 1, 1, &embedded.cityRecords[18] },
+        { 11, 1, 1, &embedded.cityRecords[19] },
+        { 1, 1, 1, &embedded.cityRecords[20] },
+        { 10, 1, 1, &embedded.cityRecords[21] },
+        { 0, 1, 1, &embedded.cityRecords[22] },
+        { 20, 1, 1, &embedded.cityRecords[23] },
+        { 18, 1, 1, &embedded.cityRecords[24] },
+        { 0, 0, 0, NULL }
+    },
+    {
+        &embedded.records[5],
+        &embedded.records[22],
+        &embedded.records[15],
+        &embedded.records[8],
+        &embedded.records[3],
+        &embedded.records[9],
+        &embedded.records[18],
+        &embedded.records[20],
+        &embedded.records[12],
+        &embedded.records[2],
+        &embedded.records[14],
+        &embedded.records[23],
+        &embedded.records[7],
+        &embedded.records[13],
+        &embedded.records[17],
+        &embedded.records[4],
+        &embedded.records[24],
+        &embedded.records[16],
+        &embedded.records[6],
+        &embedded.records[11],
+        &embedded.records[1],
+        &embedded.records[10],
+        &embedded.records[0],
+        &embedded.records[21],
+        &embedded.records[19], NULL
+    },
+    {
+        'S','E','A',0, 'S','F','O',0, 'L','A','X',0, 'D','F','W',0, 'M','C','O',0, 'A','T','L',0, 'S','L','C',0, 'L','G','A',0,
+        'O','R','D',0, 'D','E','N',0, 'S','J','C',0, 'S','A','N',0, 'L','A','S',0, 'J','F','K',0, 'M','I','A',0, 'C','L','T',0,
+        'P','H','X',0, 'E','W','R',0, 'D','T','W',0, 'I','A','D',0, 'H','N','L',0, 'T','P','A',0, 'B','O','S',0, 'M','S','P',0,
+        'P','H','L',0, 0
+    },
+    {
+        47.4500008f, 37.75f, 33.9300003f, 32.7299995f, 28.4300003f, 33.6500015f, 40.7900009f, 40.7700005f,
+        41.9799995f, 39.75f, 37.3600006f, 32.7299995f, 36.0800018f, 40.5999985f, 25.7999992f, 35.2099991f,
+        33.4300003f, 40.7000008f, 42.2099991f, 38.9399986f, 21.3199997f, 27.9799995f, 42.3600006f, 44.8800011f,
+        39.8699989f, 0
+    },
+    {
+        122.300003f, 122.68f, 118.400002f, 96.9700012f, 81.3199997f, 84.4199982f, 111.980003f, 73.9000015f,
+        87.9000015f, 104.870003f, 121.919998f, 117.190002f, 115.150002f, 73.7799988f, 80.2900009f, 80.9000015f,
+        112.010002f, 74.1699982f, 83.3499985f, 77.5f, 157.919998f, 82.5299988f, 71.0100021f, 93.2200012f,
+        75.2399979f, 0
+    },
+    {
+        0, 1, 2, 3, 4, 5, 6, 7,
+        8, 9, 10, 11, 12, 7, 13, 14,
+        15, 16, 17, 18, 19, 20, 21, 22,
+        23, 0
+    },
+    {
+        &embedded.records[0],
+        &embedded.records[1],
+        &embedded.records[2],
+        &embedded.records[3],
+        &embedded.records[4],
+        &embedded.records[5],
+        &embedded.records[6],
+        &embedded.records[7],
+        &embedded.records[8],
+        &embedded.records[9],
+        &embedded.records[10],
+        &embedded.records[11],
+        &embedded.records[12],
+        &embedded.records[13],
+        &embedded.records[14],
+        &embedded.records[15],
+        &embedded.records[16],
+        &embedded.records[17],
+        &embedded.records[18],
+        &embedded.records[19],
+        &embedded.records[20],
+        &embedded.records[21],
+        &embedded.records[22],
+        &embedded.records[23],
+        &embedded.records[24], NULL
+    }
+};
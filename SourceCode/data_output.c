@@ -4,11 +4,15 @@
  
  Functions:
  menu
+ diskMenu
  printHash
  printTree
  processScreen
+ processDiskScreen
  outputFile
  processFile
+ formatLine
+ processDiskFile
  
  */
 
@@ -31,11 +35,23 @@ char menu (void)
     printf("Enter 'A' to add new data\n");
     printf("      'D' to delete data\n");
     printf("      'F' to find data\n");
+    printf("      'C' to find data by city\n");
+    printf("      'S' to search data by coordinates\n");
     printf("      'L' to list data in hash table sequence\n");
     printf("      'K' to list data in key sequence\n");
+    printf("      'G' to list data in a range of codes\n");
+    printf("      'V' to run a query\n");
     printf("      'P' to print the tree\n");
     printf("      'W' to write data to a file\n");
+    printf("      'J' to write data to a file in key sequence\n");
     printf("      'E' to calculate efficiency\n");
+    printf("      'T' to save the timing histograms to a file\n");
+    printf("      'X' to start or stop profiling\n");
+    printf("      'O' to start or stop recording a trace\n");
+    printf("      'Y' to replay a trace\n");
+    printf("      'U' to apply changes from a file\n");
+    printf("      'N' to start or stop watching a data file\n");
+    printf("      'R' to reload data from the input file\n");
     printf("      'Q' to quit\n");
     scanf(" %c", &choice);
     
@@ -43,6 +59,34 @@ char menu (void)
 }	// menu
 
 
+/*	================== diskMenu =================
+ This function prints the menu of a disk database
+ and scans in the user's option.
+ Pre
+ Post	    menu is printed on screen
+ Return	user's option
+ */
+char diskMenu (void)
+{
+	//	Local Declarations
+    char choice;
+    
+	//	Statements
+    printf("Enter 'A' to add new data\n");
+    printf("      'D' to delete data\n");
+    printf("      'F' to find data\n");
+    printf("      'K' to list data in key sequence\n");
+    printf("      'G' to list data in a range of codes\n");
+    printf("      'I' to import data from a file\n");
+    printf("      'W' to write data to a file\n");
+    printf("      'E' to show the database and buffer pool\n");
+    printf("      'Q' to quit\n");
+    scanf(" %c", &choice);
+    
+    return toupper(choice);
+}	// diskMenu
+
+
 /*	================== printHash =================
  This function will print out the hash according
  to the index.
@@ -59,15 +103,15 @@ void printHash (HASH* pHash)
 	//	Statements
     for (i = 0; i < pHash->arraySize; i++)
     {
-        if (pHash->pTable[i].pData != NULL) {
+        if (pHash->pTable[i].pData != LINK_NONE) {
             printf("%3d ", i);
-            processScreen(pHash->pTable[i].pData);
+            processScreen(REC(pHash->pTable[i].pData));
             
-            pWalker = pHash->pTable[i].pCollision;
+            pWalker = CHAIN(pHash->pChains, pHash->pTable[i].pCollision);
             while (pWalker != NULL) {
                 printf("%3d ", i);
-                processScreen(pWalker->pData);
-                pWalker = pWalker->next;
+                processScreen(REC(pWalker->pData));
+                pWalker = CHAIN(pHash->pChains, pWalker->next);
             }
         }
     }
@@ -78,30 +122,32 @@ void printHash (HASH* pHash)
 /*	================== printTree =================
  This function will print out the tree horizontally,
  with tabs to indicate different levels and subtrees.
- Pre		root - pointer to root of tree
+ Pre		tree - pointer to the tree
+ root - link to root of the subtree
  level - level in which user would like
  to print from
  Post	    tree is printed onto screen
  Return
  */
-void printTree (NODE* root, int level)
+void printTree (BST_TREE* tree, NODE_LINK root, int level)
 {
 	// Local Declarations
+	NODE* pNode;
 	int child;
 	int i;
     
 	// Statements
-	if (!root)
+	if (!(pNode = TREE_NODE(tree, root)))
 		return;
-	if (root->right)
-		printTree (root->right, level + 1);
+	if (pNode->right)
+		printTree (tree, pNode->right, level + 1);
     
 	for (i = 0; i < level; i++)
 		printf ("   ");
-	printf("%s\n", ((DATA*) root->dataPtr)->arpCode);
+	printf("%s\n", NODE_RECORD(pNode)->arpCode);
     
-	if (root->left)
-        printTree (root->left, level + 1);
+	if (pNode->left)
+        printTree (tree, pNode->left, level + 1);
     
 	return;
     
@@ -118,51 +164,78 @@ void printTree (NODE* root, int level)
 void processScreen (void* data)
 {
 	//	Local Declarations
-    DATA airport = *((DATA*) data);
+    const DATA* pAirport = (const DATA*) data;
     
 	//	Statements
-    printf("%s %-18s %-5.2f %-5.2f\n", airport.arpCode,
-           airport.city, airport.latitude, airport.longitude);
+    printf("%s %-18s %-5.2f %-5.2f\n", pAirport->arpCode,
+           cityName(pAirport->city), pAirport->latitude, pAirport->longitude);
     return;
 }	// processAirport
 
 
+/*	================== processDiskScreen =================
+ This function will print out an airport of a disk
+ database onto the screen, like processScreen.
+ Pre		data - void pointer to DISK_AIRPORT structure
+ Post	    elements of data printed onto screen
+ Return
+ */
+void processDiskScreen (void* data)
+{
+	//	Local Declarations
+    const DISK_AIRPORT* pAirport = (const DISK_AIRPORT*) data;
+    
+	//	Statements
+    printf("%s %-18s %-5.2f %-5.2f\n", pAirport->arpCode,
+           pAirport->city, pAirport->latitude, pAirport->longitude);
+    return;
+}	// processDiskScreen
+
+
 /*	================== outputFile =================
  This function will create a new text file and
  write the data within the structures into this
  newly created file.
- Pre		pHash - pointer to the start of hash table
+ Pre		pHeader - pointer to HEAD structure
  Post	    new file is create containing data within
- the current hash table
+ the current hash table (every shard of it)
  Return
  */
-bool outputFile (HASH* pHash)
+bool outputFile (HEAD* pHeader)
 {
     
 	//	Local Declarations
-	FILE* fileOut;
+	ASYNC_FILE* fileOut;
+    HASH* pHash;
     COLLISION* pWalker;
 	int i;
+	int s;
 	bool success = false;
+	unsigned long long start = latencyStart();
     
 	//	Statements
-	if ((fileOut = fopen("outputFile.txt", "w")))
+	if ((fileOut = asyncOpen("outputFile.txt", true)))
 	{
-		for (i = 0; i < pHash->arraySize; i++)
+		for (s = 0; s < shardCount(pHeader); s++)
 		{
-			if (pHash->pTable[i].pData != NULL) {
-				processFile(pHash->pTable[i].pData, fileOut);
-				
-				pWalker = pHash->pTable[i].pCollision;
-				while (pWalker != NULL) {
-					processFile(pWalker->pData, fileOut);
-					pWalker = pWalker->next;
+			pHash = shardTable(pHeader, s);
+			for (i = 0; i < pHash->arraySize; i++)
+			{
+				if (pHash->pTable[i].pData != LINK_NONE) {
+					processFile(REC(pHash->pTable[i].pData), fileOut);
+					
+					pWalker = CHAIN(pHash->pChains, pHash->pTable[i].pCollision);
+					while (pWalker != NULL) {
+						processFile(REC(pWalker->pData), fileOut);
+						pWalker = CHAIN(pHash->pChains, pWalker->next);
+					}
 				}
 			}
 		}
-		success = true;
+		success = asyncClose(fileOut);
 	}
     
+	latencyRecord(LAT_OUTPUT, start);
 	return success;
 }	// outputFile
 
@@ -176,10 +249,51 @@ bool outputFile (HASH* pHash)
  Post	    elements of data printed into file
  Return
  */
-void processFile (void* data, FILE* fOut)
+void processFile (void* data, ASYNC_FILE* fOut)
 {
-	DATA airport = *((DATA*)data);
-	fprintf(fOut, "%s\t%s;\t%.2f\t%.2f\n", airport.arpCode,
-            airport.city, airport.latitude, airport.longitude);
+	char line[LINE_SIZE];
+	int length;
+	
+	length = formatLine((const DATA*) data, line);
+	asyncWrite(fOut, line, length);
 	return;
 }	// processFile
+
+
+/*	================== formatLine =================
+ This function formats a record as a line of a data
+ file.
+ Pre		pAirport - pointer to the record
+ line - room for LINE_SIZE characters
+ Post	    line holds the record, ending in a newline
+ Return	length of the line
+ */
+int formatLine (const DATA* pAirport, char* line)
+{
+	//	Statements
+	return sprintf(line, "%s\t%.*s;\t%.2f\t%.2f\n", pAirport->arpCode, 128,
+	               cityName(pAirport->city), pAirport->latitude, pAirport->longitude);
+}	// formatLine
+
+
+/*	================== processDiskFile =================
+ This function writes an airport of a disk database
+ to a file as a line of a data file, like processFile.
+ Pre		data - void pointer to DISK_AIRPORT structure
+ fOut - file opened for writing
+ Post	    line is written
+ Return
+ */
+void processDiskFile (void* data, ASYNC_FILE* fOut)
+{
+	//	Local Declarations
+	const DISK_AIRPORT* pAirport = (const DISK_AIRPORT*) data;
+	char line[LINE_SIZE];
+	int length;
+	
+	//	Statements
+	length = sprintf(line, "%s\t%.*s;\t%.2f\t%.2f\n", pAirport->arpCode, 128,
+	                 pAirport->city, pAirport->latitude, pAirport->longitude);
+	asyncWrite(fOut, line, length);
+	return;
+}	// processDiskFile
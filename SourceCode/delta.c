@@ -0,0 +1,398 @@
+/* delta.c
+ This file contains the definitons of the functions that apply
+ a file of changes to the database in one pass. Each line of
+ a change file is either a record in the format of the data
+ file, optionally preceded by '+', which is added or replaces
+ the record with the same code, or '-' and a code, which
+ deletes that record:
+
+ + LAX	Los Angeles;	33.94	-118.41
+ - SFO
+
+ When a code appears on several lines, the last line wins.
+ A line that is not a whole record (or a '-' line without a
+ three letter code) is rejected: it changes nothing and is
+ counted in the summary.
+ The changes are sorted by code first, so the final number of
+ records is known before anything is changed: the hash table
+ is resized once for that number (if it needs to be), and the
+ changes are then applied in key order, so neighbouring
+ changes touch neighbouring parts of the tree. A sharded
+ table resizes each shard by itself instead.
+
+ syncFile compares a new version of a data file with the
+ records instead: the codes missing from the file are deleted,
+ and only the codes added or changed are applied, through the
+ same single resize and key order pass.
+
+ Functions:
+ applyDelta
+ syncFile
+
+ Private Functions:
+ _readRows
+ _applyChanges
+ _parseDelta
+ _compareChanges
+ */
+
+#include "header.h"
+
+#define DELTA_ROWS_START  256
+
+//	One line of a change file
+typedef struct{
+    unsigned key;           // CODE_KEY of the code
+    int      line;          // position in the file
+    bool     remove;        // '-' line
+    bool     rejected;      // not a whole record, but the code is
+    char     arpCode[4];
+    char     city[20];
+    float    latitude;
+    float    longitude;
+    DATA*    pOld;          // stored record of the code, if any
+}DELTA_ROW;
+
+static DELTA_ROW* _readRows (const char* fileName, int* countRows, int* capacity, int* countRejected);
+static void _applyChanges (HEAD* pHeader, DELTA_ROW* rows, int countChanges, int* counts);
+static int _parseDelta (const char* line, DELTA_ROW* pRow);
+static int _compareChanges (const void* row1, const void* row2);
+
+/*	================== applyDelta =================
+ This function applies a change file to the database
+ and prints how many records were inserted, updated
+ and deleted.
+ Pre		pHeader - pointer to HEAD structure
+ fileName - name of the change file
+ Post		database holds the changes
+ Return	false if the file could not be opened
+ */
+bool applyDelta (HEAD* pHeader, const char* fileName)
+{
+	//	Local Declarations
+    DELTA_ROW* rows;
+    int capacity;
+    int countRows;
+    int countRejected;
+    int countKept = 0;
+    int countChanges = 0;
+    int counts[3];
+    int i;
+
+	//	Statements
+    if (!(rows = _readRows(fileName, &countRows, &capacity, &countRejected))) {
+        printf("Error opening change file %s\n", fileName);
+        return false;
+    }
+
+    // keep the last change of every code, in key order
+    for (i = 0; i < countRows; i++)
+        if (!rows[i].rejected)
+            rows[countKept++] = rows[i];
+    qsort(rows, countKept, sizeof(DELTA_ROW), _compareChanges);
+    for (i = 0; i < countKept; i++)
+        if (i + 1 == countKept || rows[i + 1].key != rows[i].key)
+            rows[countChanges++] = rows[i];
+
+    _applyChanges(pHeader, rows, countChanges, counts);
+    printf("Inserted %d, updated %d and deleted %d airports (%d lines, %d codes not found, %d lines rejected).\n",
+           counts[0], counts[1], counts[2], countKept,
+           countChanges - counts[0] - counts[1] - counts[2], countRejected);
+
+    memFree(MEM_INDEX, rows, capacity * sizeof(DELTA_ROW));
+    return true;
+}	// applyDelta
+
+
+/*	================== syncFile =================
+ This function brings the database in line with a new
+ version of a data file. The file is read and sorted
+ by code without changing anything, then compared with
+ the records in key order; only the codes that were
+ added, changed or removed are applied, like a change
+ file. A code whose line is rejected is left as it is.
+ Pre		pHeader - pointer to HEAD structure
+ fileName - name of the data file
+ Post		database holds the records of the file
+ Return	false if the file could not be opened
+ */
+bool syncFile (HEAD* pHeader, const char* fileName)
+{
+	//	Local Declarations
+    DELTA_ROW* rows;
+    DELTA_ROW* changes;
+    DELTA_ROW* pRow;
+    FROZEN* pFrozen;
+    DATA* pData;
+    unsigned key;
+    size_t size;
+    int capacity;
+    int countRows;
+    int countRejected;
+    int countKept = 0;
+    int countChanges = 0;
+    int counts[3];
+    int i;
+    int rank = 0;
+
+	//	Statements
+    if (!(rows = _readRows(fileName, &countRows, &capacity, &countRejected))) {
+        printf("Error opening %s\n", fileName);
+        return false;
+    }
+
+    // keep the first line of every code, like a load does
+    qsort(rows, countRows, sizeof(DELTA_ROW), _compareChanges);
+    for (i = 0; i < countRows; i++)
+        if ((i == 0 || rows[i - 1].key != rows[i].key) && !rows[i].remove)
+            rows[countKept++] = rows[i];
+
+    pHeader->pFrozen = frozenBuild(pHeader->pFrozen, pHeader->pTree);
+    pFrozen = pHeader->pFrozen;
+    size = (countKept + pFrozen->count + 1) * sizeof(DELTA_ROW);
+    if (!(changes = (DELTA_ROW*) memAlloc(MEM_INDEX, size))) {
+        printf("Memory allocation error\n");
+        exit(100);
+    }
+
+    // both lists are in key order: one pass finds the differences
+    i = 0;
+    while (i < countKept || rank < pFrozen->count)
+    {
+        pData = rank < pFrozen->count ? pFrozen->sorted[rank] : NULL;
+        key = pData ? CODE_KEY(pData->arpCode) : 0;
+        if (pData && (i == countKept || key < rows[i].key))
+        {
+            pRow = &changes[countChanges++];
+            memset(pRow, 0, sizeof(DELTA_ROW));
+            strcpy(pRow->arpCode, pData->arpCode);
+            pRow->key = key;
+            pRow->remove = true;
+            rank++;
+        }
+        else if (!pData || rows[i].key < key)
+        {
+            if (!rows[i].rejected)
+                changes[countChanges++] = rows[i];
+            i++;
+        }
+        else
+        {
+            if (!rows[i].rejected &&
+                (strcmp(cityName(pData->city), rows[i].city) != 0 ||
+                 pData->latitude != rows[i].latitude || pData->longitude != rows[i].longitude))
+                changes[countChanges++] = rows[i];
+            i++;
+            rank++;
+        }
+    }
+
+    _applyChanges(pHeader, changes, countChanges, counts);
+    printf("Synced %s: inserted %d, updated %d and deleted %d airports (%d unchanged, %d lines rejected).\n",
+           fileName, counts[0], counts[1], counts[2], countKept - counts[0] - counts[1], countRejected);
+
+    memFree(MEM_INDEX, changes, size);
+    memFree(MEM_INDEX, rows, capacity * sizeof(DELTA_ROW));
+    return true;
+}	// syncFile
+
+
+/*	================== _readRows =================
+ Reads every line of a change or data file into an
+ array of rows with room for capacity of them, and
+ counts the rejected lines. A rejected line with a
+ good code is kept as a rejected row. Returns NULL if
+ the file cannot be opened.
+ */
+static DELTA_ROW* _readRows (const char* fileName, int* countRows, int* capacity, int* countRejected)
+{
+	//	Local Declarations
+    DELTA_ROW* rows = NULL;
+    DELTA_ROW* newRows;
+    ASYNC_FILE* fpIn;
+    char line[128];
+    int parsed;
+
+	//	Statements
+    if (!(fpIn = asyncOpen(fileName, false)))
+        return NULL;
+    *countRows = 0;
+    *capacity = 0;
+    *countRejected = 0;
+    while (asyncLine(fpIn, line, sizeof(line)))
+    {
+        if (*countRows == *capacity)
+        {
+            *capacity = *capacity ? *capacity * 2 : DELTA_ROWS_START;
+            if (!(newRows = (DELTA_ROW*) memAlloc(MEM_INDEX, *capacity * sizeof(DELTA_ROW)))) {
+                printf("Memory allocation error\n");
+                exit(100);
+            }
+            if (rows)
+                memcpy(newRows, rows, *countRows * sizeof(DELTA_ROW));
+            memFree(MEM_INDEX, rows, *countRows * sizeof(DELTA_ROW));
+            rows = newRows;
+        }
+        parsed = _parseDelta(line, &rows[*countRows]);
+        if (parsed < 0 || (parsed > 0 && rows[*countRows].rejected))
+            (*countRejected)++;
+        if (parsed > 0)
+        {
+            rows[*countRows].line = *countRows;
+            (*countRows)++;
+        }
+    }
+    asyncClose(fpIn);
+
+    // an empty file still gets an array
+    if (!rows && !(rows = (DELTA_ROW*) memAlloc(MEM_INDEX, (*capacity = 1) * sizeof(DELTA_ROW)))) {
+        printf("Memory allocation error\n");
+        exit(100);
+    }
+    return rows;
+}	// _readRows
+
+
+/*	================== _applyChanges =================
+ Applies changes sorted by code, one per code: the hash
+ table is resized once for the final number of records
+ (if it needs to be), then the changes are applied in
+ key order. counts receives the number of records
+ inserted, updated and deleted.
+ */
+static void _applyChanges (HEAD* pHeader, DELTA_ROW* rows, int countChanges, int* counts)
+{
+	//	Local Declarations
+    DELTA_ROW* pRow;
+    DATA* pData;
+    unsigned city;
+    int countFinal;
+    int i;
+
+	//	Statements
+    counts[0] = counts[1] = counts[2] = 0;
+
+    // count the records left once every change is applied
+    countFinal = BST_Count(pHeader->pTree);
+    for (i = 0; i < countChanges; i++)
+    {
+        pRow = &rows[i];
+        pData = frozenRetrieve(pHeader, pRow->key);
+        pRow->pOld = pData;
+        if (pData && pRow->remove)
+            countFinal--;
+        else if (!pData && !pRow->remove)
+            countFinal++;
+    }
+
+    // one resize, before the changes, if the final load needs it
+    if (pHeader->pHash && countFinal > 0 &&
+        ((float) countFinal / pHeader->pHash->arraySize >= 0.75 ||
+         (float) countFinal / pHeader->pHash->arraySize <= 0.1))
+        pHeader->pHash = rehash(pHeader->pHash, 2 * countFinal);
+
+    for (i = 0; i < countChanges; i++)
+    {
+        pRow = &rows[i];
+        pData = pRow->pOld;
+        if (pRow->remove)
+        {
+            if (pData && deleteHash(pHeader, *pData))
+                counts[2]++;
+        }
+        else if (pData)
+        {
+            city = cityIntern(pRow->city);
+            if (city != pData->city) {
+                cityIndexRemove(pHeader->pCity, pData);
+                cityRelease(pData->city);
+                pData->city = city;
+                cityIndexAdd(pHeader->pCity, pData);
+            }
+            else
+                cityRelease(city);
+            pData->latitude = pRow->latitude;
+            pData->longitude = pRow->longitude;
+            if (pHeader->pColumns)
+                columnUpdate(pHeader->pColumns, pData);
+            counts[1]++;
+        }
+        else
+        {
+            if (!(pData = recordAlloc())) {
+                printf("Error allocating new airport\n");
+                exit(100);
+            }
+            strcpy(pData->arpCode, pRow->arpCode);
+            pData->city = cityIntern(pRow->city);
+            pData->latitude = pRow->latitude;
+            pData->longitude = pRow->longitude;
+            insertRecord(pHeader, pData);
+            counts[0]++;
+        }
+    }
+    if (pHeader->pFrozen)
+        pHeader->pFrozen = frozenBuild(pHeader->pFrozen, pHeader->pTree);
+    return;
+}	// _applyChanges
+
+
+/*	================== _parseDelta =================
+ Reads one line of a change file into a row. The codes
+ are stored in upper case, like the codes typed in the
+ menu. Returns 1 for a row, 0 for a blank line and -1
+ for a line without a good code. A line with a good
+ code that is not a whole change gives a row marked
+ rejected.
+ */
+static int _parseDelta (const char* line, DELTA_ROW* pRow)
+{
+	//	Local Declarations
+    int parsed;
+    int length = 0;
+    int i;
+
+	//	Statements
+    while (*line == ' ' || *line == '\t')
+        line++;
+    pRow->remove = *line == '-';
+    if (pRow->remove)
+    {
+        if (sscanf(line + 1, " %3s%n", pRow->arpCode, &length) != 1)
+            return -1;
+        parsed = line[1 + length] == '\0' || isspace((unsigned char) line[1 + length]) ? 1 : -1;
+    }
+    else
+    {
+        parsed = parseLine(*line == '+' ? line + 1 : line, pRow->arpCode, pRow->city,
+                           &pRow->latitude, &pRow->longitude);
+        if (parsed == 0)
+            return *line == '+' ? -1 : 0;
+    }
+    for (i = 0; i < 3; i++)
+        if (!isalpha((unsigned char) pRow->arpCode[i]))
+            return -1;
+    for (i = 0; pRow->arpCode[i]; i++)
+        pRow->arpCode[i] = toupper(pRow->arpCode[i]);
+    pRow->key = CODE_KEY(pRow->arpCode);
+    pRow->rejected = parsed < 0;
+    pRow->pOld = NULL;
+    return 1;
+}	// _parseDelta
+
+
+/*	================== _compareChanges =================
+ qsort order of the changes: by code, then by line, so
+ the last change of a code comes last.
+ */
+static int _compareChanges (const void* row1, const void* row2)
+{
+	//	Local Declarations
+    const DELTA_ROW* pRow1 = (const DELTA_ROW*) row1;
+    const DELTA_ROW* pRow2 = (const DELTA_ROW*) row2;
+
+	//	Statements
+    if (pRow1->key != pRow2->key)
+        return pRow1->key < pRow2->key ? -1 : 1;
+    return pRow1->line - pRow2->line;
+}	// _compareChanges
@@ -0,0 +1,811 @@
+/* disk.c
+ This file contains the definitons of the functions of the disk
+ storage engine, which keeps the airports in a B+tree in a paged
+ file instead of in memory, so the database can be larger than
+ the memory. The file is made of DISK_PAGE byte pages:
+
+ page 0      the header: "ADB1", root page, number of pages and
+             number of records
+ leaf page   up to DISK_LEAF_MAX records sorted by code, and the
+             next leaf, so a range is read leaf after leaf
+ inner page  up to DISK_INNER_MAX codes and one more child page:
+             the codes of children[i] are at least keys[i - 1]
+             and less than keys[i]
+
+ Pages are only read through the buffer pool, a fixed number of
+ page frames given by the memory budget. A page that is asked
+ for again while it is in a frame costs no read; when a frame
+ is needed the clock hand passes over the frames, giving each
+ used frame a second chance, and takes the first one not used
+ since its last pass (writing it back first if it changed).
+ Changed pages stay in memory until then or until the file is
+ closed. A search keeps one page in use at a time, so even a
+ small budget works.
+
+ The records are read into and written from DISK_AIRPORT, which
+ holds the city name itself, so scanning the database does not
+ keep every city name in memory (the city pool of the records
+ in memory is not used).
+
+ Deleted records are taken out of their leaf; leaves are not
+ merged, so a leaf may stay empty until codes are added to it
+ again.
+
+ Functions:
+ diskOpen
+ diskClose
+ diskFind
+ diskInsert
+ diskDelete
+ diskRange
+ diskImport
+ diskExport
+ diskReport
+
+ Private Functions:
+ _insert
+ _findLeaf
+ _leafSearch
+ _innerSearch
+ _newPage
+ _fetch
+ _release
+ _evict
+ _writeFrame
+ _toAirport
+ */
+
+#include "header.h"
+
+#define DISK_MAGIC       "ADB1"
+#define DISK_LEAF_PAGE   1
+#define DISK_INNER_PAGE  2
+#define DISK_MIN_FRAMES  8
+#define DISK_LEAF_MAX    ((DISK_PAGE - 8) / (int) sizeof(DISK_RECORD))
+#define DISK_INNER_MAX   ((DISK_PAGE - 8) / 8)
+#define DISK_FRAME_DATA(pDisk, f)  ((pDisk)->pages + (size_t) (f) * DISK_PAGE)
+
+//	One record as it is stored in a leaf
+typedef struct{
+    unsigned key;           // CODE_KEY of the code
+    float    latitude;
+    float    longitude;
+    char     city[20];
+}DISK_RECORD;
+
+typedef struct{
+    unsigned short type;
+    unsigned short count;
+    unsigned       next;    // next leaf, 0 for the last one
+    DISK_RECORD    records[DISK_LEAF_MAX];
+}DISK_LEAF;
+
+typedef struct{
+    unsigned short type;
+    unsigned short count;   // number of keys
+    unsigned       children[DISK_INNER_MAX + 1];
+    unsigned       keys[DISK_INNER_MAX];
+}DISK_INNER;
+
+//	Page 0 of the file
+typedef struct{
+    char     magic[4];
+    unsigned root;
+    unsigned countPages;
+    unsigned countRecords;
+}DISK_HEADER;
+
+static int _insert (DISK* pDisk, unsigned page, DISK_RECORD* pRecord, unsigned* upKey, unsigned* upPage);
+static unsigned _findLeaf (DISK* pDisk, unsigned key);
+static int _leafSearch (DISK_LEAF* pLeaf, unsigned key);
+static int _innerSearch (DISK_INNER* pInner, unsigned key);
+static int _newPage (DISK* pDisk, unsigned* page);
+static int _fetch (DISK* pDisk, unsigned page, bool fresh);
+static void _release (DISK* pDisk, int f, bool dirty);
+static int _evict (DISK* pDisk);
+static void _writeFrame (DISK* pDisk, int f);
+static void _toAirport (DISK_RECORD* pRecord, DISK_AIRPORT* pAirport);
+
+/*	================== diskOpen =================
+ This function opens a disk database, or creates it
+ with an empty root leaf if the file does not exist.
+ Pre		fileName - name of the database file
+ budget - kilobytes of memory for the buffer pool
+ Post		buffer pool is allocated
+ Return	pointer to the database, NULL if the file
+ is not a database
+ */
+DISK* diskOpen (const char* fileName, int budget)
+{
+	//	Local Declarations
+    DISK* pDisk;
+    DISK_HEADER header;
+    DISK_LEAF* pLeaf;
+    FILE* fp;
+    unsigned root;
+    int f;
+
+	//	Statements
+    if ((fp = fopen(fileName, "r+b")))
+    {
+        if (fread(&header, sizeof(DISK_HEADER), 1, fp) != 1 ||
+            memcmp(header.magic, DISK_MAGIC, 4) != 0 || header.root == 0) {
+            printf("%s is not an airport database\n", fileName);
+            fclose(fp);
+            return NULL;
+        }
+    }
+    else if ((fp = fopen(fileName, "w+b")))
+    {
+        memcpy(header.magic, DISK_MAGIC, 4);
+        header.root = 0;
+        header.countPages = 1;
+        header.countRecords = 0;
+    }
+    else {
+        printf("Error opening database %s\n", fileName);
+        return NULL;
+    }
+
+    if (!(pDisk = (DISK*) memCalloc(MEM_HEADER, 1, sizeof(DISK)))) {
+        printf("Memory allocation error\n");
+        exit(210);
+    }
+    pDisk->fp = fp;
+    pDisk->root = header.root;
+    pDisk->countPages = header.countPages;
+    pDisk->countRecords = (int) header.countRecords;
+    pDisk->countFrames = (int) ((long long) budget * 1024 / DISK_PAGE);
+    if (pDisk->countFrames < DISK_MIN_FRAMES)
+        pDisk->countFrames = DISK_MIN_FRAMES;
+    if (!(pDisk->frames = (DISK_FRAME*) memCalloc(MEM_INDEX, pDisk->countFrames, sizeof(DISK_FRAME))) ||
+        !(pDisk->pages = (char*) memAlloc(MEM_INDEX, (size_t) pDisk->countFrames * DISK_PAGE)) ||
+        !(pDisk->buckets = (int*) memAlloc(MEM_INDEX, pDisk->countFrames * sizeof(int)))) {
+        printf("Memory allocation error\n");
+        exit(210);
+    }
+    for (f = 0; f < pDisk->countFrames; f++)
+        pDisk->buckets[f] = -1;
+
+    if (pDisk->root == 0)
+    {
+        f = _newPage(pDisk, &root);
+        pLeaf = (DISK_LEAF*) DISK_FRAME_DATA(pDisk, f);
+        pLeaf->type = DISK_LEAF_PAGE;
+        _release(pDisk, f, true);
+        pDisk->root = root;
+    }
+    return pDisk;
+}	// diskOpen
+
+
+/*	================== diskClose =================
+ This function writes the changed pages and the header
+ back to the file, closes it and frees the buffer pool.
+ Pre		pDisk - pointer to the database (may be NULL)
+ Post		file is up to date and closed
+ Return	NULL
+ */
+DISK* diskClose (DISK* pDisk)
+{
+	//	Local Declarations
+    DISK_HEADER header;
+    int f;
+
+	//	Statements
+    if (pDisk)
+    {
+        for (f = 0; f < pDisk->countFrames; f++)
+            if (pDisk->frames[f].page && pDisk->frames[f].dirty)
+                _writeFrame(pDisk, f);
+        memcpy(header.magic, DISK_MAGIC, 4);
+        header.root = pDisk->root;
+        header.countPages = pDisk->countPages;
+        header.countRecords = (unsigned) pDisk->countRecords;
+        fseek(pDisk->fp, 0, SEEK_SET);
+        if (fwrite(&header, sizeof(DISK_HEADER), 1, pDisk->fp) != 1 || fclose(pDisk->fp) != 0)
+            printf("Could not save the database.\n");
+        memFree(MEM_INDEX, pDisk->buckets, pDisk->countFrames * sizeof(int));
+        memFree(MEM_INDEX, pDisk->pages, (size_t) pDisk->countFrames * DISK_PAGE);
+        memFree(MEM_INDEX, pDisk->frames, pDisk->countFrames * sizeof(DISK_FRAME));
+        memFree(MEM_HEADER, pDisk, sizeof(DISK));
+    }
+    return NULL;
+}	// diskClose
+
+
+/*	================== diskFind =================
+ This function searches the database for a code.
+ Pre		pDisk - pointer to the database
+ key - CODE_KEY of the code
+ pAirport - receives the record
+ Post		pAirport is filled if the code was found
+ Return	true if found
+ */
+bool diskFind (DISK* pDisk, unsigned key, DISK_AIRPORT* pAirport)
+{
+	//	Local Declarations
+    DISK_LEAF* pLeaf;
+    bool found;
+    int f;
+    int i;
+    unsigned long long start = latencyStart();
+
+	//	Statements
+    f = _fetch(pDisk, _findLeaf(pDisk, key), false);
+    pLeaf = (DISK_LEAF*) DISK_FRAME_DATA(pDisk, f);
+    i = _leafSearch(pLeaf, key);
+    found = i < pLeaf->count && pLeaf->records[i].key == key;
+    if (found)
+        _toAirport(&pLeaf->records[i], pAirport);
+    _release(pDisk, f, false);
+    latencyRecord(LAT_FIND, start);
+    return found;
+}	// diskFind
+
+
+/*	================== diskInsert =================
+ This function adds a record to the database, splitting
+ the full pages on its way up.
+ Pre		pDisk - pointer to the database
+ pAirport - record to add
+ Post		record is stored
+ Return	false if the code is already stored
+ */
+bool diskInsert (DISK* pDisk, DISK_AIRPORT* pAirport)
+{
+	//	Local Declarations
+    DISK_RECORD record;
+    DISK_INNER* pRoot;
+    unsigned upKey;
+    unsigned upPage;
+    unsigned root;
+    int result;
+    int f;
+    unsigned long long start = latencyStart();
+
+	//	Statements
+    memset(&record, 0, sizeof(DISK_RECORD));
+    record.key = CODE_KEY(pAirport->arpCode);
+    record.latitude = pAirport->latitude;
+    record.longitude = pAirport->longitude;
+    strncpy(record.city, pAirport->city, sizeof(record.city) - 1);
+
+    result = _insert(pDisk, pDisk->root, &record, &upKey, &upPage);
+    if (result == 1)
+    {
+        // the root was split: the tree grows by one level
+        f = _newPage(pDisk, &root);
+        pRoot = (DISK_INNER*) DISK_FRAME_DATA(pDisk, f);
+        pRoot->type = DISK_INNER_PAGE;
+        pRoot->count = 1;
+        pRoot->children[0] = pDisk->root;
+        pRoot->children[1] = upPage;
+        pRoot->keys[0] = upKey;
+        _release(pDisk, f, true);
+        pDisk->root = root;
+        pDisk->height++;
+    }
+    if (result >= 0)
+        pDisk->countRecords++;
+    latencyRecord(LAT_INSERT, start);
+    return result >= 0;
+}	// diskInsert
+
+
+/*	================== diskDelete =================
+ This function removes a record from its leaf.
+ Pre		pDisk - pointer to the database
+ key - CODE_KEY of the code
+ Post		record is removed
+ Return	false if the code is not stored
+ */
+bool diskDelete (DISK* pDisk, unsigned key)
+{
+	//	Local Declarations
+    DISK_LEAF* pLeaf;
+    bool found;
+    int f;
+    int i;
+    unsigned long long start = latencyStart();
+
+	//	Statements
+    f = _fetch(pDisk, _findLeaf(pDisk, key), false);
+    pLeaf = (DISK_LEAF*) DISK_FRAME_DATA(pDisk, f);
+    i = _leafSearch(pLeaf, key);
+    found = i < pLeaf->count && pLeaf->records[i].key == key;
+    if (found)
+    {
+        memmove(&pLeaf->records[i], &pLeaf->records[i + 1],
+                (pLeaf->count - i - 1) * sizeof(DISK_RECORD));
+        pLeaf->count--;
+        pDisk->countRecords--;
+    }
+    _release(pDisk, f, found);
+    latencyRecord(LAT_DELETE, start);
+    return found;
+}	// diskDelete
+
+
+/*	================== diskRange =================
+ This function processes, in key order, every record
+ whose code is between two codes.
+ Pre		pDisk - pointer to the database
+ low, high - CODE_KEY of the first and last codes
+ process - function called with each record
+ (a DISK_AIRPORT, valid during the call)
+ Post		records are processed
+ Return	number of records processed
+ */
+int diskRange (DISK* pDisk, unsigned low, unsigned high, void (*process) (void* dataPtr))
+{
+	//	Local Declarations
+    DISK_LEAF* pLeaf;
+    DISK_AIRPORT airport;
+    unsigned page;
+    int count = 0;
+    int f;
+    int i;
+
+	//	Statements
+    page = _findLeaf(pDisk, low);
+    while (page)
+    {
+        f = _fetch(pDisk, page, false);
+        pLeaf = (DISK_LEAF*) DISK_FRAME_DATA(pDisk, f);
+        for (i = _leafSearch(pLeaf, low); i < pLeaf->count; i++)
+        {
+            if (pLeaf->records[i].key > high)
+                break;
+            _toAirport(&pLeaf->records[i], &airport);
+            process(&airport);
+            count++;
+        }
+        page = i < pLeaf->count ? 0 : pLeaf->next;
+        _release(pDisk, f, false);
+    }
+    return count;
+}	// diskRange
+
+
+/*	================== diskImport =================
+ This function adds every airport of a data file to
+ the database. The codes already stored are kept.
+ Pre		pDisk - pointer to the database
+ fileName - name of the data file
+ Post		airports are added
+ Return	number of airports added, -1 if the file
+ could not be opened
+ */
+int diskImport (DISK* pDisk, const char* fileName)
+{
+	//	Local Declarations
+    ASYNC_FILE* fpIn;
+    DISK_AIRPORT airport;
+    char line[128];
+    int count = 0;
+    int i;
+
+	//	Statements
+    if (!(fpIn = asyncOpen(fileName, false)))
+        return -1;
+    while (asyncLine(fpIn, line, sizeof(line)))
+    {
+        if (parseLine(line, airport.arpCode, airport.city, &airport.latitude, &airport.longitude) != 1)
+            continue;
+        for (i = 0; airport.arpCode[i]; i++)
+            airport.arpCode[i] = toupper(airport.arpCode[i]);
+        if (diskInsert(pDisk, &airport))
+            count++;
+    }
+    asyncClose(fpIn);
+    return count;
+}	// diskImport
+
+
+/*	================== diskExport =================
+ This function writes every airport, in key order, to
+ a data file in the format of the input file.
+ Pre		pDisk - pointer to the database
+ fileName - name of the data file
+ Post		file is written
+ Return	true if the whole file was written
+ */
+bool diskExport (DISK* pDisk, const char* fileName)
+{
+	//	Local Declarations
+    ASYNC_FILE* fileOut;
+    DISK_LEAF* pLeaf;
+    DISK_AIRPORT airport;
+    unsigned page;
+    int f;
+    int i;
+    unsigned long long start = latencyStart();
+
+	//	Statements
+    if (!(fileOut = asyncOpen(fileName, true)))
+        return false;
+    page = _findLeaf(pDisk, 0);
+    while (page)
+    {
+        f = _fetch(pDisk, page, false);
+        pLeaf = (DISK_LEAF*) DISK_FRAME_DATA(pDisk, f);
+        for (i = 0; i < pLeaf->count; i++)
+        {
+            _toAirport(&pLeaf->records[i], &airport);
+            processDiskFile(&airport, fileOut);
+        }
+        page = pLeaf->next;
+        _release(pDisk, f, false);
+    }
+    latencyRecord(LAT_OUTPUT, start);
+    return asyncClose(fileOut);
+}	// diskExport
+
+
+/*	================== diskReport =================
+ This function prints the size of the database and
+ the use of the buffer pool.
+ Pre		pDisk - pointer to the database
+ Post		report is printed
+ Return
+ */
+void diskReport (DISK* pDisk)
+{
+	//	Local Declarations
+    long long requests = pDisk->hits + pDisk->reads;
+
+	//	Statements
+    _findLeaf(pDisk, 0);
+    printf("\nDisk database: %d airports in %u pages (%lld KB), %d levels\n",
+           pDisk->countRecords, pDisk->countPages,
+           (long long) pDisk->countPages * DISK_PAGE / 1024, pDisk->height + 1);
+    printf("Buffer pool: %d frames (%lld KB), %lld requests, %.1f%% hits, %lld reads, %lld writes\n\n",
+           pDisk->countFrames, (long long) pDisk->countFrames * DISK_PAGE / 1024, requests,
+           requests ? 100.0 * pDisk->hits / requests : 0.0, pDisk->reads, pDisk->writes);
+    return;
+}	// diskReport
+
+
+/*	================== _insert =================
+ Adds a record to the subtree of page. Returns -1 if
+ the code is already there, 0 once it is added, and 1
+ when page had to be split: upKey and upPage then give
+ the first code and the page of the new right half,
+ to be added to the parent.
+ */
+static int _insert (DISK* pDisk, unsigned page, DISK_RECORD* pRecord, unsigned* upKey, unsigned* upPage)
+{
+	//	Local Declarations
+    DISK_LEAF* pLeaf;
+    DISK_LEAF* pRight;
+    DISK_INNER* pInner;
+    DISK_INNER* pRightInner;
+    DISK_RECORD records[DISK_LEAF_MAX + 1];
+    unsigned keys[DISK_INNER_MAX + 1];
+    unsigned children[DISK_INNER_MAX + 2];
+    unsigned child;
+    int result;
+    int half;
+    int f;
+    int fRight;
+    int i;
+
+	//	Statements
+    f = _fetch(pDisk, page, false);
+    pLeaf = (DISK_LEAF*) DISK_FRAME_DATA(pDisk, f);
+    if (pLeaf->type == DISK_LEAF_PAGE)
+    {
+        i = _leafSearch(pLeaf, pRecord->key);
+        if (i < pLeaf->count && pLeaf->records[i].key == pRecord->key) {
+            _release(pDisk, f, false);
+            return -1;
+        }
+        if (pLeaf->count < DISK_LEAF_MAX)
+        {
+            memmove(&pLeaf->records[i + 1], &pLeaf->records[i],
+                    (pLeaf->count - i) * sizeof(DISK_RECORD));
+            pLeaf->records[i] = *pRecord;
+            pLeaf->count++;
+            _release(pDisk, f, true);
+            return 0;
+        }
+
+        // split the leaf in two halves
+        memcpy(records, pLeaf->records, i * sizeof(DISK_RECORD));
+        records[i] = *pRecord;
+        memcpy(&records[i + 1], &pLeaf->records[i], (DISK_LEAF_MAX - i) * sizeof(DISK_RECORD));
+        half = (DISK_LEAF_MAX + 1) / 2;
+        fRight = _newPage(pDisk, upPage);
+        pRight = (DISK_LEAF*) DISK_FRAME_DATA(pDisk, fRight);
+        pRight->type = DISK_LEAF_PAGE;
+        pRight->count = (unsigned short) (DISK_LEAF_MAX + 1 - half);
+        pRight->next = pLeaf->next;
+        memcpy(pRight->records, &records[half], pRight->count * sizeof(DISK_RECORD));
+        pLeaf->count = (unsigned short) half;
+        pLeaf->next = *upPage;
+        memcpy(pLeaf->records, records, half * sizeof(DISK_RECORD));
+        *upKey = pRight->records[0].key;
+        _release(pDisk, fRight, true);
+        _release(pDisk, f, true);
+        return 1;
+    }
+
+    // inner page: it is not kept in use while the child is changed
+    pInner = (DISK_INNER*) pLeaf;
+    i = _innerSearch(pInner, pRecord->key);
+    child = pInner->children[i];
+    _release(pDisk, f, false);
+    if ((result = _insert(pDisk, child, pRecord, upKey, upPage)) != 1)
+        return result;
+
+    f = _fetch(pDisk, page, false);
+    pInner = (DISK_INNER*) DISK_FRAME_DATA(pDisk, f);
+    if (pInner->count < DISK_INNER_MAX)
+    {
+        memmove(&pInner->keys[i + 1], &pInner->keys[i], (pInner->count - i) * sizeof(unsigned));
+        memmove(&pInner->children[i + 2], &pInner->children[i + 1],
+                (pInner->count - i) * sizeof(unsigned));
+        pInner->keys[i] = *upKey;
+        pInner->children[i + 1] = *upPage;
+        pInner->count++;
+        _release(pDisk, f, true);
+        return 0;
+    }
+
+    // split the inner page: the middle key goes up to the parent
+    memcpy(keys, pInner->keys, i * sizeof(unsigned));
+    keys[i] = *upKey;
+    memcpy(&keys[i + 1], &pInner->keys[i], (DISK_INNER_MAX - i) * sizeof(unsigned));
+    memcpy(children, pInner->children, (i + 1) * sizeof(unsigned));
+    children[i + 1] = *upPage;
+    memcpy(&children[i + 2], &pInner->children[i + 1], (DISK_INNER_MAX - i) * sizeof(unsigned));
+    half = (DISK_INNER_MAX + 1) / 2;
+    fRight = _newPage(pDisk, upPage);
+    pRightInner = (DISK_INNER*) DISK_FRAME_DATA(pDisk, fRight);
+    pRightInner->type = DISK_INNER_PAGE;
+    pRightInner->count = (unsigned short) (DISK_INNER_MAX - half);
+    memcpy(pRightInner->keys, &keys[half + 1], pRightInner->count * sizeof(unsigned));
+    memcpy(pRightInner->children, &children[half + 1], (pRightInner->count + 1) * sizeof(unsigned));
+    pInner->count = (unsigned short) half;
+    memcpy(pInner->keys, keys, half * sizeof(unsigned));
+    memcpy(pInner->children, children, (half + 1) * sizeof(unsigned));
+    *upKey = keys[half];
+    _release(pDisk, fRight, true);
+    _release(pDisk, f, true);
+    return 1;
+}	// _insert
+
+
+/*	================== _findLeaf =================
+ Goes down from the root to the leaf that holds (or
+ would hold) key, one page in use at a time, and
+ returns its page.
+ */
+static unsigned _findLeaf (DISK* pDisk, unsigned key)
+{
+	//	Local Declarations
+    DISK_INNER* pInner;
+    unsigned page = pDisk->root;
+    unsigned child;
+    int height = 0;
+    int f;
+
+	//	Statements
+    while (true)
+    {
+        f = _fetch(pDisk, page, false);
+        pInner = (DISK_INNER*) DISK_FRAME_DATA(pDisk, f);
+        if (pInner->type == DISK_LEAF_PAGE) {
+            _release(pDisk, f, false);
+            pDisk->height = height;
+            return page;
+        }
+        child = pInner->children[_innerSearch(pInner, key)];
+        _release(pDisk, f, false);
+        page = child;
+        height++;
+    }
+}	// _findLeaf
+
+
+/*	================== _leafSearch =================
+ Returns the position of the first record of a leaf
+ whose code is not less than key.
+ */
+static int _leafSearch (DISK_LEAF* pLeaf, unsigned key)
+{
+	//	Local Declarations
+    int low = 0;
+    int high = pLeaf->count;
+    int middle;
+
+	//	Statements
+    while (low < high)
+    {
+        middle = (low + high) / 2;
+        if (pLeaf->records[middle].key < key)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}	// _leafSearch
+
+
+/*	================== _innerSearch =================
+ Returns the child of an inner page to follow for
+ key: the number of its keys not greater than key.
+ */
+static int _innerSearch (DISK_INNER* pInner, unsigned key)
+{
+	//	Local Declarations
+    int low = 0;
+    int high = pInner->count;
+    int middle;
+
+	//	Statements
+    while (low < high)
+    {
+        middle = (low + high) / 2;
+        if (pInner->keys[middle] <= key)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}	// _innerSearch
+
+
+/*	================== _newPage =================
+ Adds a page at the end of the file and returns the
+ frame holding it, cleared and in use.
+ */
+static int _newPage (DISK* pDisk, unsigned* page)
+{
+	//	Statements
+    *page = pDisk->countPages++;
+    return _fetch(pDisk, *page, true);
+}	// _newPage
+
+
+/*	================== _fetch =================
+ Returns the frame holding a page, reading the page
+ into a free frame if it is not in the pool. The
+ frame stays in use until _release. A fresh page is
+ cleared instead of read.
+ */
+static int _fetch (DISK* pDisk, unsigned page, bool fresh)
+{
+	//	Local Declarations
+    DISK_FRAME* pFrame;
+    int bucket = (int) (page % (unsigned) pDisk->countFrames);
+    int f;
+
+	//	Statements
+    for (f = pDisk->buckets[bucket]; f != -1; f = pDisk->frames[f].nextFrame)
+    {
+        if (pDisk->frames[f].page == page)
+        {
+            pDisk->hits++;
+            pDisk->frames[f].pins++;
+            pDisk->frames[f].referenced = true;
+            return f;
+        }
+    }
+
+    f = _evict(pDisk);
+    pFrame = &pDisk->frames[f];
+    if (fresh)
+    {
+        memset(DISK_FRAME_DATA(pDisk, f), 0, DISK_PAGE);
+        pFrame->dirty = true;
+    }
+    else
+    {
+        if (fseek(pDisk->fp, (long) page * DISK_PAGE, SEEK_SET) != 0 ||
+            fread(DISK_FRAME_DATA(pDisk, f), DISK_PAGE, 1, pDisk->fp) != 1) {
+            printf("Error reading page %u of the database\n", page);
+            exit(211);
+        }
+        pDisk->reads++;
+        pFrame->dirty = false;
+    }
+    pFrame->page = page;
+    pFrame->pins = 1;
+    pFrame->referenced = true;
+    pFrame->nextFrame = pDisk->buckets[bucket];
+    pDisk->buckets[bucket] = f;
+    return f;
+}	// _fetch
+
+
+/*	================== _release =================
+ Ends the use of a frame; dirty marks its page as
+ changed.
+ */
+static void _release (DISK* pDisk, int f, bool dirty)
+{
+	//	Statements
+    pDisk->frames[f].pins--;
+    if (dirty)
+        pDisk->frames[f].dirty = true;
+    return;
+}	// _release
+
+
+/*	================== _evict =================
+ Turns the clock hand until it finds a frame not in
+ use and not used since its last pass, writes its page
+ back if changed, and returns it empty.
+ */
+static int _evict (DISK* pDisk)
+{
+	//	Local Declarations
+    DISK_FRAME* pFrame;
+    int* pLink;
+    int sweep;
+    int f;
+
+	//	Statements
+    for (sweep = 0; sweep < 2 * pDisk->countFrames; sweep++)
+    {
+        f = pDisk->hand;
+        pDisk->hand = (pDisk->hand + 1) % pDisk->countFrames;
+        pFrame = &pDisk->frames[f];
+        if (pFrame->pins > 0)
+            continue;
+        if (pFrame->referenced) {
+            pFrame->referenced = false;
+            continue;
+        }
+        if (pFrame->page)
+        {
+            if (pFrame->dirty)
+                _writeFrame(pDisk, f);
+            pLink = &pDisk->buckets[pFrame->page % (unsigned) pDisk->countFrames];
+            while (*pLink != f)
+                pLink = &pDisk->frames[*pLink].nextFrame;
+            *pLink = pFrame->nextFrame;
+            pFrame->page = 0;
+        }
+        return f;
+    }
+    printf("Every page of the buffer pool is in use\n");
+    exit(212);
+}	// _evict
+
+
+/*	================== _writeFrame =================
+ Writes the page of a frame back to the file.
+ */
+static void _writeFrame (DISK* pDisk, int f)
+{
+	//	Statements
+    if (fseek(pDisk->fp, (long) pDisk->frames[f].page * DISK_PAGE, SEEK_SET) != 0 ||
+        fwrite(DISK_FRAME_DATA(pDisk, f), DISK_PAGE, 1, pDisk->fp) != 1) {
+        printf("Error writing page %u of the database\n", pDisk->frames[f].page);
+        exit(213);
+    }
+    pDisk->writes++;
+    pDisk->frames[f].dirty = false;
+    return;
+}	// _writeFrame
+
+
+/*	================== _toAirport =================
+ Copies a stored record, with its city name, into a
+ DISK_AIRPORT.
+ */
+static void _toAirport (DISK_RECORD* pRecord, DISK_AIRPORT* pAirport)
+{
+	//	Statements
+    pAirport->arpCode[0] = (char) (pRecord->key >> 16);
+    pAirport->arpCode[1] = (char) (pRecord->key >> 8 & 0xFF);
+    pAirport->arpCode[2] = (char) (pRecord->key & 0xFF);
+    pAirport->arpCode[3] = '\0';
+    memcpy(pAirport->city, pRecord->city, sizeof(pAirport->city));
+    pAirport->latitude = pRecord->latitude;
+    pAirport->longitude = pRecord->longitude;
+    return;
+}	// _toAirport
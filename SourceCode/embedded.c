@@ -0,0 +1,70 @@
+/* embedded.c
+ This file starts the program from the database compiled into it.
+ data_embedded.h (written by tools/embed.c) holds the hash table,
+ the tree, the records, the city names and the indexes as one
+ static structure, already linked together, so nothing has to be
+ read, parsed or allocated at startup. The blocks of the structure
+ are counted by the memory functions like allocated ones, and are
+ never given to free when they are replaced or deleted.
+
+ Compiled only with EMBEDDED_DATA defined.
+
+ Functions:
+ buildEmbedded
+
+ */
+
+#include "header.h"
+
+#ifdef EMBEDDED_DATA
+#ifdef COMPACT_LINKS
+#error "the embedded database is linked by pointers, build it without COMPACT_LINKS"
+#endif
+#include "data_embedded.h"
+
+/*	================== buildEmbedded =================
+ This function installs the embedded database.
+ Pre
+ Post		city pool is the embedded one
+ Return	pointer to the embedded HEAD structure
+ */
+HEAD* buildEmbedded (void)
+{
+	//	Local Declarations
+    int i;
+
+	//	Statements
+    memStatic(&embedded, sizeof(embedded));
+    *cityPoolState() = embedded.cityPool;
+
+    // count every block with the size it will be freed with
+    memTrack(MEM_HEADER, sizeof(HEAD), 1);
+    memTrack(MEM_HEADER, sizeof(HASH), 1);
+    memTrack(MEM_HEADER, sizeof(BST_TREE), 1);
+    memTrack(MEM_HEADER, sizeof(POOL), 1);
+    memTrack(MEM_SLOT, embedded.hash.arraySize * sizeof(HASH_NODE), 1);
+    if (embedded.hash.pFilter) {
+        memTrack(MEM_HEADER, sizeof(FILTER), 1);
+        memTrack(MEM_INDEX, sizeof(embedded.filterCounters), 1);
+    }
+    memTrack(MEM_RECORD, EMBEDDED_RECORDS * sizeof(DATA), EMBEDDED_RECORDS);
+    memTrack(MEM_STRING, embedded.cityPool.capacity, 1);
+    memTrack(MEM_STRING, embedded.cityPool.nameCapacity * sizeof(STR_NAME), 1);
+    memTrack(MEM_STRING, embedded.cityPool.indexSize * sizeof(unsigned), 1);
+
+    memTrack(MEM_HEADER, sizeof(CITY_INDEX), 1);
+    memTrack(MEM_INDEX, embedded.cityIndex.capacity * sizeof(CITY_ENTRY), 1);
+    for (i = 0; i < embedded.cityIndex.count; i++)
+        memTrack(MEM_INDEX, embedded.cityEntries[i].capacity * sizeof(DATA*), 1);
+
+    memTrack(MEM_HEADER, sizeof(COLUMNS), 1);
+    memTrack(MEM_INDEX, embedded.columns.capacity * 4, 1);
+    memTrack(MEM_INDEX, embedded.columns.capacity * sizeof(float), 1);
+    memTrack(MEM_INDEX, embedded.columns.capacity * sizeof(float), 1);
+    memTrack(MEM_INDEX, embedded.columns.capacity * sizeof(unsigned), 1);
+    memTrack(MEM_INDEX, embedded.columns.capacity * sizeof(DATA*), 1);
+
+    return &embedded.head;
+}	// buildEmbedded
+
+#endif
@@ -0,0 +1,245 @@
+/* export.c
+ This file contains the definitons of the functions that write
+ the records to a file in key order on several threads. The
+ records in key order (the frozen index) are split into one run
+ of ranks per worker. Each worker formats its run into its own
+ buffer; the offset of a run in the file is the length of the
+ runs before it, and each worker then writes its buffer at that
+ offset with pwrite, so the runs reach the file at once and in
+ order. The lines are the same as the ones of outputFile.
+
+ Functions:
+ exportSorted
+
+ Private Functions:
+ _exportThreads
+ _runWorkers
+ _formatRun
+ _writeRun
+ */
+
+#include "header.h"
+#ifndef _MSC_VER
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define EXPORT_MAX_THREADS    16
+#define EXPORT_PARALLEL_SIZE  4096  // records below which one worker formats the file
+#define EXPORT_GUESS          64    // bytes first allowed per line of a run
+
+//	Part of the key order handled by one worker
+typedef struct{
+    DATA**    sorted;       // first record of the run
+    int       count;        // records in the run
+    char*     buffer;       // lines of the run
+    size_t    size;         // bytes allocated for buffer
+    size_t    length;       // bytes of lines in buffer
+    long long offset;       // position of the run in the file
+    int       fd;           // file written by _writeRun
+    bool      failed;       // the run could not be written
+    bool      started;      // the worker has its own thread
+}EXPORT_RUN;
+
+static int _exportThreads (int count);
+static void _runWorkers (void* (*pass) (void* pWork), EXPORT_RUN* runs, int countThreads);
+static void* _formatRun (void* pWork);
+#ifndef _MSC_VER
+static void* _writeRun (void* pWork);
+#endif
+
+/*	================== exportSorted =================
+ This function writes every record to a file in key
+ order, one line per record like outputFile.
+ Pre		pHeader - pointer to HEAD structure
+ fileName - name of the file to create
+ Post	    file holds the records in key order
+ Return	true if the whole file was written
+ */
+bool exportSorted (HEAD* pHeader, const char* fileName)
+{
+	//	Local Declarations
+    EXPORT_RUN runs[EXPORT_MAX_THREADS];
+    FROZEN* pFrozen;
+    int countThreads;
+    int first = 0;
+    int t;
+    long long offset = 0;
+    bool success = true;
+#ifdef _MSC_VER
+    FILE* fpOut;
+#else
+    int fd;
+#endif
+    unsigned long long start = latencyStart();
+
+	//	Statements
+#ifdef _MSC_VER
+    if (!(fpOut = fopen(fileName, "wb")))
+        return false;
+#else
+    if ((fd = open(fileName, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0)
+        return false;
+#endif
+    pHeader->pFrozen = frozenBuild(pHeader->pFrozen, pHeader->pTree);
+    pFrozen = pHeader->pFrozen;
+
+    countThreads = _exportThreads(pFrozen->count);
+    memset(runs, 0, sizeof(runs));
+    for (t = 0; t < countThreads; t++)
+    {
+        runs[t].sorted = pFrozen->sorted + first;
+        runs[t].count = (int) ((long long) pFrozen->count * (t + 1) / countThreads) - first;
+        runs[t].size = (size_t) runs[t].count * EXPORT_GUESS + LINE_SIZE;
+        if (!(runs[t].buffer = (char*) memAlloc(MEM_INDEX, runs[t].size))) {
+            printf("Memory allocation error\n");
+            exit(100);
+        }
+        first += runs[t].count;
+    }
+    _runWorkers(_formatRun, runs, countThreads);
+
+    // each run starts where the runs before it end
+    for (t = 0; t < countThreads; t++)
+    {
+        runs[t].offset = offset;
+        offset += (long long) runs[t].length;
+    }
+#ifdef _MSC_VER
+    for (t = 0; t < countThreads; t++)
+        if (fwrite(runs[t].buffer, 1, runs[t].length, fpOut) != runs[t].length)
+            success = false;
+    if (fclose(fpOut) != 0)
+        success = false;
+#else
+    for (t = 0; t < countThreads; t++)
+        runs[t].fd = fd;
+    _runWorkers(_writeRun, runs, countThreads);
+    for (t = 0; t < countThreads; t++)
+        if (runs[t].failed)
+            success = false;
+    if (close(fd) != 0)
+        success = false;
+#endif
+
+    for (t = 0; t < countThreads; t++)
+        memFree(MEM_INDEX, runs[t].buffer, runs[t].size);
+    latencyRecord(LAT_OUTPUT, start);
+    return success;
+}	// exportSorted
+
+
+/*	================== _exportThreads =================
+ Picks the number of workers for an export: one for
+ small databases, otherwise one per processor.
+ */
+static int _exportThreads (int count)
+{
+	//	Local Declarations
+    int countThreads = 1;
+
+	//	Statements
+#ifndef _MSC_VER
+    if (count >= EXPORT_PARALLEL_SIZE)
+        countThreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (countThreads < 1)
+        countThreads = 1;
+    if (countThreads > EXPORT_MAX_THREADS)
+        countThreads = EXPORT_MAX_THREADS;
+    return countThreads;
+}	// _exportThreads
+
+
+/*	================== _runWorkers =================
+ Runs pass on every run and waits for all of them. The
+ first run is done on the caller's thread, and so is
+ any run whose thread cannot be started.
+ */
+static void _runWorkers (void* (*pass) (void* pWork), EXPORT_RUN* runs, int countThreads)
+{
+	//	Local Declarations
+	int t;
+#ifndef _MSC_VER
+    pthread_t threads[EXPORT_MAX_THREADS];
+
+	//	Statements
+    for (t = 1; t < countThreads; t++) {
+        if (pthread_create(&threads[t], NULL, pass, &runs[t]) != 0)
+            pass(&runs[t]);
+        else
+            runs[t].started = true;
+    }
+    pass(&runs[0]);
+    for (t = 1; t < countThreads; t++) {
+        if (runs[t].started)
+            pthread_join(threads[t], NULL);
+        runs[t].started = false;
+    }
+#else
+	//	Statements
+    for (t = 0; t < countThreads; t++)
+        pass(&runs[t]);
+#endif
+    return;
+}	// _runWorkers
+
+
+/*	================== _formatRun =================
+ Formats the records of a run into its buffer, which
+ is doubled when the next line might not fit.
+ */
+static void* _formatRun (void* pWork)
+{
+	//	Local Declarations
+    EXPORT_RUN* pRun = (EXPORT_RUN*) pWork;
+    char* buffer;
+    int i;
+
+	//	Statements
+    for (i = 0; i < pRun->count; i++)
+    {
+        if (pRun->length + LINE_SIZE > pRun->size)
+        {
+            if (!(buffer = (char*) memAlloc(MEM_INDEX, pRun->size * 2))) {
+                printf("Memory allocation error\n");
+                exit(100);
+            }
+            memcpy(buffer, pRun->buffer, pRun->length);
+            memFree(MEM_INDEX, pRun->buffer, pRun->size);
+            pRun->buffer = buffer;
+            pRun->size *= 2;
+        }
+        pRun->length += formatLine(pRun->sorted[i], pRun->buffer + pRun->length);
+    }
+    return NULL;
+}	// _formatRun
+
+
+#ifndef _MSC_VER
+/*	================== _writeRun =================
+ Writes the buffer of a run at its offset in the file,
+ continuing after short writes.
+ */
+static void* _writeRun (void* pWork)
+{
+	//	Local Declarations
+    EXPORT_RUN* pRun = (EXPORT_RUN*) pWork;
+    size_t done = 0;
+    ssize_t written;
+
+	//	Statements
+    while (done < pRun->length)
+    {
+        written = pwrite(pRun->fd, pRun->buffer + done, pRun->length - done,
+                         (off_t) (pRun->offset + (long long) done));
+        if (written <= 0) {
+            pRun->failed = true;
+            break;
+        }
+        done += (size_t) written;
+    }
+    return NULL;
+}	// _writeRun
+#endif
@@ -0,0 +1,280 @@
+/* filter.c
+ This file contains the definitons of the functions to maintain
+ the membership filter that sits in front of the hash table.
+ The filter is a blocked counting Bloom filter: every airport
+ code sets FILTER_PROBES counters inside one 64 byte block, so
+ a lookup touches a single cache line. When any of the counters
+ of a code is zero the code is certainly not in the database,
+ and the hash table does not need to be searched. Counters
+ (instead of bits) allow codes to be removed again.
+
+ Functions:
+ filterCreate
+ filterAdd
+ filterRemove
+ filterCheck
+ filterMissed
+ filterFits
+ filterResize
+ filterReport
+ filterDestroy
+
+ Private Functions:
+ _filterKey
+ */
+
+#include "header.h"
+
+#define FILTER_BLOCK      64    // counters per block (one cache line)
+#define FILTER_PROBES     4     // counters set per code
+#define FILTER_PER_KEY    16    // counters reserved per expected code
+#define FILTER_SATURATED  255   // counter stays stuck once it gets here
+
+static unsigned _filterKey (FILTER* pFilter, DATA* pData, unsigned* probes);
+
+/*	================== filterCreate =================
+ This function creates an empty filter sized for the
+ expected number of codes.
+ Pre		expected - number of codes expected
+ Post		filter is allocated, all counters zero
+ Return	pointer to the filter
+ */
+FILTER* filterCreate (int expected)
+{
+	//	Local Declarations
+    FILTER* pFilter;
+    unsigned countBlocks = 1;
+
+	//	Statements
+    while ((long) countBlocks * FILTER_BLOCK < (long) expected * FILTER_PER_KEY)
+        countBlocks *= 2;
+
+    if (!(pFilter = (FILTER*) memCalloc(MEM_HEADER, 1, sizeof(FILTER))) ||
+        !(pFilter->counters = (unsigned char*) memCalloc(MEM_INDEX, countBlocks, FILTER_BLOCK))) {
+        printf("Error allocating filter\n");
+        exit(130);
+    }
+    pFilter->countBlocks = countBlocks;
+
+    return pFilter;
+}	// filterCreate
+
+
+/*	================== filterAdd =================
+ This function adds the code of a record to the filter.
+ Pre		pFilter - pointer to the filter
+ pData - record being inserted
+ Post		counters of the code are increased
+ Return
+ */
+void filterAdd (FILTER* pFilter, DATA* pData)
+{
+	//	Local Declarations
+    unsigned probes[FILTER_PROBES];
+    unsigned char* block;
+    int i;
+
+	//	Statements
+    block = pFilter->counters + _filterKey(pFilter, pData, probes) * FILTER_BLOCK;
+    for (i = 0; i < FILTER_PROBES; i++) {
+        if (block[probes[i]] < FILTER_SATURATED)
+            block[probes[i]]++;
+    }
+    pFilter->countKeys++;
+    return;
+}	// filterAdd
+
+
+/*	================== filterRemove =================
+ This function removes the code of a record from the
+ filter. Saturated counters are left alone, since they
+ no longer know how many codes use them.
+ Pre		pFilter - pointer to the filter
+ pData - record being deleted (still in the filter)
+ Post		counters of the code are decreased
+ Return
+ */
+void filterRemove (FILTER* pFilter, DATA* pData)
+{
+	//	Local Declarations
+    unsigned probes[FILTER_PROBES];
+    unsigned char* block;
+    int i;
+
+	//	Statements
+    block = pFilter->counters + _filterKey(pFilter, pData, probes) * FILTER_BLOCK;
+    for (i = 0; i < FILTER_PROBES; i++) {
+        if (block[probes[i]] > 0 && block[probes[i]] < FILTER_SATURATED)
+            block[probes[i]]--;
+    }
+    pFilter->countKeys--;
+    return;
+}	// filterRemove
+
+
+/*	================== filterCheck =================
+ This function tells whether a code may be stored.
+ Pre		pFilter - pointer to the filter
+ pData - record holding the code searched
+ Post		query is counted
+ Return	false if the code is certainly absent
+ true if it may be present
+ */
+bool filterCheck (FILTER* pFilter, DATA* pData)
+{
+	//	Local Declarations
+    unsigned probes[FILTER_PROBES];
+    unsigned char* block;
+    int i;
+
+	//	Statements
+    pFilter->countQueries++;
+    block = pFilter->counters + _filterKey(pFilter, pData, probes) * FILTER_BLOCK;
+    for (i = 0; i < FILTER_PROBES; i++) {
+        if (block[probes[i]] == 0) {
+            pFilter->countNegatives++;
+            return false;
+        }
+    }
+    return true;
+}	// filterCheck
+
+
+/*	================== filterMissed =================
+ This function is called when filterCheck let a code
+ through that was then not found: a false positive.
+ Pre		pFilter - pointer to the filter
+ Post		false positive is counted
+ Return
+ */
+void filterMissed (FILTER* pFilter)
+{
+	//	Statements
+    pFilter->countFalse++;
+    return;
+}	// filterMissed
+
+
+/*	================== filterFits =================
+ This function tells whether the filter is still sized
+ well for the given number of codes.
+ Pre		pFilter - pointer to the filter
+ countKeys - number of codes to be held
+ Post
+ Return	true if no resize is needed
+ */
+bool filterFits (FILTER* pFilter, int countKeys)
+{
+	//	Local Declarations
+    long capacity;
+
+	//	Statements
+    capacity = (long) pFilter->countBlocks * FILTER_BLOCK / FILTER_PER_KEY;
+    return countKeys <= capacity && (pFilter->countBlocks == 1 || countKeys * 4L > capacity);
+}	// filterFits
+
+
+/*	================== filterResize =================
+ This function rebuilds the filter for a new number
+ of codes, keeping its counts of queries.
+ Pre		pFilter - pointer to the filter
+ records - every record in the database
+ countRecords - number of records
+ Post		old filter is freed
+ Return	pointer to the new filter
+ */
+FILTER* filterResize (FILTER* pFilter, DATA** records, int countRecords)
+{
+	//	Local Declarations
+    FILTER* newFilter;
+    int i;
+
+	//	Statements
+    newFilter = filterCreate(countRecords * 2);
+    for (i = 0; i < countRecords; i++)
+        filterAdd(newFilter, records[i]);
+    newFilter->countQueries = pFilter->countQueries;
+    newFilter->countNegatives = pFilter->countNegatives;
+    newFilter->countFalse = pFilter->countFalse;
+    filterDestroy(pFilter);
+
+    return newFilter;
+}	// filterResize
+
+
+/*	================== filterReport =================
+ This function prints the size of the filter and how
+ well it has been answering.
+ Pre		pFilter - pointer to the filter
+ Post		prints : size of the filter
+ queries and rejected codes
+ false positive rate
+ Return
+ */
+void filterReport (FILTER* pFilter)
+{
+	//	Local Declarations
+    long absent;
+
+	//	Statements
+    absent = pFilter->countNegatives + pFilter->countFalse;
+    printf("The filter holds %d codes in %u bytes.\n", pFilter->countKeys,
+           pFilter->countBlocks * FILTER_BLOCK);
+    printf("The filter answered %ld queries and rejected %ld of them.\n",
+           pFilter->countQueries, pFilter->countNegatives);
+    if (absent > 0)
+        printf("The false positive rate is %.2f%% (%ld of %ld absent codes).\n\n",
+               100.0 * pFilter->countFalse / absent, pFilter->countFalse, absent);
+    else
+        printf("The false positive rate is 0.00%%.\n\n");
+    return;
+}	// filterReport
+
+
+/*	================== filterDestroy =================
+ This function frees the filter.
+ Pre		pFilter - pointer to the filter (may be NULL)
+ Post		filter is freed
+ Return	NULL
+ */
+FILTER* filterDestroy (FILTER* pFilter)
+{
+	//	Statements
+    if (pFilter)
+    {
+        memFree(MEM_INDEX, pFilter->counters, pFilter->countBlocks * FILTER_BLOCK);
+        memFree(MEM_HEADER, pFilter, sizeof(FILTER));
+    }
+    return NULL;
+}	// filterDestroy
+
+
+/*	================== _filterKey =================
+ Mixes the packed code (CODE_KEY, so the letters after
+ the '\0' are ignored like in the table) into a block
+ number and FILTER_PROBES positions inside that block.
+ Pre		pFilter - pointer to the filter
+ pData - record holding the code
+ probes - receives the positions
+ Return	block number
+ */
+static unsigned _filterKey (FILTER* pFilter, DATA* pData, unsigned* probes)
+{
+	//	Local Declarations
+    unsigned hash;
+    int i;
+
+	//	Statements
+    hash = CODE_KEY(pData->arpCode);
+    hash ^= hash >> 16;
+    hash *= 0x7feb352du;
+    hash ^= hash >> 15;
+    hash *= 0x846ca68bu;
+    hash ^= hash >> 16;
+
+    // 24 low bits pick the probes, the rest (mixed again) the block
+    for (i = 0; i < FILTER_PROBES; i++)
+        probes[i] = (hash >> (6 * i)) & (FILTER_BLOCK - 1);
+    hash *= 0x9e3779b1u;
+    return (hash >> 8) & (pFilter->countBlocks - 1);
+}	// _filterKey
@@ -0,0 +1,446 @@
+/* frozen.c
+ This file contains the definitons of the functions to maintain
+ and search the frozen ordered index. The index is a copy of the
+ order of the tree, packed into arrays for fast reading:
+
+ keys    the codes (CODE_KEY) in Eytzinger order: the root of an
+         implicit balanced tree at 1, the children of k at 2k
+         and 2k + 1, so the top levels share a few cache lines
+ ranks   the position in key order of each of those codes
+ sorted  the records in key order
+
+ A search walks down keys without branches (the comparison
+ picks the child) and fetches the levels four steps ahead, so
+ it does not wait on a cache miss at each level like _retrieve
+ does on the nodes.
+
+ The adds and deletes of the menu keep sorted in step with the
+ tree: the record is put in or taken out at its rank by moving
+ the records after it one place (frozenAdd, frozenRemove), so
+ the next listing in key order does not walk the tree. The
+ codes are laid out again from sorted by the next search that
+ needs them; until then, frozenRetrieve goes to the tree. Any
+ other change of the tree has the index rebuilt from the tree
+ in O(n) when it is asked for.
+
+ Functions:
+ frozenBuild
+ frozenFresh
+ frozenRetrieve
+ frozenFind
+ frozenRank
+ frozenAdd
+ frozenRemove
+ frozenRange
+ frozenTraverse
+ frozenDestroy
+
+ Private Functions:
+ _place
+ _fill
+ _grow
+ _position
+ _lowerBound
+ */
+
+#include "header.h"
+
+#if defined(__GNUC__)
+#define FROZEN_PREFETCH(p)  __builtin_prefetch(p)
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <xmmintrin.h>
+#define FROZEN_PREFETCH(p)  _mm_prefetch((const char*) (p), _MM_HINT_T0)
+#else
+#define FROZEN_PREFETCH(p)
+#endif
+
+#define FROZEN_AHEAD  16    // 2^4: the keys four levels below k start at 16k
+#define FROZEN_MIN    16    // room the arrays grow to at least
+
+static void _place (FROZEN* pFrozen);
+static int _fill (FROZEN* pFrozen, int k, int rank);
+static void _grow (FROZEN* pFrozen);
+static int _position (FROZEN* pFrozen, unsigned key);
+static int _lowerBound (FROZEN* pFrozen, unsigned key);
+
+/*	================== frozenBuild =================
+ This function builds the index from the tree, or
+ rebuilds it if the tree changed since it was built.
+ Pre		pFrozen - index to rebuild, or NULL
+ tree - pointer to the tree
+ Post		index matches the tree
+ Return	pointer to the index
+ */
+FROZEN* frozenBuild (FROZEN* pFrozen, BST_TREE* tree)
+{
+	//	Local Declarations
+    NODE** stack;
+    NODE* pWalker;
+    int countStack = 0;
+    int count = 0;
+
+	//	Statements
+    if (frozenFresh(pFrozen, tree))
+        return pFrozen;
+    pFrozen = frozenDestroy(pFrozen);
+
+    if (!(pFrozen = (FROZEN*) memCalloc(MEM_HEADER, 1, sizeof(FROZEN))) ||
+        !(pFrozen->keys = (unsigned*) memAlloc(MEM_INDEX, (tree->count + 1) * sizeof(unsigned))) ||
+        !(pFrozen->ranks = (int*) memAlloc(MEM_INDEX, (tree->count + 1) * sizeof(int))) ||
+        !(pFrozen->sorted = (DATA**) memAlloc(MEM_INDEX, (tree->count + 1) * sizeof(DATA*))) ||
+        !(stack = (NODE**) malloc((tree->count + 1) * sizeof(NODE*)))) {
+        printf("Error allocating frozen index\n");
+        exit(190);
+    }
+
+    // in-order walk with a stack, the tree may be a long chain
+    pWalker = TREE_NODE(tree, tree->root);
+    while (pWalker || countStack > 0)
+    {
+        while (pWalker) {
+            stack[countStack++] = pWalker;
+            pWalker = TREE_NODE(tree, pWalker->left);
+        }
+        pWalker = stack[--countStack];
+        pFrozen->sorted[count++] = NODE_RECORD(pWalker);
+        pWalker = TREE_NODE(tree, pWalker->right);
+    }
+    free(stack);
+
+    pFrozen->count = count;
+    pFrozen->capacity = tree->count;
+    pFrozen->changes = tree->changes;
+    _place(pFrozen);
+    return pFrozen;
+}	// frozenBuild
+
+
+/*	================== frozenFresh =================
+ This function tells whether the index still matches
+ the tree.
+ Pre		pFrozen - pointer to the index (may be NULL)
+ tree - pointer to the tree
+ Post
+ Return	true if the tree has not changed since
+ the index was built
+ */
+bool frozenFresh (FROZEN* pFrozen, BST_TREE* tree)
+{
+	//	Statements
+    return pFrozen && pFrozen->changes == tree->changes && pFrozen->count == tree->count;
+}	// frozenFresh
+
+
+/*	================== frozenRetrieve =================
+ This function searches the records for a packed code,
+ in the index when it matches the tree and its codes
+ are laid out, otherwise in the tree.
+ Pre		pHeader - pointer to HEAD structure
+ key - CODE_KEY of the searched code
+ Post
+ Return	pointer to the record or NULL if not found
+ */
+DATA* frozenRetrieve (HEAD* pHeader, unsigned key)
+{
+	//	Statements
+    if (frozenFresh(pHeader->pFrozen, pHeader->pTree) && pHeader->pFrozen->placed)
+        return frozenFind(pHeader->pFrozen, key);
+    return (DATA*) retrieveCode(pHeader->pTree, key);
+}	// frozenRetrieve
+
+
+/*	================== frozenFind =================
+ This function searches the index for a packed code.
+ Pre		pFrozen - pointer to the index
+ key - CODE_KEY of the searched code
+ Post
+ Return	pointer to the record or NULL if not found
+ */
+DATA* frozenFind (FROZEN* pFrozen, unsigned key)
+{
+	//	Local Declarations
+    int k;
+    unsigned long long start = latencyStart();
+
+	//	Statements
+    if (!pFrozen->placed)
+        _place(pFrozen);
+    k = _lowerBound(pFrozen, key);
+    latencyRecord(LAT_TREE_SEARCH, start);
+    if (k != 0 && pFrozen->keys[k] == key)
+        return pFrozen->sorted[pFrozen->ranks[k]];
+    return NULL;
+}	// frozenFind
+
+
+/*	================== frozenRank =================
+ This function finds the position in key order of the
+ first code not less than a code.
+ Pre		pFrozen - pointer to the index
+ key - CODE_KEY of the code
+ Post
+ Return	rank of the first record whose code is not
+ less than key, count if there is none
+ */
+int frozenRank (FROZEN* pFrozen, unsigned key)
+{
+	//	Statements
+    if (!pFrozen->placed)
+        _place(pFrozen);
+    return pFrozen->ranks[_lowerBound(pFrozen, key)];
+}	// frozenRank
+
+
+/*	================== frozenAdd =================
+ This function puts a record just inserted into the
+ tree at its rank in the records in key order.
+ Pre		pFrozen - pointer to the index (may be NULL)
+ tree - pointer to the tree, after BST_Insert
+ pData - record inserted
+ Post		index matches the tree again if it matched
+ it before the insert
+ Return
+ */
+void frozenAdd (FROZEN* pFrozen, BST_TREE* tree, DATA* pData)
+{
+	//	Local Declarations
+    int rank;
+
+	//	Statements
+    if (!pFrozen || pFrozen->changes + 1 != tree->changes ||
+        pFrozen->count + 1 != tree->count)
+        return;
+    if (pFrozen->count == pFrozen->capacity)
+        _grow(pFrozen);
+    rank = _position(pFrozen, CODE_KEY(pData->arpCode));
+    memmove(pFrozen->sorted + rank + 1, pFrozen->sorted + rank,
+            (pFrozen->count - rank) * sizeof(DATA*));
+    pFrozen->sorted[rank] = pData;
+    pFrozen->count++;
+    pFrozen->changes = tree->changes;
+    pFrozen->placed = false;
+    return;
+}	// frozenAdd
+
+
+/*	================== frozenRemove =================
+ This function takes a record about to be deleted
+ from the tree out of the records in key order. It
+ is called before BST_Delete, which frees the record.
+ Pre		pFrozen - pointer to the index (may be NULL)
+ tree - pointer to the tree, before BST_Delete
+ pData - record stored in the tree
+ Post		index matches the tree after the delete if
+ it matched it before
+ Return
+ */
+void frozenRemove (FROZEN* pFrozen, BST_TREE* tree, DATA* pData)
+{
+	//	Local Declarations
+    int rank;
+
+	//	Statements
+    if (!frozenFresh(pFrozen, tree))
+        return;
+    rank = _position(pFrozen, CODE_KEY(pData->arpCode));
+    if (rank == pFrozen->count || pFrozen->sorted[rank] != pData)
+        return;
+    memmove(pFrozen->sorted + rank, pFrozen->sorted + rank + 1,
+            (pFrozen->count - rank - 1) * sizeof(DATA*));
+    pFrozen->count--;
+    pFrozen->changes = tree->changes + 1;
+    pFrozen->placed = false;
+    return;
+}	// frozenRemove
+
+
+/*	================== frozenRange =================
+ This function processes, in key order, every record
+ whose code is between two codes.
+ Pre		pFrozen - pointer to the index
+ low, high - CODE_KEY of the first and last codes
+ process - function called with each record
+ Post		records are processed
+ Return	number of records processed
+ */
+int frozenRange (FROZEN* pFrozen, unsigned low, unsigned high, void (*process) (void* dataPtr))
+{
+	//	Local Declarations
+    int rank;
+    int count = 0;
+
+	//	Statements
+    rank = frozenRank(pFrozen, low);
+    while (rank < pFrozen->count &&
+           CODE_KEY(pFrozen->sorted[rank]->arpCode) <= high)
+    {
+        process(pFrozen->sorted[rank++]);
+        count++;
+    }
+    return count;
+}	// frozenRange
+
+
+/*	================== frozenTraverse =================
+ This function processes every record in key order.
+ Pre		pFrozen - pointer to the index
+ process - function called with each record
+ Post		records are processed
+ Return
+ */
+void frozenTraverse (FROZEN* pFrozen, void (*process) (void* dataPtr))
+{
+	//	Local Declarations
+    int rank;
+
+	//	Statements
+    for (rank = 0; rank < pFrozen->count; rank++)
+        process(pFrozen->sorted[rank]);
+    return;
+}	// frozenTraverse
+
+
+/*	================== frozenDestroy =================
+ This function frees the index. The records are not
+ freed.
+ Pre		pFrozen - pointer to the index (may be NULL)
+ Post		index is freed
+ Return	NULL
+ */
+FROZEN* frozenDestroy (FROZEN* pFrozen)
+{
+	//	Statements
+    if (pFrozen)
+    {
+        memFree(MEM_INDEX, pFrozen->keys, (pFrozen->capacity + 1) * sizeof(unsigned));
+        memFree(MEM_INDEX, pFrozen->ranks, (pFrozen->capacity + 1) * sizeof(int));
+        memFree(MEM_INDEX, pFrozen->sorted, (pFrozen->capacity + 1) * sizeof(DATA*));
+        memFree(MEM_HEADER, pFrozen, sizeof(FROZEN));
+    }
+    return NULL;
+}	// frozenDestroy
+
+
+/*	================== _place =================
+ Lays out the codes of the sorted records in
+ Eytzinger order.
+ */
+static void _place (FROZEN* pFrozen)
+{
+	//	Statements
+    pFrozen->keys[0] = 0;
+    pFrozen->ranks[0] = pFrozen->count;
+    _fill(pFrozen, 1, 0);
+    pFrozen->placed = true;
+    return;
+}	// _place
+
+
+/*	================== _fill =================
+ Places the sorted records from rank on into the
+ subtree of k, in order: left subtree, k, right
+ subtree. Returns the next rank to place.
+ */
+static int _fill (FROZEN* pFrozen, int k, int rank)
+{
+	//	Statements
+    if (k <= pFrozen->count)
+    {
+        rank = _fill(pFrozen, 2 * k, rank);
+        pFrozen->keys[k] = CODE_KEY(pFrozen->sorted[rank]->arpCode);
+        pFrozen->ranks[k] = rank++;
+        rank = _fill(pFrozen, 2 * k + 1, rank);
+    }
+    return rank;
+}	// _fill
+
+
+/*	================== _grow =================
+ Doubles the room of the arrays. Only the sorted
+ records are copied, the codes are laid out again
+ before the next search.
+ */
+static void _grow (FROZEN* pFrozen)
+{
+	//	Local Declarations
+    int capacity = pFrozen->capacity * 2 > FROZEN_MIN ? pFrozen->capacity * 2 : FROZEN_MIN;
+    unsigned* keys;
+    int* ranks;
+    DATA** sorted;
+
+	//	Statements
+    if (!(keys = (unsigned*) memAlloc(MEM_INDEX, (capacity + 1) * sizeof(unsigned))) ||
+        !(ranks = (int*) memAlloc(MEM_INDEX, (capacity + 1) * sizeof(int))) ||
+        !(sorted = (DATA**) memAlloc(MEM_INDEX, (capacity + 1) * sizeof(DATA*)))) {
+        printf("Error allocating frozen index\n");
+        exit(190);
+    }
+    memcpy(sorted, pFrozen->sorted, pFrozen->count * sizeof(DATA*));
+    memFree(MEM_INDEX, pFrozen->keys, (pFrozen->capacity + 1) * sizeof(unsigned));
+    memFree(MEM_INDEX, pFrozen->ranks, (pFrozen->capacity + 1) * sizeof(int));
+    memFree(MEM_INDEX, pFrozen->sorted, (pFrozen->capacity + 1) * sizeof(DATA*));
+    pFrozen->keys = keys;
+    pFrozen->ranks = ranks;
+    pFrozen->sorted = sorted;
+    pFrozen->capacity = capacity;
+    pFrozen->placed = false;
+    return;
+}	// _grow
+
+
+/*	================== _position =================
+ Binary search of the sorted records, which works
+ while the codes are not laid out. Returns the rank
+ of the first record whose code is not less than
+ key, count if there is none.
+ */
+static int _position (FROZEN* pFrozen, unsigned key)
+{
+	//	Local Declarations
+    int low = 0;
+    int high = pFrozen->count;
+    int middle;
+
+	//	Statements
+    while (low < high)
+    {
+        middle = low + (high - low) / 2;
+        if (CODE_KEY(pFrozen->sorted[middle]->arpCode) < key)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}	// _position
+
+
+/*	================== _lowerBound =================
+ Finds the first key not less than key. Going down,
+ each comparison adds 0 (left) or 1 (right) to the
+ path; at the end the last left turn is undone by
+ dropping the trailing right turns and one more bit.
+ Returns its index in keys, 0 if every key is less
+ (ranks[0] is count).
+ */
+static int _lowerBound (FROZEN* pFrozen, unsigned key)
+{
+	//	Local Declarations
+    const unsigned* keys = pFrozen->keys;
+    unsigned k = 1;
+    unsigned n = (unsigned) pFrozen->count;
+
+	//	Statements
+    while (k <= n)
+    {
+        FROZEN_PREFETCH(keys + FROZEN_AHEAD * k);
+        k = 2 * k + (keys[k] < key);
+    }
+#ifdef __GNUC__
+    k >>= __builtin_ctz(~k) + 1;
+#else
+    while (k & 1)
+        k >>= 1;
+    k >>= 1;
+#endif
+    return (int) k;
+}	// _lowerBound
@@ -0,0 +1,79 @@
+/* generic.c
+ This file contains the functions the containers generated by
+ generic.h share whatever their types: running the passes of a
+ resize on several threads.
+
+ Functions:
+ genericThreads
+ genericRunWorkers
+
+ */
+
+#include "header.h"
+#ifndef _MSC_VER
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/*	================== genericThreads =================
+ Picks the number of workers for a resize: one for
+ small tables, otherwise one per processor.
+ Pre		size - slots of the table about to be resized
+ Return	number of workers
+ */
+int genericThreads (int size)
+{
+	//	Local Declarations
+    int countThreads = 1;
+
+	//	Statements
+#ifndef _MSC_VER
+    if (size >= REHASH_PARALLEL_SIZE)
+        countThreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+#else
+    (void) size;
+#endif
+    if (countThreads < 1)
+        countThreads = 1;
+    if (countThreads > REHASH_MAX_THREADS)
+        countThreads = REHASH_MAX_THREADS;
+    return countThreads;
+}	// genericThreads
+
+
+/*	================== genericRunWorkers =================
+ Runs one pass of a resize on every worker and waits
+ for all of them. A single worker runs on the caller's
+ thread, and so does a worker whose thread could not
+ be started.
+ Pre		pass - function run by each worker
+ work - array of countThreads entries of workSize
+ bytes, one per worker
+ Post	    pass has finished on every worker
+ */
+void genericRunWorkers (void* (*pass) (void* pWork), void* work, size_t workSize, int countThreads)
+{
+	//	Local Declarations
+	char* pWork = (char*) work;
+	int t;
+#ifndef _MSC_VER
+    pthread_t threads[REHASH_MAX_THREADS];
+    bool started[REHASH_MAX_THREADS];
+
+	//	Statements
+    for (t = 1; t < countThreads; t++) {
+        started[t] = pthread_create(&threads[t], NULL, pass, pWork + t * workSize) == 0;
+        if (!started[t])
+            pass(pWork + t * workSize);
+    }
+    pass(pWork);
+    for (t = 1; t < countThreads; t++)
+        if (started[t])
+            pthread_join(threads[t], NULL);
+#else
+	//	Statements
+    for (t = 0; t < countThreads; t++)
+        pass(pWork + t * workSize);
+#endif
+    return;
+}	// genericRunWorkers
@@ -0,0 +1,779 @@
+/*	generic.h
+ Macros that generate a chained hash table and a binary search
+ tree for any key and value types. Everything that depends on
+ the types (hashing, comparing, linking a value, allocating) is
+ given by a policy, a set of macros sharing a prefix P, and is
+ expanded in place: nothing is called through a pointer.
+ header.h declares the airport instantiation, airport.c defines
+ it, and hash.c and bstADT.c wrap it.
+
+ The policy P:
+ P##_KEY_T              key type, compared as a value
+ P##_VALUE_T            type of the stored values
+ P##_LINK_T             link to a value (pointer or pool position)
+ P##_KEY(pValue)        key of a value
+ P##_INDEX(key, size)   slot of a key in a table of size slots
+ P##_EQUAL(a, b)        true if both keys are the same
+ P##_LESS(a, b)         true if key a sorts before key b
+ P##_LINK_OF(pValue)    link to a value
+ P##_VALUE(link)        value of a link
+ P##_NODE_OF(pValue)    link to the tree node a value holds
+ P##_NODE(tree, link)   tree node of a link
+ P##_NODE_VALUE(pNode)  value holding a tree node
+ The allocator hooks:
+ P##_ALLOC(part, size)          block of the given part (SLOT,
+ P##_CALLOC(part, count, size)  HEADER), NULL if out of memory
+ P##_FREE(part, pBlock, size)   frees a block, ignores NULL
+ P##_POOL(objSize)              pool the collision nodes come from
+ P##_RELEASE(pValue)            frees a value taken out of a tree
+
+ The links are those of header.h (LINK_TYPE, LINK_AT, LINK_NONE,
+ LINK_ALLOC, LINK_FREE), so with COMPACT_LINKS the containers
+ link their nodes by 32-bit pool positions too.
+
+ DEFINE_HASH_TYPES(P, HASH_T, SLOT_T, CHAIN_T, LINK_T, hashTag,
+ chainTag, EXTRA) declares
+ LINK_T    link to a collision node
+ CHAIN_T   collision node: key, pData, next
+ SLOT_T    table slot: countCollision, key, pData, pCollision
+ HASH_T    table: arraySize, countUsed, pTable, pChains, then the
+           EXTRA fields (zero in a new table, kept by a resize)
+ The key is kept next to every link, so searches and resizes
+ never read a value until one is found.
+
+ DECLARE_HASH and DEFINE_HASH(P, name, HASH_T, SLOT_T, CHAIN_T,
+ LINK_T) declare and define
+ HASH_T* nameCreate (int size)
+ bool    nameInsert (HASH_T* pHash, value* pValue)
+ value*  nameFind (HASH_T* pHash, key)
+ bool    nameRemove (HASH_T* pHash, value* pValue)
+ bool    nameResize (HASH_T* pHash, int newSize)
+ int     nameValues (HASH_T* pHash, value** values)
+ void    nameDestroy (HASH_T* pHash)
+ A value goes to its slot, or to the front of the slot's
+ collision list. A found value moves to the front of its list.
+ A resize keeps the header, reuses the collision nodes and gives
+ the same table as inserting the values one by one in table
+ order; large tables are resized by several threads (see
+ genericRunWorkers in generic.c). Create, Insert and Resize
+ return NULL or false when out of memory, leaving the table as
+ it was.
+
+ DEFINE_TREE_TYPES(P, TREE_T, NODE_T, LINK_T, nodeTag) declares
+ LINK_T    link to a tree node
+ NODE_T    tree node, held by its value: key, left, right
+ TREE_T    tree: count, root, changes (insertions and deletions)
+
+ DECLARE_TREE and DEFINE_TREE(P, name, TREE_T, NODE_T, LINK_T)
+ declare and define
+ TREE_T* nameCreate (void)
+ bool    nameInsert (TREE_T* tree, value* pValue)
+ bool    nameBuild (TREE_T* tree, value** values, int count)
+ bool    nameRemove (TREE_T* tree, key)
+ value*  nameFind (TREE_T* tree, key)
+ void    nameTraverse (TREE_T* tree, void (*process) (void* pValue))
+ TREE_T* nameDestroy (TREE_T* tree)
+ Equal keys go to the right. Build links values already in key
+ order into a balanced tree. Remove replaces a node with two
+ children by the largest node of its left subtree, and Remove
+ and Destroy give each value taken out to P##_RELEASE.
+ */
+
+#define REHASH_PARALLEL_SIZE  65536   // smaller tables resize on one thread
+#define REHASH_MAX_THREADS    16
+
+//	Hash table types
+#define DEFINE_HASH_TYPES(P, HASH_T, SLOT_T, CHAIN_T, LINK_T, hashTag, chainTag, EXTRA) \
+typedef LINK_TYPE(chainTag) LINK_T;                                             \
+                                                                                \
+typedef struct chainTag{                                                        \
+    P##_KEY_T   key;                                                            \
+    P##_LINK_T  pData;                                                          \
+    LINK_T      next;                                                           \
+}CHAIN_T;                                                                       \
+                                                                                \
+typedef struct{                                                                 \
+    int         countCollision;                                                 \
+    P##_KEY_T   key;                                                            \
+    P##_LINK_T  pData;                                                          \
+    LINK_T      pCollision;                                                     \
+}SLOT_T;                                                                        \
+                                                                                \
+typedef struct hashTag{                                                         \
+    int         arraySize;                                                      \
+    int         countUsed;                                                      \
+    SLOT_T*     pTable;                                                         \
+    POOL*       pChains;                                                        \
+    EXTRA                                                                       \
+}HASH_T;
+
+//	Hash table prototypes
+#define DECLARE_HASH(P, name, HASH_T)                                          \
+HASH_T* name##Create (int size);                                                \
+bool name##Insert (HASH_T* pHash, P##_VALUE_T* pValue);                         \
+P##_VALUE_T* name##Find (HASH_T* pHash, P##_KEY_T key);                         \
+bool name##Remove (HASH_T* pHash, P##_VALUE_T* pValue);                         \
+bool name##Resize (HASH_T* pHash, int newSize);                                 \
+int name##Values (HASH_T* pHash, P##_VALUE_T** values);                         \
+void name##Destroy (HASH_T* pHash);
+
+//	Hash table functions
+#define DEFINE_HASH(P, name, HASH_T, SLOT_T, CHAIN_T, LINK_T)                  \
+                                                                                \
+/* shared state of one resize */                                                \
+typedef struct{                                                                 \
+    SLOT_T*       pOld;                                                         \
+    int           oldSize;                                                      \
+    SLOT_T*       pNew;                                                         \
+    int           newSize;                                                      \
+    POOL*         pChains;                                                      \
+    int           countThreads;                                                 \
+    P##_VALUE_T** values;       /* values in old table order */                 \
+    P##_KEY_T*    keys;         /* their keys, taken from the old slots */      \
+    int*          indexes;      /* new index of each value */                   \
+    P##_VALUE_T** runValues;    /* values grouped by run */                     \
+    P##_KEY_T*    runKeys;                                                      \
+    int*          runIndexes;                                                   \
+    LINK_T*       nodes;        /* collision nodes to reuse */                  \
+}name##_SHARED;                                                                 \
+                                                                                \
+/* part of a resize done by one worker */                                       \
+typedef struct{                                                                 \
+    name##_SHARED* pShared;                                                     \
+    int  first;                 /* range of old slots */                        \
+    int  last;                                                                  \
+    int  countValues;                                                           \
+    int  countNodes;                                                            \
+    int  valueOffset;                                                           \
+    int  nodeOffset;                                                            \
+    int  sendCount[REHASH_MAX_THREADS];                                         \
+    int  cursor[REHASH_MAX_THREADS];                                            \
+    int  runStart;              /* range of the worker's run */                 \
+    int  runEnd;                                                                \
+    int  countUsed;                                                             \
+    int  needNodes;                                                             \
+    int  nodeStart;                                                             \
+}name##_WORK;                                                                   \
+                                                                                \
+/* run (worker) owning a slot of the new table: each run owns */                \
+/* a contiguous range of slots */                                               \
+static int _##name##Run (name##_SHARED* pS, int index)                          \
+{                                                                               \
+    return (int) ((long long) index * pS->countThreads / pS->newSize);          \
+}                                                                               \
+                                                                                \
+/* pass 1: counts the values and the collision nodes in the */                  \
+/* worker's range of old slots */                                               \
+static void* _##name##Count (void* pWork)                                       \
+{                                                                               \
+    name##_WORK* pW = (name##_WORK*) pWork;                                     \
+    SLOT_T* pTable = pW->pShared->pOld;                                         \
+    int i;                                                                      \
+                                                                                \
+    pW->countValues = 0;                                                        \
+    pW->countNodes = 0;                                                         \
+    for (i = pW->first; i < pW->last; i++) {                                    \
+        if (pTable[i].pData != LINK_NONE) {                                     \
+            pW->countValues += 1 + pTable[i].countCollision;                    \
+            pW->countNodes += pTable[i].countCollision;                         \
+        }                                                                       \
+    }                                                                           \
+    return NULL;                                                                \
+}                                                                               \
+                                                                                \
+/* pass 2: lists the worker's values in table order with their */               \
+/* new index, collects the old collision nodes and counts how */                \
+/* many values go to each run */                                                \
+static void* _##name##Gather (void* pWork)                                      \
+{                                                                               \
+    name##_WORK* pW = (name##_WORK*) pWork;                                     \
+    name##_SHARED* pS = pW->pShared;                                            \
+    SLOT_T* pTable = pS->pOld;                                                  \
+    CHAIN_T* pNode;                                                             \
+    LINK_T walker;                                                              \
+    int value = pW->valueOffset;                                                \
+    int node = pW->nodeOffset;                                                  \
+    int i;                                                                      \
+                                                                                \
+    memset(pW->sendCount, 0, sizeof(pW->sendCount));                            \
+    for (i = pW->first; i < pW->last; i++) {                                    \
+        if (pTable[i].pData != LINK_NONE) {                                     \
+            pS->keys[value] = pTable[i].key;                                    \
+            pS->values[value++] = P##_VALUE(pTable[i].pData);                   \
+            for (walker = pTable[i].pCollision; walker != LINK_NONE;            \
+                 walker = pNode->next) {                                        \
+                pNode = LINK_AT(CHAIN_T, pS->pChains, walker);                  \
+                pS->keys[value] = pNode->key;                                   \
+                pS->values[value++] = P##_VALUE(pNode->pData);                  \
+                pS->nodes[node++] = walker;                                     \
+            }                                                                   \
+        }                                                                       \
+    }                                                                           \
+    for (i = pW->valueOffset; i < value; i++) {                                 \
+        pS->indexes[i] = P##_INDEX(pS->keys[i], pS->newSize);                   \
+        pW->sendCount[_##name##Run(pS, pS->indexes[i])]++;                      \
+    }                                                                           \
+    return NULL;                                                                \
+}                                                                               \
+                                                                                \
+/* pass 3: copies the worker's values into the runs, keeping */                 \
+/* their order */                                                               \
+static void* _##name##Scatter (void* pWork)                                     \
+{                                                                               \
+    name##_WORK* pW = (name##_WORK*) pWork;                                     \
+    name##_SHARED* pS = pW->pShared;                                            \
+    int i;                                                                      \
+    int to;                                                                     \
+                                                                                \
+    for (i = pW->valueOffset; i < pW->valueOffset + pW->countValues; i++) {     \
+        to = pW->cursor[_##name##Run(pS, pS->indexes[i])]++;                    \
+        pS->runValues[to] = pS->values[i];                                      \
+        pS->runKeys[to] = pS->keys[i];                                          \
+        pS->runIndexes[to] = pS->indexes[i];                                    \
+    }                                                                           \
+    return NULL;                                                                \
+}                                                                               \
+                                                                                \
+/* pass 4a: the first value of each slot takes the slot; the */                 \
+/* others are counted as needing a collision node */                            \
+static void* _##name##Claim (void* pWork)                                       \
+{                                                                               \
+    name##_WORK* pW = (name##_WORK*) pWork;                                     \
+    name##_SHARED* pS = pW->pShared;                                            \
+    SLOT_T* pSlot;                                                              \
+    int i;                                                                      \
+                                                                                \
+    pW->countUsed = 0;                                                          \
+    pW->needNodes = 0;                                                          \
+    for (i = pW->runStart; i < pW->runEnd; i++) {                               \
+        pSlot = &pS->pNew[pS->runIndexes[i]];                                   \
+        if (pSlot->pData == LINK_NONE) {                                        \
+            pSlot->pData = P##_LINK_OF(pS->runValues[i]);                       \
+            pSlot->key = pS->runKeys[i];                                        \
+            pW->countUsed++;                                                    \
+        }                                                                       \
+        else pW->needNodes++;                                                   \
+    }                                                                           \
+    return NULL;                                                                \
+}                                                                               \
+                                                                                \
+/* pass 4b: pushes every value that did not take a slot onto */                 \
+/* the front of that slot's collision list */                                   \
+static void* _##name##Link (void* pWork)                                        \
+{                                                                               \
+    name##_WORK* pW = (name##_WORK*) pWork;                                     \
+    name##_SHARED* pS = pW->pShared;                                            \
+    SLOT_T* pSlot;                                                              \
+    CHAIN_T* pNode;                                                             \
+    LINK_T link;                                                                \
+    int node = pW->nodeStart;                                                   \
+    int i;                                                                      \
+                                                                                \
+    for (i = pW->runStart; i < pW->runEnd; i++) {                               \
+        pSlot = &pS->pNew[pS->runIndexes[i]];                                   \
+        if (pSlot->pData != P##_LINK_OF(pS->runValues[i])) {                    \
+            link = pS->nodes[node++];                                           \
+            pNode = LINK_AT(CHAIN_T, pS->pChains, link);                        \
+            pNode->pData = P##_LINK_OF(pS->runValues[i]);                       \
+            pNode->key = pS->runKeys[i];                                        \
+            pNode->next = pSlot->pCollision;                                    \
+            pSlot->pCollision = link;                                           \
+            pSlot->countCollision++;                                            \
+        }                                                                       \
+    }                                                                           \
+    return NULL;                                                                \
+}                                                                               \
+                                                                                \
+/* empty table of size slots */                                                 \
+static SLOT_T* _##name##Table (int size)                                        \
+{                                                                               \
+    SLOT_T* pTable;                                                             \
+    int i;                                                                      \
+                                                                                \
+    if (!(pTable = (SLOT_T*) P##_CALLOC(SLOT, size, sizeof(SLOT_T))))           \
+        return NULL;                                                            \
+    for (i = 0; i < size; i++) {                                                \
+        pTable[i].countCollision = 0;                                           \
+        pTable[i].pCollision = LINK_NONE;                                       \
+        pTable[i].pData = LINK_NONE;                                            \
+    }                                                                           \
+    return pTable;                                                              \
+}                                                                               \
+                                                                                \
+HASH_T* name##Create (int size)                                                 \
+{                                                                               \
+    HASH_T* pHash;                                                              \
+                                                                                \
+    if (!(pHash = (HASH_T*) P##_CALLOC(HEADER, 1, sizeof(HASH_T))))             \
+        return NULL;                                                            \
+    pHash->pChains = P##_POOL(sizeof(CHAIN_T));                                 \
+    if (!pHash->pChains || !(pHash->pTable = _##name##Table(size))) {           \
+        poolDestroy(pHash->pChains);                                            \
+        P##_FREE(HEADER, pHash, sizeof(HASH_T));                                \
+        return NULL;                                                            \
+    }                                                                           \
+    pHash->arraySize = size;                                                    \
+    pHash->countUsed = 0;                                                       \
+    return pHash;                                                               \
+}                                                                               \
+                                                                                \
+bool name##Insert (HASH_T* pHash, P##_VALUE_T* pValue)                          \
+{                                                                               \
+    SLOT_T* pSlot;                                                              \
+    CHAIN_T* pNode;                                                             \
+    LINK_T link;                                                                \
+    P##_KEY_T key = P##_KEY(pValue);                                            \
+                                                                                \
+    pSlot = &pHash->pTable[P##_INDEX(key, pHash->arraySize)];                   \
+    if (pSlot->pData == LINK_NONE) {                                            \
+        pSlot->pData = P##_LINK_OF(pValue);                                     \
+        pSlot->key = key;                                                       \
+        pHash->countUsed++;                                                     \
+        return true;                                                            \
+    }                                                                           \
+    if ((link = LINK_ALLOC(pHash->pChains)) == LINK_NONE)                       \
+        return false;                                                           \
+    pNode = LINK_AT(CHAIN_T, pHash->pChains, link);                             \
+    pNode->key = key;                                                           \
+    pNode->pData = P##_LINK_OF(pValue);                                         \
+    pNode->next = pSlot->pCollision;                                            \
+    pSlot->pCollision = link;                                                   \
+    pSlot->countCollision++;                                                    \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+P##_VALUE_T* name##Find (HASH_T* pHash, P##_KEY_T key)                          \
+{                                                                               \
+    SLOT_T* pSlot;                                                              \
+    CHAIN_T* pFirst;                                                            \
+    CHAIN_T* pWalker;                                                           \
+    P##_LINK_T swap;                                                            \
+    P##_KEY_T swapKey;                                                          \
+                                                                                \
+    pSlot = &pHash->pTable[P##_INDEX(key, pHash->arraySize)];                   \
+    if (pSlot->pData == LINK_NONE)                                              \
+        return NULL;                                                            \
+    if (P##_EQUAL(pSlot->key, key))                                             \
+        return P##_VALUE(pSlot->pData);                                         \
+                                                                                \
+    pFirst = LINK_AT(CHAIN_T, pHash->pChains, pSlot->pCollision);               \
+    for (pWalker = pFirst; pWalker != NULL;                                     \
+         pWalker = LINK_AT(CHAIN_T, pHash->pChains, pWalker->next))             \
+    {                                                                           \
+        if (P##_EQUAL(pWalker->key, key)) {                                     \
+            swap = pFirst->pData;                                               \
+            swapKey = pFirst->key;                                              \
+            pFirst->pData = pWalker->pData;                                     \
+            pFirst->key = pWalker->key;                                         \
+            pWalker->pData = swap;                                              \
+            pWalker->key = swapKey;                                             \
+            return P##_VALUE(pFirst->pData);                                    \
+        }                                                                       \
+    }                                                                           \
+    return NULL;                                                                \
+}                                                                               \
+                                                                                \
+bool name##Remove (HASH_T* pHash, P##_VALUE_T* pValue)                          \
+{                                                                               \
+    SLOT_T* pSlot;                                                              \
+    CHAIN_T* pNode;                                                             \
+    P##_LINK_T link = P##_LINK_OF(pValue);                                      \
+    LINK_T pPre = LINK_NONE;                                                    \
+    LINK_T pCur;                                                                \
+                                                                                \
+    pSlot = &pHash->pTable[P##_INDEX(P##_KEY(pValue), pHash->arraySize)];       \
+    if (pSlot->pData == link)                                                   \
+    {                                                                           \
+        /* the first collision node moves into the slot */                      \
+        if ((pCur = pSlot->pCollision) != LINK_NONE)                            \
+        {                                                                       \
+            pNode = LINK_AT(CHAIN_T, pHash->pChains, pCur);                     \
+            pSlot->pData = pNode->pData;                                        \
+            pSlot->key = pNode->key;                                            \
+            pSlot->pCollision = pNode->next;                                    \
+            pSlot->countCollision--;                                            \
+            LINK_FREE(pHash->pChains, pCur);                                    \
+        }                                                                       \
+        else{                                                                   \
+            pSlot->pData = LINK_NONE;                                           \
+            pHash->countUsed--;                                                 \
+        }                                                                       \
+        return true;                                                            \
+    }                                                                           \
+                                                                                \
+    for (pCur = pSlot->pCollision; pCur != LINK_NONE; pCur = pNode->next) {     \
+        pNode = LINK_AT(CHAIN_T, pHash->pChains, pCur);                         \
+        if (pNode->pData == link)                                               \
+            break;                                                              \
+        pPre = pCur;                                                            \
+    }                                                                           \
+    if (pCur == LINK_NONE)                                                      \
+        return false;                                                           \
+    if (pPre == LINK_NONE)                                                      \
+        pSlot->pCollision = pNode->next;                                        \
+    else                                                                        \
+        LINK_AT(CHAIN_T, pHash->pChains, pPre)->next = pNode->next;             \
+    pSlot->countCollision--;                                                    \
+    LINK_FREE(pHash->pChains, pCur);                                            \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+bool name##Resize (HASH_T* pHash, int newSize)                                  \
+{                                                                               \
+    name##_WORK work[REHASH_MAX_THREADS];                                       \
+    name##_SHARED shared;                                                       \
+    int countThreads;                                                           \
+    int countValues = 0;                                                        \
+    int countNodes = 0;                                                         \
+    int needNodes = 0;                                                          \
+    int offset;                                                                 \
+    int t;                                                                      \
+    int p;                                                                      \
+                                                                                \
+    countThreads = genericThreads(pHash->arraySize);                            \
+    for (t = 0; t < countThreads; t++) {                                        \
+        work[t].pShared = &shared;                                              \
+        work[t].first = (int) ((long long) pHash->arraySize * t / countThreads); \
+        work[t].last = (int) ((long long) pHash->arraySize * (t + 1) / countThreads); \
+    }                                                                           \
+    shared.pOld = pHash->pTable;                                                \
+    shared.oldSize = pHash->arraySize;                                          \
+    shared.newSize = newSize;                                                   \
+    shared.pChains = pHash->pChains;                                            \
+    shared.countThreads = countThreads;                                         \
+                                                                                \
+    genericRunWorkers(_##name##Count, work, sizeof(name##_WORK), countThreads); \
+    for (t = 0; t < countThreads; t++) {                                        \
+        work[t].valueOffset = countValues;                                      \
+        work[t].nodeOffset = countNodes;                                        \
+        countValues += work[t].countValues;                                     \
+        countNodes += work[t].countNodes;                                       \
+    }                                                                           \
+                                                                                \
+    shared.pNew = _##name##Table(newSize);                                      \
+    shared.values = (P##_VALUE_T**) P##_ALLOC(SLOT, (countValues + 1) * sizeof(P##_VALUE_T*)); \
+    shared.keys = (P##_KEY_T*) P##_ALLOC(SLOT, (countValues + 1) * sizeof(P##_KEY_T)); \
+    shared.indexes = (int*) P##_ALLOC(SLOT, (countValues + 1) * sizeof(int));  \
+    shared.runValues = (P##_VALUE_T**) P##_ALLOC(SLOT, (countValues + 1) * sizeof(P##_VALUE_T*)); \
+    shared.runKeys = (P##_KEY_T*) P##_ALLOC(SLOT, (countValues + 1) * sizeof(P##_KEY_T)); \
+    shared.runIndexes = (int*) P##_ALLOC(SLOT, (countValues + 1) * sizeof(int)); \
+    shared.nodes = (LINK_T*) P##_ALLOC(SLOT, (countValues + 1) * sizeof(LINK_T)); \
+    if (shared.pNew && shared.values && shared.keys && shared.indexes &&        \
+        shared.runValues && shared.runKeys && shared.runIndexes && shared.nodes) \
+    {                                                                           \
+        genericRunWorkers(_##name##Gather, work, sizeof(name##_WORK), countThreads); \
+                                                                                \
+        /* run p collects, in worker order, what every worker sent to it */     \
+        offset = 0;                                                             \
+        for (p = 0; p < countThreads; p++) {                                    \
+            work[p].runStart = offset;                                          \
+            for (t = 0; t < countThreads; t++) {                                \
+                work[t].cursor[p] = offset;                                     \
+                offset += work[t].sendCount[p];                                 \
+            }                                                                   \
+            work[p].runEnd = offset;                                            \
+        }                                                                       \
+                                                                                \
+        genericRunWorkers(_##name##Scatter, work, sizeof(name##_WORK), countThreads); \
+        genericRunWorkers(_##name##Claim, work, sizeof(name##_WORK), countThreads); \
+                                                                                \
+        /* hand out the old collision nodes, taking more if needed */           \
+        for (t = 0; t < countThreads; t++) {                                    \
+            work[t].nodeStart = needNodes;                                      \
+            needNodes += work[t].needNodes;                                     \
+        }                                                                       \
+        for (p = countNodes; p < needNodes; p++)                                \
+            shared.nodes[p] = LINK_ALLOC(pHash->pChains);                       \
+        for (p = needNodes; p < countNodes; p++)                                \
+            LINK_FREE(pHash->pChains, shared.nodes[p]);                         \
+                                                                                \
+        genericRunWorkers(_##name##Link, work, sizeof(name##_WORK), countThreads); \
+        P##_FREE(SLOT, pHash->pTable, pHash->arraySize * sizeof(SLOT_T));       \
+        pHash->pTable = shared.pNew;                                            \
+        pHash->arraySize = newSize;                                             \
+        pHash->countUsed = 0;                                                   \
+        for (t = 0; t < countThreads; t++)                                      \
+            pHash->countUsed += work[t].countUsed;                              \
+        shared.pNew = NULL;                                                     \
+    }                                                                           \
+                                                                                \
+    P##_FREE(SLOT, shared.values, (countValues + 1) * sizeof(P##_VALUE_T*));    \
+    P##_FREE(SLOT, shared.keys, (countValues + 1) * sizeof(P##_KEY_T));         \
+    P##_FREE(SLOT, shared.indexes, (countValues + 1) * sizeof(int));            \
+    P##_FREE(SLOT, shared.runValues, (countValues + 1) * sizeof(P##_VALUE_T*)); \
+    P##_FREE(SLOT, shared.runKeys, (countValues + 1) * sizeof(P##_KEY_T));      \
+    P##_FREE(SLOT, shared.runIndexes, (countValues + 1) * sizeof(int));         \
+    P##_FREE(SLOT, shared.nodes, (countValues + 1) * sizeof(LINK_T));           \
+    if (shared.pNew) {                                                          \
+        P##_FREE(SLOT, shared.pNew, newSize * sizeof(SLOT_T));                  \
+        return false;                                                           \
+    }                                                                           \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+int name##Values (HASH_T* pHash, P##_VALUE_T** values)                          \
+{                                                                               \
+    SLOT_T* pSlot;                                                              \
+    LINK_T walker;                                                              \
+    int count = 0;                                                              \
+    int i;                                                                      \
+                                                                                \
+    for (i = 0; i < pHash->arraySize; i++) {                                    \
+        pSlot = &pHash->pTable[i];                                              \
+        if (pSlot->pData == LINK_NONE)                                          \
+            continue;                                                           \
+        if (!values)                                                            \
+            count += 1 + pSlot->countCollision;                                 \
+        else {                                                                  \
+            values[count++] = P##_VALUE(pSlot->pData);                          \
+            for (walker = pSlot->pCollision; walker != LINK_NONE;               \
+                 walker = LINK_AT(CHAIN_T, pHash->pChains, walker)->next)       \
+                values[count++] = P##_VALUE(LINK_AT(CHAIN_T, pHash->pChains, walker)->pData); \
+        }                                                                       \
+    }                                                                           \
+    return count;                                                               \
+}                                                                               \
+                                                                                \
+void name##Destroy (HASH_T* pHash)                                              \
+{                                                                               \
+    if (pHash) {                                                                \
+        poolDestroy(pHash->pChains);                                            \
+        P##_FREE(SLOT, pHash->pTable, pHash->arraySize * sizeof(SLOT_T));       \
+        P##_FREE(HEADER, pHash, sizeof(HASH_T));                                \
+    }                                                                           \
+}
+
+//	Tree types
+#define DEFINE_TREE_TYPES(P, TREE_T, NODE_T, LINK_T, nodeTag)                  \
+typedef LINK_TYPE(nodeTag) LINK_T;                                              \
+                                                                                \
+typedef struct nodeTag{                                                         \
+    P##_KEY_T   key;                                                            \
+    LINK_T      left;                                                           \
+    LINK_T      right;                                                          \
+}NODE_T;                                                                        \
+                                                                                \
+typedef struct{                                                                 \
+    int         count;                                                          \
+    LINK_T      root;                                                           \
+    int         changes;                                                        \
+}TREE_T;
+
+//	Tree prototypes
+#define DECLARE_TREE(P, name, TREE_T)                                          \
+TREE_T* name##Create (void);                                                    \
+bool name##Insert (TREE_T* tree, P##_VALUE_T* pValue);                          \
+bool name##Build (TREE_T* tree, P##_VALUE_T** values, int count);               \
+bool name##Remove (TREE_T* tree, P##_KEY_T key);                                \
+P##_VALUE_T* name##Find (TREE_T* tree, P##_KEY_T key);                          \
+void name##Traverse (TREE_T* tree, void (*process) (void* pValue));             \
+TREE_T* name##Destroy (TREE_T* tree);
+
+//	Tree functions
+#define DEFINE_TREE(P, name, TREE_T, NODE_T, LINK_T)                           \
+                                                                                \
+/* links values[low..high] into a balanced subtree, the middle */               \
+/* value at its root */                                                         \
+static LINK_T _##name##Build (TREE_T* tree, P##_VALUE_T** values,               \
+                              int low, int high, int* built)                    \
+{                                                                               \
+    LINK_T newPtr;                                                              \
+    LINK_T subPtr;                                                              \
+    int middle;                                                                 \
+                                                                                \
+    if (low > high)                                                             \
+        return LINK_NONE;                                                       \
+    middle = low + (high - low) / 2;                                            \
+    newPtr = P##_NODE_OF(values[middle]);                                       \
+    P##_NODE(tree, newPtr)->key = P##_KEY(values[middle]);                      \
+    subPtr = _##name##Build(tree, values, low, middle - 1, built);              \
+    P##_NODE(tree, newPtr)->left = subPtr;                                      \
+    subPtr = _##name##Build(tree, values, middle + 1, high, built);             \
+    P##_NODE(tree, newPtr)->right = subPtr;                                     \
+    (*built)++;                                                                 \
+    return newPtr;                                                              \
+}                                                                               \
+                                                                                \
+/* removes the node of key from a subtree, giving its value to */               \
+/* P##_RELEASE; returns the new root of the subtree */                          \
+static LINK_T _##name##Remove (TREE_T* tree, LINK_T root, P##_KEY_T key,        \
+                               bool* success)                                   \
+{                                                                               \
+    NODE_T* pRoot;                                                              \
+    LINK_T exchPtr;                                                             \
+    LINK_T exchPre;                                                             \
+    LINK_T newRoot;                                                             \
+                                                                                \
+    if (!root) {                                                                \
+        *success = false;                                                       \
+        return LINK_NONE;                                                       \
+    }                                                                           \
+    pRoot = P##_NODE(tree, root);                                               \
+    if (P##_LESS(key, pRoot->key)) {                                            \
+        pRoot->left = _##name##Remove(tree, pRoot->left, key, success);         \
+        return root;                                                            \
+    }                                                                           \
+    if (P##_LESS(pRoot->key, key)) {                                            \
+        pRoot->right = _##name##Remove(tree, pRoot->right, key, success);       \
+        return root;                                                            \
+    }                                                                           \
+                                                                                \
+    if (!pRoot->left)                                                           \
+        newRoot = pRoot->right;                                                 \
+    else if (!pRoot->right)                                                     \
+        newRoot = pRoot->left;                                                  \
+    else {                                                                      \
+        /* the largest node of the left subtree takes the place */              \
+        /* (a node cannot exchange values: it belongs to its value) */          \
+        exchPre = LINK_NONE;                                                    \
+        exchPtr = pRoot->left;                                                  \
+        while (P##_NODE(tree, exchPtr)->right) {                                \
+            exchPre = exchPtr;                                                  \
+            exchPtr = P##_NODE(tree, exchPtr)->right;                           \
+        }                                                                       \
+        if (exchPre) {                                                          \
+            P##_NODE(tree, exchPre)->right = P##_NODE(tree, exchPtr)->left;     \
+            P##_NODE(tree, exchPtr)->left = pRoot->left;                        \
+        }                                                                       \
+        P##_NODE(tree, exchPtr)->right = pRoot->right;                          \
+        newRoot = exchPtr;                                                      \
+    }                                                                           \
+    P##_RELEASE(P##_NODE_VALUE(pRoot));                                         \
+    *success = true;                                                            \
+    return newRoot;                                                             \
+}                                                                               \
+                                                                                \
+/* inorder walk of a subtree */                                                 \
+static void _##name##Traverse (TREE_T* tree, LINK_T root,                       \
+                               void (*process) (void* pValue))                  \
+{                                                                               \
+    if (root) {                                                                 \
+        _##name##Traverse(tree, P##_NODE(tree, root)->left, process);           \
+        process(P##_NODE_VALUE(P##_NODE(tree, root)));                          \
+        _##name##Traverse(tree, P##_NODE(tree, root)->right, process);          \
+    }                                                                           \
+}                                                                               \
+                                                                                \
+TREE_T* name##Create (void)                                                     \
+{                                                                               \
+    TREE_T* tree;                                                               \
+                                                                                \
+    if ((tree = (TREE_T*) P##_ALLOC(HEADER, sizeof(TREE_T)))) {                 \
+        tree->count = 0;                                                        \
+        tree->root = LINK_NONE;                                                 \
+        tree->changes = 0;                                                      \
+    }                                                                           \
+    return tree;                                                                \
+}                                                                               \
+                                                                                \
+bool name##Insert (TREE_T* tree, P##_VALUE_T* pValue)                           \
+{                                                                               \
+    NODE_T* pNew;                                                               \
+    NODE_T* pWalker;                                                            \
+    LINK_T newPtr = P##_NODE_OF(pValue);                                        \
+                                                                                \
+    pNew = P##_NODE(tree, newPtr);                                              \
+    pNew->key = P##_KEY(pValue);                                                \
+    pNew->left = LINK_NONE;                                                     \
+    pNew->right = LINK_NONE;                                                    \
+                                                                                \
+    if (!tree->root)                                                            \
+        tree->root = newPtr;                                                    \
+    else {                                                                      \
+        /* down to a leaf, equal keys to the right */                           \
+        pWalker = P##_NODE(tree, tree->root);                                   \
+        for (;;) {                                                              \
+            if (P##_LESS(pNew->key, pWalker->key)) {                            \
+                if (!pWalker->left) {                                           \
+                    pWalker->left = newPtr;                                     \
+                    break;                                                      \
+                }                                                               \
+                pWalker = P##_NODE(tree, pWalker->left);                        \
+            }                                                                   \
+            else {                                                              \
+                if (!pWalker->right) {                                          \
+                    pWalker->right = newPtr;                                    \
+                    break;                                                      \
+                }                                                               \
+                pWalker = P##_NODE(tree, pWalker->right);                       \
+            }                                                                   \
+        }                                                                       \
+    }                                                                           \
+    tree->count++;                                                              \
+    tree->changes++;                                                            \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+bool name##Build (TREE_T* tree, P##_VALUE_T** values, int count)                \
+{                                                                               \
+    int built = 0;                                                              \
+                                                                                \
+    tree->root = _##name##Build(tree, values, 0, count - 1, &built);            \
+    tree->count = built;                                                        \
+    tree->changes++;                                                            \
+    return built == count;                                                      \
+}                                                                               \
+                                                                                \
+bool name##Remove (TREE_T* tree, P##_KEY_T key)                                 \
+{                                                                               \
+    bool success;                                                               \
+    LINK_T newRoot;                                                             \
+                                                                                \
+    newRoot = _##name##Remove(tree, tree->root, key, &success);                 \
+    if (success) {                                                              \
+        tree->root = tree->count > 1 ? newRoot : LINK_NONE;                     \
+        tree->count--;                                                          \
+        tree->changes++;                                                        \
+    }                                                                           \
+    return success;                                                             \
+}                                                                               \
+                                                                                \
+P##_VALUE_T* name##Find (TREE_T* tree, P##_KEY_T key)                           \
+{                                                                               \
+    NODE_T* root = P##_NODE(tree, tree->root);                                  \
+                                                                                \
+    while (root)                                                                \
+    {                                                                           \
+        if (P##_LESS(key, root->key))                                           \
+            root = P##_NODE(tree, root->left);                                  \
+        else if (P##_LESS(root->key, key))                                      \
+            root = P##_NODE(tree, root->right);                                 \
+        else                                                                    \
+            return P##_NODE_VALUE(root);                                        \
+    }                                                                           \
+    return NULL;                                                                \
+}                                                                               \
+                                                                                \
+void name##Traverse (TREE_T* tree, void (*process) (void* pValue))              \
+{                                                                               \
+    _##name##Traverse(tree, tree->root, process);                               \
+}                                                                               \
+                                                                                \
+/* The nodes are freed in inorder sequence without recursion: */                \
+/* while the root has a left subtree it is rotated right, */                    \
+/* otherwise the root is freed and its right subtree becomes */                 \
+/* the new root. Linear time and constant stack, even for a */                  \
+/* degenerate tree. */                                                          \
+TREE_T* name##Destroy (TREE_T* tree)                                            \
+{                                                                               \
+    LINK_T root;                                                                \
+    LINK_T nextPtr;                                                             \
+                                                                                \
+    if (tree) {                                                                 \
+        root = tree->root;                                                      \
+        while (root) {                                                          \
+            if (P##_NODE(tree, root)->left) {                                   \
+                nextPtr = P##_NODE(tree, root)->left;                           \
+                P##_NODE(tree, root)->left = P##_NODE(tree, nextPtr)->right;    \
+                P##_NODE(tree, nextPtr)->right = root;                          \
+            }                                                                   \
+            else {                                                              \
+                nextPtr = P##_NODE(tree, root)->right;                          \
+                P##_RELEASE(P##_NODE_VALUE(P##_NODE(tree, root)));              \
+            }                                                                   \
+            root = nextPtr;                                                     \
+        }                                                                       \
+        P##_FREE(HEADER, tree, sizeof(TREE_T));                                 \
+    }                                                                           \
+    return NULL;                                                                \
+}
@@ -1,17 +1,23 @@
 /* hash.c
  This file contains the definitons of the functions to maintain
- and process a hash:
+ and process a hash. The table itself is airportHash (airport.c,
+ generated by generic.h); these functions add the filter, the
+ latency counters and the error handling around it.
  
  Functions:
  buildHash
  insertHash
  checkHash
  findHash
+ destroyHash
  upsizeHash
  downHash
+ rehash
  deleteHash
+ insertRecord
+ deleteRecord
+ removeHash
  converter
- collisionSolver
  countCollision
  hashDemo
  
@@ -28,29 +34,15 @@
  */
 HASH* buildHash (int sizeHash)
 {
+	//	Local Declarations
     HASH* pHash=NULL;
-    int i;
-    if (!(pHash = (HASH*) malloc(sizeof(HASH))))
+
+	//	Statements
+    if (!(pHash = airportHashCreate(sizeHash)))
     {
-        printf("Memory Allocation Error\n");
-        exit(102);
-    }
-    
-    pHash->pTable = NULL;
-    pHash->arraySize = 0;
-    pHash->countUsed = 0;
-    
-    if (!(pHash->pTable = (HASH_NODE*) calloc(sizeHash, sizeof(HASH_NODE)))) {
         printf("Not enought memory\n");
         exit(103);
     }
-    pHash->arraySize = sizeHash;
-    
-    for (i=0; i < sizeHash; i++) {
-        pHash->pTable[i].countCollision = 0;
-        pHash->pTable[i].pCollision = NULL;
-        pHash->pTable[i].pData = NULL;
-    }
     
     return pHash;
 }	// buildHash
@@ -70,21 +62,14 @@ bool insertHash(HASH* pHash, DATA* pDataIn)
 {
 	//	Local Declarations
 	bool result = false;
-	int index;
+	unsigned long long start = latencyStart();
     
 	//	Statements
-	index = converter(pDataIn, pHash->arraySize);
-	if (pHash->pTable[index].pData == NULL) {
-		pHash->pTable[index].pData = pDataIn;
-		pHash->countUsed++;
-		result = true;
-	}
-	else{
-		pHash->pTable[index].pCollision = collisionSolver(pHash->pTable[index].pCollision, pDataIn);
-		pHash->pTable[index].countCollision++;
-		result = true;
-	}
+	if (pHash->pFilter)
+		filterAdd(pHash->pFilter, pDataIn);
+	result = airportHashInsert(pHash, pDataIn);
     
+	latencyRecord(LAT_INSERT, start);
 	return result;
 }	// insertHash
 
@@ -119,7 +104,9 @@ int checkHash (HASH* pHash)
 /*	================== findHash =================
  This function will search hash for designated
  DATA structure, and return to user that position
- in the hash.
+ in the hash. Codes rejected by the filter are not
+ searched at all; the others are searched by
+ airportHashFind (airport.c).
  Pre		pHash - pointer to start of hash table
  target - pointer to searched DATA
  structure
@@ -131,39 +118,41 @@ int checkHash (HASH* pHash)
 DATA* findHash (HASH* pHash, DATA* target)
 {
 	//	Local Declarations
-    int index;
-	DATA* pSwap = NULL;
-	COLLISION* pWalker = NULL;
+	DATA* pFound = NULL;
+    unsigned long long start = latencyStart();
     
 	//	Statements
-    index = converter(target, pHash->arraySize);
-    
-    if (pHash->pTable[index].pData != NULL)
+    if (!pHash->pFilter || filterCheck(pHash->pFilter, target))
     {
-        if (compareCode(pHash->pTable[index].pData, target) != 0)
-        {
-            pWalker = pHash->pTable[index].pCollision;
-            
-            while (pWalker!=NULL)
-            {
-                if (compareCode(pWalker->pData, target) == 0) {
-                    pSwap = pHash->pTable[index].pCollision->pData;
-                    pHash->pTable[index].pCollision->pData = pWalker->pData;
-                    pWalker->pData = pSwap;
-                    
-                    return pHash->pTable[index].pCollision->pData;
-                }
-                else pWalker=pWalker->next;
-            }
-        }
-        else {
-            return pHash->pTable[index].pData;
-        }
+        pFound = airportHashFind(pHash, CODE_KEY(target->arpCode));
+        if (pFound == NULL && pHash->pFilter)
+            filterMissed(pHash->pFilter);
     }
-    return NULL;
+    latencyRecord(LAT_FIND, start);
+    return pFound;
 }	// findHash
 
 
+/*	================== destroyHash =================
+ This function frees the hash table with its
+ collision nodes and filter. The records are not
+ freed.
+ Pre		pHash - pointer to start of hash table
+ Post		hash table is freed
+ Return	NULL
+ */
+HASH* destroyHash (HASH* pHash)
+{
+	//	Statements
+    if (pHash)
+    {
+        filterDestroy(pHash->pFilter);
+        airportHashDestroy(pHash);
+    }
+    return NULL;
+}	// destroyHash
+
+
 /*	================== upsizeHash =================
  This function will resize the hash, by allocating
  double the size of current hash.
@@ -173,34 +162,8 @@ DATA* findHash (HASH* pHash, DATA* target)
  */
 HASH* upsizeHash (HASH* pHash)
 {
-	//	Local Declarations
-	COLLISION* pWalker;
-    COLLISION* pPre;
-	HASH* newHash = NULL;
-	int i;
-    int newArraySize = pHash->arraySize * 2;
-    
 	//	Statements
-    newHash = buildHash(newArraySize);
-    for (i = 0; i < pHash->arraySize; i++) {
-        if (pHash->pTable[i].pData != NULL)
-        {
-            insertHash(newHash, pHash->pTable[i].pData);
-            
-            pWalker = pHash->pTable[i].pCollision;
-            while (pWalker != NULL) {
-                pPre=pWalker;
-                insertHash(newHash, pWalker->pData);
-                pWalker=pWalker->next;
-                //Free pPre to free the collision node that we allocated
-                free(pPre);
-            }
-        }
-    }
-    free(pHash->pTable);
-    free(pHash);
-    
-    return newHash;
+    return rehash(pHash, pHash->arraySize * 2);
 }	// upsizeHash
 
 
@@ -212,42 +175,60 @@ HASH* upsizeHash (HASH* pHash)
  Return	pointer to start of "smaller" hash table
  */
 HASH* downsizeHash (HASH* pHash)
+{
+	//	Statements
+    if (pHash->arraySize < 2)
+        return pHash;
+    return rehash(pHash, pHash->arraySize / 2);
+}	// downsizeHash
+
+
+/*	================== rehash =================
+ This function moves every record into a new table of
+ the given size (see airportHashResize: large tables
+ are resized by several threads, the collision nodes
+ are reused and the result is the same as inserting
+ the records one by one), then resizes the filter if
+ it no longer fits the number of records.
+ Pre		pHash - pointer to start of hash table
+ newArraySize - size of the new table
+ Post	    old table is freed
+ Return	pointer to start of the new hash table
+ */
+HASH* rehash (HASH* pHash, int newArraySize)
 {
 	//	Local Declarations
-	COLLISION* pWalker;
-    COLLISION* pPre;
-	HASH* newHash = NULL;
-	int i;
-    int newArraySize = pHash->arraySize / 2;
-    
+    DATA** records;
+    int countRecords;
+    unsigned long long start = latencyStart();
+
 	//	Statements
-    newHash = buildHash(newArraySize);
-    
-    for (i = 0; i<pHash->arraySize; i++) {
-        if (pHash->pTable[i].pData != NULL)
-        {
-            insertHash(newHash, pHash->pTable[i].pData);
-            
-            pWalker = pHash->pTable[i].pCollision;
-            while (pWalker != NULL) {
-                pPre = pWalker;
-                insertHash(newHash, pWalker->pData);
-                pWalker = pWalker->next;
-                //Free pPre to free the collision node that we allocated
-                free(pPre);
-            }
+    if (!airportHashResize(pHash, newArraySize)) {
+        printf("Not enought memory\n");
+        exit(107);
+    }
+
+    countRecords = airportHashValues(pHash, NULL);
+    if (pHash->pFilter && !filterFits(pHash->pFilter, countRecords))
+    {
+        if (!(records = (DATA**) memAlloc(MEM_SLOT, (countRecords + 1) * sizeof(DATA*)))) {
+            printf("Not enought memory\n");
+            exit(107);
         }
+        airportHashValues(pHash, records);
+        pHash->pFilter = filterResize(pHash->pFilter, records, countRecords);
+        memFree(MEM_SLOT, records, (countRecords + 1) * sizeof(DATA*));
     }
-    free(pHash->pTable);
-    free(pHash);
     
-    return newHash;
-}	// downsizeHash
+    latencyRecord(LAT_RESIZE, start);
+    return pHash;
+}	// rehash
 
 
 /*	================== deleteHash =================
  This function will delete an element that is within
  the hash table or within the collision linked-list.
+ Codes rejected by the filter are not searched.
  Pre		pHash - pointer to start of hash table
  DATA - data structure to be deleted
  Post	    element is delete from hash table or
@@ -260,10 +241,8 @@ bool deleteHash (HEAD* pHeader, DATA target)
 	//	Local Declarations
     bool result = false;
     DATA* delAirport = NULL;
-    int index = 0;
-    COLLISION* pPre = NULL;
-    COLLISION* pCur = NULL;
 	int i;
+    unsigned long long start = latencyStart();
     
 	//	Statements
     
@@ -272,127 +251,120 @@ bool deleteHash (HEAD* pHeader, DATA target)
 		target.arpCode[i] = toupper(target.arpCode[i]);
 	}
     
-    delAirport = (DATA*) BST_Retrieve(pHeader->pTree, &target);
+    if (pHeader->pShards)
+        delAirport = shardFind(pHeader->pShards, &target);
+    else if (pHeader->pHash->pFilter && !filterCheck(pHeader->pHash->pFilter, &target))
+        delAirport = NULL;
+    else if (!(delAirport = frozenRetrieve(pHeader, CODE_KEY(target.arpCode))) && pHeader->pHash->pFilter)
+        filterMissed(pHeader->pHash->pFilter);
+    
     if (delAirport == NULL)
     {
         printf("Your enter wrong airport code\n");
-        return result;
-    }
-    else{
-        result = true;
-        index = converter(delAirport, pHeader->pHash->arraySize);
-        //Delete a data which is in the Hash table
-        if (compareCode(delAirport, pHeader->pHash->pTable[index].pData) == 0)
-        {
-            free(delAirport->city);
-            BST_Delete(pHeader->pTree, delAirport);
-            if (pHeader->pHash->pTable[index].pCollision != NULL)
-            {
-                pHeader->pHash->pTable[index].pData = pHeader->pHash->pTable[index].pCollision->pData;
-				pCur = pHeader->pHash->pTable[index].pCollision;
-                pHeader->pHash->pTable[index].pCollision = pHeader->pHash->pTable[index].pCollision->next;
-                pHeader->pHash->pTable[index].countCollision--;
-				free(pCur);
-            }
-            else{
-                pHeader->pHash->pTable[index].pData = NULL;
-                pHeader->pHash->countUsed--;
-            }
-        }
-        //Delete a data which is in the collision linked pist
-        else{
-            pCur = pHeader->pHash->pTable[index].pCollision;
-            if (pCur->next == NULL) {
-                free(pCur->pData->city);
-                BST_Delete(pHeader->pTree, delAirport);
-                free(pCur);
-                pHeader->pHash->pTable[index].pCollision = NULL;
-                pHeader->pHash->pTable[index].countCollision = 0;
-            }
-            else{
-                if (compareCode(pCur->pData, delAirport) == 0) {
-                    pHeader->pHash->pTable[index].pCollision = pCur->next;
-                    free(pCur->pData->city);
-                    BST_Delete(pHeader->pTree, delAirport);
-                    free(pCur);
-                    pHeader->pHash->pTable[index].countCollision--;
-                }
-                else{
-                    while (compareCode(pCur->pData, delAirport) != 0 || pCur->next != NULL) {
-                        pPre = pCur;
-                        pCur = pCur->next;
-                    }
-                    pPre->next = pCur->next;
-                    free(pCur->pData->city);
-                    BST_Delete(pHeader->pTree, delAirport);
-                    free(pCur);
-                    pHeader->pHash->pTable[index].countCollision--;
-                }
-            }
-        }
-        
     }
+    else
+        result = deleteRecord(pHeader, delAirport);
+    latencyRecord(LAT_DELETE, start);
     return result;
 }	// deleteHash
 
 
-/*	================== converter =================
- This function acts as the hash function and
- calculates the key in which information should
- be inserted into.
- Pre		pData - pointer to DATA structure
- sizeHash - size of the Hash Table
- Post
- Return	calculated key
+/*	================== insertRecord =================
+ This function puts a new record into the hash table,
+ the tree, the frozen index, the city index and the
+ column store. A head without a tree (a bulk load that
+ builds the tree itself) only gets the other indexes.
+ Pre		pHeader - pointer to HEAD structure
+ pData - record not yet stored in the database
+ Post	    record is stored
+ Return	true if the hash table took the record
  */
-int converter(DATA* pData, int sizeHash)
+bool insertRecord (HEAD* pHeader, DATA* pData)
 {
 	//	Local Declarations
-    int index = 1;
-	int i;
+    bool result;
     
 	//	Statements
-    for (i = 0; i < 3; i++) {
-        index *= (pData->arpCode[i] - 64 + 7);
+    if (pHeader->pShards)
+        result = shardInsert(pHeader->pShards, pData);
+    else
+        result = insertHash(pHeader->pHash, pData);
+    if (pHeader->pTree) {
+        BST_Insert(pHeader->pTree, pData);
+        frozenAdd(pHeader->pFrozen, pHeader->pTree, pData);
     }
-    index = index % sizeHash;
-    return index;
-}	// converter
+    cityIndexAdd(pHeader->pCity, pData);
+    if (pHeader->pColumns)
+        columnAdd(pHeader->pColumns, pData);
+    return result;
+}	// insertRecord
 
 
-/*	================== collisionSolver =================
- This function will place a collision key into a linked
- list for that index of the hash table.
- Pre		pList - pointer to linked-list
- pData - pointer to DATA structure
- Post
- Return	pointer position in collision linked list
+/*	================== deleteRecord =================
+ This function takes a stored record out of the hash
+ table, the city index, the column store and the tree,
+ and frees it.
+ Pre		pHeader - pointer to HEAD structure
+ delAirport - record stored in the database
+ Post	    record is deleted
+ Return	true if the hash table held the record
  */
-COLLISION* collisionSolver (COLLISION* pList, DATA* pData)
+bool deleteRecord (HEAD* pHeader, DATA* delAirport)
 {
 	//	Local Declarations
-    COLLISION* pInsert = NULL;
+    bool result;
     
 	//	Statements
-    if ((pInsert = (COLLISION*) malloc(sizeof(COLLISION)))) {
-        pInsert->next = NULL;
-        pInsert->pData = pData;
-    }
-    else{
-        printf("Error allocating collision node\n");
-        exit(106);
-    }
-    
-    if (pList == NULL) {
-        pList = pInsert;
-    }
-    else{
-        pInsert->next = pList;
-        pList = pInsert;
-    }
+    if (pHeader->pShards)
+        result = shardRemove(pHeader->pShards, delAirport);
+    else
+        result = removeHash(pHeader->pHash, delAirport);
+    cityIndexRemove(pHeader->pCity, delAirport);
+    if (pHeader->pColumns)
+        columnRemove(pHeader->pColumns, delAirport);
+    frozenRemove(pHeader->pFrozen, pHeader->pTree, delAirport);
+    // BST_Delete frees the record itself
+    BST_Delete(pHeader->pTree, delAirport);
+    return result;
+}	// deleteRecord
+
+
+/*	================== removeHash =================
+ This function takes a record out of the hash table,
+ from its slot or from the collision linked-list, and
+ out of the filter. The record itself is not freed.
+ Pre		pHash - pointer to start of hash table
+ pData - record stored in the table
+ Post	    record is no longer in the table
+ Return	true if the record was found
+ false if not
+ */
+bool removeHash (HASH* pHash, DATA* pData)
+{
+	//	Statements
+    if (!airportHashRemove(pHash, pData))
+        return false;
     
-    return pList;
-}	// collisionSolver
+    if (pHash->pFilter)
+        filterRemove(pHash->pFilter, pData);
+    return true;
+}	// removeHash
+
+
+/*	================== converter =================
+ This function acts as the hash function and
+ calculates the key in which information should
+ be inserted into.
+ Pre		pData - pointer to DATA structure
+ sizeHash - size of the Hash Table
+ Post
+ Return	calculated key
+ */
+int converter(DATA* pData, int sizeHash)
+{
+	//	Statements
+    return CODE_INDEX(CODE_KEY(pData->arpCode), sizeHash);
+}	// converter
 
 
 /*	================== hashDemo =================
@@ -429,46 +401,76 @@ HASH* hashDemo (HASH* pHash)
  linked-list and the average number of nodes that
  are in linked-lists. Will print out these values,
  along with other useful information for user to
- figure out the efficiency of the hash.
- Pre		pHash - pointer to HEAD structure
+ figure out the efficiency of the hash. A sharded
+ table is reported shard by shard, then as a whole.
+ Pre		pHeader - pointer to HEAD structure
  Post		prints : load factor
  longest linked-list
  average collision nodes
  Return
  */
-void efficiency(HASH* pHash)
+void efficiency(HEAD* pHeader)
 {
 	// Local Declarations
+	HASH* pHash;
+	FILTER filterTotal;
 	float loadFactor = 0;
 	int longestList = 0;
 	float avgList = 0;
 	int i = 0;
 	int j = 0;
+	int s;
 	int collisionCount = 0;
+	int shardCollisions;
+	int countUsed = 0;
+	int arraySize = 0;
     
 	// Statements
-    
-	loadFactor = (float) pHash->countUsed / (float) pHash->arraySize * 100;
-	for (i = 0; i < pHash->arraySize; i++)
+	memset(&filterTotal, 0, sizeof(FILTER));
+	if (pHeader->pShards)
+		printf("\n");
+	for (s = 0; s < shardCount(pHeader); s++)
 	{
-		if (pHash->pTable[i].countCollision > 0)
+		pHash = shardTable(pHeader, s);
+		shardCollisions = 0;
+		for (i = 0; i < pHash->arraySize; i++)
+		{
+			if (pHash->pTable[i].countCollision > 0)
+			{
+				j++;
+				if (pHash->pTable[i].countCollision > longestList)
+					longestList = pHash->pTable[i].countCollision;
+				shardCollisions = shardCollisions + pHash->pTable[i].countCollision;
+			}
+		}
+		collisionCount += shardCollisions;
+		countUsed += pHash->countUsed;
+		arraySize += pHash->arraySize;
+		if (pHash->pFilter)
 		{
-			j++;
-			if (pHash->pTable[i].countCollision > longestList)
-				longestList = pHash->pTable[i].countCollision;
-			collisionCount = collisionCount + pHash->pTable[i].countCollision;
+			filterTotal.countBlocks += pHash->pFilter->countBlocks;
+			filterTotal.countKeys += pHash->pFilter->countKeys;
+			filterTotal.countQueries += pHash->pFilter->countQueries;
+			filterTotal.countNegatives += pHash->pFilter->countNegatives;
+			filterTotal.countFalse += pHash->pFilter->countFalse;
 		}
+		if (pHeader->pShards)
+			printf("Shard %d: %d of %d nodes used, %d collisions.\n",
+			       s, pHash->countUsed, pHash->arraySize, shardCollisions);
 	}
     
+	loadFactor = (float) countUsed / (float) arraySize * 100;
 	if (j > 0)
 		avgList = collisionCount / (float) j;
 	
 	printf("\nThe load factor is %.2f%%.\n", loadFactor);
-	printf("The number of hash nodes used is %d.\n", pHash->countUsed);
-	printf("The total size of hash is %d.\n",pHash->arraySize);
+	printf("The number of hash nodes used is %d.\n", countUsed);
+	printf("The total size of hash is %d.\n", arraySize);
 	printf("The total collision count is %d.\n", collisionCount);
 	printf("The longest linked list is %d nodes long.\n", longestList);
 	printf("The average number of nodes in a list is %.2f.\n\n", avgList);
+	if (filterTotal.countBlocks > 0)
+		filterReport(&filterTotal);
 	
 	return;
 }	// efficiency
\ No newline at end of file
@@ -23,6 +23,144 @@
  way as original input file, so the user can use the output file
  as the input file to run the program if they choose to.
  
+ The memory functions wrap every allocation made for the
+ database and count the bytes and objects used by each part
+ of it (table slots, chain nodes, records, strings and
+ headers), so the footprint can be reported together with
+ the efficiency of the hash.
+ 
+ The strpool functions keep every distinct city name once in
+ a shared buffer. A record stores only the handle of its city
+ name, so airports in the same city share the same text. Each
+ name counts the records using it and is given back when the
+ last of them is freed or moves to another city.
+ 
+ The pool functions hand out fixed size objects (such as the
+ collision nodes) from large slabs, so the hot paths do not
+ call malloc for every node and a whole pool can be released
+ at once.
+ 
+ Each record carries its own tree node, so adding a record to
+ the tree or taking it out allocates nothing, and a search that
+ ends on a node finds the record in the same place.
+ 
+ With COMPACT_LINKS defined (gcc -DCOMPACT_LINKS), the records
+ and the collision nodes are kept in pools and link to each
+ other by their 32-bit position in the pool instead of by
+ pointer, which makes the nodes and hash slots half as big
+ on a 64-bit machine. It cannot be combined with EMBEDDED_DATA.
+ 
+ The filter functions keep a compact counting Bloom filter of
+ the stored codes. findHash and deleteHash ask it first, so a
+ code that is certainly absent costs no search of the hash
+ table or the tree.
+ 
+ The cityindex functions keep a secondary index of the records
+ by city name, kept up to date by addAirport and deleteHash,
+ and search it by exact name, by the start of the name, or by
+ a name with a few typing mistakes. Fuzzy searches only check
+ the names that share enough three letter groups with the
+ query.
+ 
+ The column functions keep the codes, coordinates and city
+ handles of all airports in parallel arrays, so a filter on
+ the coordinates is a scan over two contiguous arrays instead
+ of a walk through the records.
+ 
+ The macros of generic.h generate a chained hash table and a
+ binary search tree, types and functions, from a policy: the
+ key and value types, the hash, equality and ordering of the
+ keys, the links and the allocator, all expanded in place.
+ The AIRPORT policy below keys the records by their code,
+ packed into one integer by CODE_KEY, and airport.c defines
+ its containers; the hash and BST functions wrap them, and
+ generic.c runs the passes of large resizes on several threads.
+ The packed key is kept in the table slots and the collision
+ nodes, so hash searches and resizes never read the records
+ themselves, and in the tree nodes next to their links.
+ 
+ With USE_SHARDS (which may be given to the compiler), the
+ shard functions replace the single hash table by SHARD_COUNT
+ independent tables, each with its own size, resizing and lock.
+ Only the hash table is sharded: the shard functions may be
+ called by several threads at once, but insertRecord,
+ deleteRecord and everything else they update (tree, indexes,
+ column store, record and name pools) are not locked, so the
+ database itself is still written by one thread at a time.
+ shardCount and shardTable let the code that walks the hash
+ table visit every shard.
+ 
+ The asyncfile functions read and write the data files in large
+ blocks. On Linux they keep several reads (or writes) in flight
+ through io_uring while the program parses (or formats) another
+ block; elsewhere they fall back to plain fread and fwrite.
+ 
+ The ingest functions load the database from several files
+ given on the command line, which may overlap: each file is
+ parsed and sorted on its own thread, the files are merged by
+ code with one record kept per code (first file, last file or
+ newest coordinates wins), and the tree is built balanced from
+ the merged stream.
+ 
+ The delta functions apply a file of additions, changes and
+ deletions in one pass: the changes are sorted by code, the
+ hash table is resized at most once for the final number of
+ records, and the changes are applied in key order.
+ 
+ The watch functions notice when a data file changes (through
+ inotify on Linux), so the menu syncs the database with it
+ (syncFile, in delta.c) before the next command: only the codes
+ added, changed or removed since the last version are applied.
+ 
+ The latency functions time the searches, insertions, deletions
+ and resizes of the hash table and the tree, and the writing of
+ the output file, into a log-scaled histogram per operation.
+ Their percentiles are shown with the efficiency and the whole
+ histograms can be saved to a file.
+ 
+ The profile functions add a profiling mode to the same timed
+ operations: while it is on, the hardware counters (cycles,
+ instructions, cache and branch misses) and the allocations of
+ each operation are added up and reported per operation.
+ 
+ The trace functions record the adds, finds and deletes typed
+ in the menu to a compact binary trace, and replay a trace at
+ full speed, reporting the throughput and the latencies, so
+ changes to the tables can be compared on real traffic.
+ 
+ The frozen functions keep a copy of the key order of the tree
+ in arrays (the codes in Eytzinger order and the records in key
+ order). It serves the listing in key order, the searches by
+ range of codes and the searches of the tree. The records in key
+ order are kept up to date by the adds and deletes of the menu,
+ the codes are laid out again from them when next searched; any
+ other change of the tree rebuilds it in one pass from the tree
+ when it is needed again.
+ 
+ The disk functions are a storage engine for databases larger
+ than the memory (airports -disk[=KB] file.db ...): the airports
+ are kept in a B+tree in a paged file, read through a buffer pool
+ of a fixed number of pages with clock eviction, and searched,
+ listed, added and deleted from their own menu.
+ 
+ The query functions run compound queries typed in the menu
+ (codes, city, coordinates, distance to a point, order and
+ limit): a planner picks the hash table, the frozen index, the
+ city index or the column store from the number of records each
+ would read, and the results are printed as they are found when
+ that path already gives them in the order asked for.
+ 
+ The export functions write the records to a file in key order
+ on several threads: each thread formats one part of the frozen
+ index into its own buffer and writes it with pwrite at the
+ offset the parts before it end at.
+ 
+ With EMBEDDED_DATA defined, buildEmbedded (embedded.c) starts
+ the program from the database compiled into it instead of
+ reading data.txt. tools/embed.c writes that database, with a
+ collision free hash table and a balanced tree, to
+ data_embedded.h.
+ 
  */
 
 #include <stdio.h>
@@ -32,89 +170,543 @@
 #include <string.h>
 //#include <stdbool.h>
 typedef enum { false, true} bool;
+#include "generic.h"
+
+#define CITY_NONE 0xFFFFFFFFu
+#define USE_FILTER true         // false to run without the membership filter
+#define MAX_CITY_RESULTS 100    // airports printed by one city search
+#define USE_COLUMNS true        // false to run without the column store
+#ifndef USE_SHARDS
+#define USE_SHARDS false        // true (gcc -DUSE_SHARDS=true) to split the hash table into shards
+#endif
+#define SHARD_COUNT 8           // sub-tables of a sharded hash table
+#define ASYNC_BLOCK 65536       // bytes per read or write of a data file
+#define ASYNC_DEPTH 4           // blocks in flight at once
+#define LINE_SIZE 256           // room for one line of a data file
+#define USE_LATENCY true        // false to stop timing the operations
+#define DISK_PAGE 4096          // bytes per page of a disk database
+#define DISK_BUDGET 1024        // KB of buffer pool of a disk database
+
+// An airport code packed into one integer with the same order as
+// strcmp: the letters after the first '\0' are ignored.
+#define CODE_KEY(code)                                                  \
+    ((unsigned) (unsigned char) (code)[0] << 16 |                       \
+     ((code)[0] ? ((unsigned) (unsigned char) (code)[1] << 8 |          \
+                   ((code)[1] ? (unsigned char) (code)[2] : 0u)) : 0u))
+
+// Hash index of a packed code: the product of the letters (as
+// 'A' = 8 ...) modulo the table size, never negative.
+#define CODE_INDEX(key, size)                                           \
+    ((int) ((((key) >> 16) - 57u) * (((key) >> 8 & 0xFFu) - 57u) *     \
+            (((key) & 0xFFu) - 57u) % (unsigned) (size)))
+
+// The airport policy of the containers of generic.h: records keyed
+// by their packed code, linked as below, counted by memory.c.
+#define AIRPORT_KEY_T                       unsigned
+#define AIRPORT_VALUE_T                     DATA
+#define AIRPORT_LINK_T                      REC_LINK
+#define AIRPORT_KEY(pData)                  CODE_KEY((pData)->arpCode)
+#define AIRPORT_INDEX(key, size)            CODE_INDEX(key, size)
+#define AIRPORT_EQUAL(a, b)                 ((a) == (b))
+#define AIRPORT_LESS(a, b)                  ((a) < (b))
+#define AIRPORT_LINK_OF(pData)              REC_LINK_OF(pData)
+#define AIRPORT_VALUE(link)                 REC(link)
+#define AIRPORT_NODE_OF(pData)              NODE_LINK_OF(pData)
+#define AIRPORT_NODE(tree, link)            TREE_NODE(tree, link)
+#define AIRPORT_NODE_VALUE(pNode)           NODE_RECORD(pNode)
+#define AIRPORT_ALLOC(part, size)           memAlloc(MEM_##part, size)
+#define AIRPORT_CALLOC(part, count, size)   memCalloc(MEM_##part, count, size)
+#define AIRPORT_FREE(part, pBlock, size)    memFree(MEM_##part, pBlock, size)
+#define AIRPORT_POOL(objSize)               poolCreate(MEM_CHAIN, objSize, CHAIN_SLAB)
+#define AIRPORT_RELEASE(pData)              recordFree(pData)
+#define CHAIN_SLAB 64           // collision nodes per pool slab
 
 // Structure Definitions
-typedef struct{
+typedef enum {
+    MEM_SLOT, MEM_CHAIN, MEM_RECORD, MEM_STRING, MEM_INDEX, MEM_HEADER, MEM_TYPES
+}MEM_TYPE;
+
+typedef enum {
+    CITY_EXACT, CITY_PREFIX, CITY_FUZZY
+}CITY_MATCH;
+
+typedef enum {
+    COLUMN_LATITUDE, COLUMN_LONGITUDE
+}COLUMN_ID;
+
+typedef enum {
+    INGEST_FIRST, INGEST_LAST, INGEST_NEWEST
+}INGEST_POLICY;
+
+typedef enum {
+    LAT_FIND, LAT_INSERT, LAT_DELETE, LAT_RESIZE,
+    LAT_TREE_INSERT, LAT_TREE_DELETE, LAT_TREE_SEARCH, LAT_OUTPUT, LAT_BUILD, LAT_OPS
+}LAT_OP;
+
+// The links between the records, the tree nodes and the collision
+// nodes. With COMPACT_LINKS they are the position of the object in
+// its pool (see POOL_AT), 0 being no link, so a link takes 32 bits
+// instead of a 64-bit pointer; a tree node is linked by the position
+// of its record. REC, TREE_NODE, CHAIN and LINK_AT follow a link in
+// both modes, and LINK_TYPE gives the link type of a structure.
+#ifdef COMPACT_LINKS
+#define LINK_TYPE(tag)          unsigned
+#else
+#define LINK_TYPE(tag)          struct tag*
+#endif
+typedef LINK_TYPE(data) REC_LINK;
+
+// NODE_LINK, NODE (key: CODE_KEY of its record, left, right) and
+// BST_TREE (count, root, changes: insertions and deletions so far)
+DEFINE_TREE_TYPES(AIRPORT, BST_TREE, NODE, NODE_LINK, node)
+
+// The tree node comes first, so a record and its node share one
+// address (NODE_RECORD).
+typedef struct data{
+    NODE node;              // links of the record in the tree
     char arpCode[4];
-    char* city;
+    unsigned city;          // handle into the city pool
     float latitude;
     float longitude;
+    int row;                // row in the column store
+#ifdef COMPACT_LINKS
+    unsigned link;          // position in the record pool
+#endif
 }DATA;
 
-typedef struct collision{
-    DATA* pData;
-    struct collision* next;
-}COLLISION;
+typedef struct{
+    unsigned  offset;       // position of the name in the buffer,
+                            // next free handle + 1 when unused
+    unsigned  refs;         // records using the name, 0 if unused
+}STR_NAME;
+
+typedef struct{
+    char*     buffer;       // all names, '\0' terminated
+    unsigned  used;
+    unsigned  capacity;
+    unsigned  released;     // bytes of released names in buffer
+    STR_NAME* names;        // by handle
+    unsigned  countHandles; // handles given out, used or free
+    unsigned  nameCapacity;
+    unsigned  freeHandle;   // first free handle + 1, 0 if none
+    unsigned* index;        // open addressing, handle + 1 (0 = empty)
+    unsigned  indexSize;    // always a power of two
+    unsigned  countNames;
+}STR_POOL;
+
+typedef struct{
+    MEM_TYPE type;
+    size_t   objSize;
+    int      perSlab;
+    void*    pSlabs;
+    void*    pFree;
+    int      countSlabs;
+    int      countUsed;
+#ifdef COMPACT_LINKS
+    char**   pIndex;        // slab of every position
+    unsigned freeLink;      // first free position, 0 if none
+    int      capacitySlabs;
+#endif
+}POOL;
+
+#ifdef COMPACT_LINKS
+#define POOL_SHIFT  10      // 1 << POOL_SHIFT objects per slab
+#define POOL_AT(pPool, link)                                            \
+    ((link) ? (void*) ((pPool)->pIndex[(link) >> POOL_SHIFT] +          \
+                       ((link) & ((1u << POOL_SHIFT) - 1)) * (pPool)->objSize) : NULL)
+#endif
+
+typedef struct{
+    unsigned char* counters;
+    unsigned countBlocks;
+    int      countKeys;
+    long     countQueries;
+    long     countNegatives;    // codes rejected by the filter
+    long     countFalse;        // codes let through but not found
+}FILTER;
+
+// CHAIN_LINK, COLLISION (key, pData, next), HASH_NODE (countCollision,
+// key, pData, pCollision) and HASH (arraySize, countUsed, pTable,
+// pChains: collision nodes, kept on resize, then pFilter: NULL when
+// the filter is not used)
+DEFINE_HASH_TYPES(AIRPORT, HASH, HASH_NODE, COLLISION, CHAIN_LINK, hash, collision,
+                  FILTER* pFilter;)
 
+typedef struct{
+    int    countShards;
+    HASH** pTables;         // one independent table per shard
+    void*  pLocks;          // one lock per shard (pthread_mutex_t)
+}SHARDS;
 
 typedef struct{
-    int countCollision;
-    DATA* pData;
-    COLLISION* pCollision;
-}HASH_NODE;
+    unsigned city;          // handle of the city name
+    int      countRecords;
+    int      capacity;
+    DATA**   records;
+}CITY_ENTRY;
 
+typedef struct{
+    unsigned  gram;         // three folded letters, 0 = empty slot
+    int       count;
+    int       capacity;
+    unsigned* cities;       // handles of the names holding the gram
+}CITY_GRAM;
 
-typedef struct hash{
-    int arraySize;
-    int countUsed;
-    HASH_NODE* pTable;
-}HASH;
+typedef struct{
+    int         count;
+    int         capacity;
+    CITY_ENTRY* entries;    // sorted by name, ignoring case
+    CITY_GRAM*  grams;      // open addressing, NULL until the first
+                            // fuzzy search
+    int         gramSize;   // always a power of two
+    int         countGrams;
+}CITY_INDEX;
 
-typedef struct node
-{
-    void*        dataPtr;
-    struct node* left;
-    struct node* right;
-}NODE;
+typedef struct{
+    int       count;
+    int       capacity;
+    char*     codes;        // 4 bytes per row
+    float*    latitude;
+    float*    longitude;
+    unsigned* city;
+    DATA**    records;
+}COLUMNS;
 
-typedef struct
-{
-    int   count;
-    int  (*compare) (void* argu1, void* argu2);
-    NODE*  root;
-}BST_TREE;
+typedef struct{
+    COLUMN_ID column;
+    float     low;          // keeps low <= value <= high
+    float     high;
+}PREDICATE;
+
+typedef struct{
+    FILE*     fp;
+    bool      write;
+    bool      atEnd;
+    bool      failed;           // a write went wrong
+    char*     buffers;          // ASYNC_DEPTH blocks of ASYNC_BLOCK bytes
+    int       lengths[ASYNC_DEPTH];
+    long long offsets[ASYNC_DEPTH];
+    int       current;          // block being parsed or filled
+    int       position;         // next byte in the current block
+    long long nextOffset;       // file offset of the next request
+    void*     pRing;            // io_uring state, NULL for plain stdio
+}ASYNC_FILE;
+
+typedef struct{
+    int       count;
+    int       capacity;     // records the arrays have room for
+    int       changes;      // tree->changes it matches
+    bool      placed;       // keys and ranks match sorted
+    unsigned* keys;         // 1..count, Eytzinger order
+    int*      ranks;        // key order position of keys[k]
+    DATA**    sorted;       // records in key order
+}FROZEN;
 
 typedef struct{
     HASH* pHash;
     BST_TREE* pTree;
+    CITY_INDEX* pCity;
+    COLUMNS* pColumns;      // NULL when the column store is not used
+    SHARDS* pShards;        // replaces pHash (then NULL) when sharded
+    FROZEN* pFrozen;        // NULL until an ordered read builds it
 }HEAD;
 
+// An airport of a disk database, with its city name in the
+// record instead of a handle into the city pool.
+typedef struct{
+    char  arpCode[4];
+    char  city[20];
+    float latitude;
+    float longitude;
+}DISK_AIRPORT;
+
+typedef struct{
+    unsigned page;          // page held, 0 for a free frame
+    int      pins;          // users of the page
+    bool     dirty;         // page changed since it was read
+    bool     referenced;    // used since the clock hand passed
+    int      nextFrame;     // next frame of the same bucket, -1 for none
+}DISK_FRAME;
+
+typedef struct{
+    FILE*       fp;
+    unsigned    root;
+    unsigned    countPages;     // including the header page
+    int         countRecords;
+    int         height;         // inner levels above the leaves
+    int         countFrames;
+    DISK_FRAME* frames;
+    char*       pages;          // DISK_PAGE bytes per frame
+    int*        buckets;        // first frame of each page % countFrames
+    int         hand;           // clock hand
+    long long   hits;
+    long long   reads;
+    long long   writes;
+}DISK;
+
+typedef enum {
+    QUERY_POINT, QUERY_RANGE, QUERY_CITY, QUERY_COLUMNS
+}QUERY_PATH;
+
+typedef enum {
+    ORDER_NONE, ORDER_CODE, ORDER_CITY, ORDER_DISTANCE
+}QUERY_ORDER;
+
+typedef struct{
+    unsigned    codeLow;        // CODE_KEY range of the codes
+    unsigned    codeHigh;
+    char        city[20];       // "" for any city
+    bool        cityPrefix;
+    PREDICATE   box[2];         // latitude and longitude ranges
+    bool        near;
+    char        nearCode[4];    // "" when the point is given
+    float       nearLatitude;
+    float       nearLongitude;
+    float       radius;         // km
+    QUERY_ORDER order;
+    int         limit;          // 0 for no limit
+    QUERY_PATH  path;           // set by queryPlan
+    int         estimate;       // records the path should read
+    bool        ordered;        // path gives the records in order
+    int         countRead;      // records read by queryRun
+}QUERY;
+
+#ifdef COMPACT_LINKS
+extern POOL* recordPool;    // every record (memory.c)
+#define LINK_NONE               0u
+#define REC(link)               ((DATA*) POOL_AT(recordPool, link))
+#define REC_LINK_OF(pData)      ((pData)->link)
+#define TREE_NODE(tree, link)   ((NODE*) POOL_AT(recordPool, link))
+#define NODE_LINK_OF(pData)     ((pData)->link)
+#define LINK_AT(type, pPool, link) ((type*) POOL_AT(pPool, link))
+#define LINK_ALLOC(pPool)       poolAllocIndex(pPool)
+#define LINK_FREE(pPool, link)  poolFreeIndex(pPool, link)
+#else
+#define LINK_NONE               NULL
+#define REC(link)               (link)
+#define REC_LINK_OF(pData)      (pData)
+#define TREE_NODE(tree, link)   (link)
+#define NODE_LINK_OF(pData)     (&(pData)->node)
+#define LINK_AT(type, pPool, link) (link)
+#define LINK_ALLOC(pPool)       poolAlloc(pPool)
+#define LINK_FREE(pPool, link)  poolFree(pPool, link)
+#endif
+#define NODE_RECORD(pNode)      ((DATA*) (pNode))
+#define CHAIN(pChains, link)    LINK_AT(COLLISION, pChains, link)
+
 
 // main: Prototype Declarations
 HEAD* buildHead (HEAD* header, char* fileInput);
-bool getData (BST_TREE* tree, FILE* fpIn, DATA** airport);
+HEAD* createHead (HEAD* pHeader, int countRecords);
+bool getData (BST_TREE* tree, ASYNC_FILE* fpIn, DATA** airport);
+int parseLine (const char* line, char* airCode, char* city, float* latitude, float* longitude);
 int countLines (char* fileName);
 void getOption (HEAD* pHeader);
+void getDiskOption (DISK* pDisk);
 bool addAirport (HEAD* pHeader);
-void efficiency(HASH* pHash);
+void findCity (HEAD* pHeader);
+void scanCoordinates (HEAD* pHeader);
+void listRange (HEAD* pHeader);
+void runQuery (HEAD* pHeader);
+void efficiency(HEAD* pHeader);
+void clearHead (HEAD* pHeader);
 HEAD* destroy (HEAD* pHeader);
 
 //	hash: Prototype Declarations
 HASH* buildHash (int sizeHash);
 bool insertHash (HASH* hashTable, DATA* pData);
 bool deleteHash (HEAD* pHeader, DATA target);
+bool insertRecord (HEAD* pHeader, DATA* pData);
+bool deleteRecord (HEAD* pHeader, DATA* delAirport);
+bool removeHash (HASH* pHash, DATA* pData);
 int checkHash (HASH* header);
 int converter(DATA* pData, int sizeHash);
 HASH* upsizeHash (HASH* pHash);
 HASH* downsizeHash (HASH* pHash);
-COLLISION* collisionSolver (COLLISION* pList, DATA* pData);
+HASH* rehash (HASH* pHash, int newArraySize);
 DATA* findHash (HASH* pHash, DATA* target);
+HASH* destroyHash (HASH* pHash);
 int countCollision (HASH* pHash);
 HASH* hashDemo (HASH* pHash);
 
+//	embedded: Prototype Declarations
+HEAD* buildEmbedded (void);
+
+//	airport: Prototype Declarations
+DECLARE_HASH(AIRPORT, airportHash, HASH)
+DECLARE_TREE(AIRPORT, airportTree, BST_TREE)
+void* retrieveCode (BST_TREE* tree, unsigned key);
+
+//	generic: Prototype Declarations
+int genericThreads (int size);
+void genericRunWorkers (void* (*pass) (void* pWork), void* work, size_t workSize, int countThreads);
+
 //	data_output: Prototype Declarations
 char menu (void);
+char diskMenu (void);
 void printHash (HASH* pHash);
-void printTree (NODE* root, int level);
+void printTree (BST_TREE* tree, NODE_LINK root, int level);
 void processScreen (void* data);
-bool outputFile (HASH* pHash);
-void processFile (void* data, FILE* fOut);
+void processDiskScreen (void* data);
+bool outputFile (HEAD* pHeader);
+void processFile (void* data, ASYNC_FILE* fOut);
+int formatLine (const DATA* pAirport, char* line);
+void processDiskFile (void* data, ASYNC_FILE* fOut);
+
+//	memory: Prototype Declarations
+void* memAlloc (MEM_TYPE type, size_t size);
+void* memCalloc (MEM_TYPE type, size_t count, size_t size);
+void memFree (MEM_TYPE type, void* pBlock, size_t size);
+void memTrack (MEM_TYPE type, long size, int objects);
+long memOverhead (long size);
+void memStatic (const void* pStart, size_t size);
+bool memIsStatic (const void* pBlock);
+long memAllocCalls (void);
+DATA* recordAlloc (void);
+void recordFree (DATA* pData);
+void recordReset (void);
+void memoryReport (HEAD* pHeader);
+
+//	strpool: Prototype Declarations
+unsigned cityIntern (const char* name);
+unsigned cityFind (const char* name);
+void cityRelease (unsigned handle);
+const char* cityName (unsigned handle);
+STR_POOL* cityPoolState (void);
+void cityPoolDestroy (void);
+
+//	pool: Prototype Declarations
+POOL* poolCreate (MEM_TYPE type, size_t objSize, int perSlab);
+#ifdef COMPACT_LINKS
+unsigned poolAllocIndex (POOL* pPool);
+void poolFreeIndex (POOL* pPool, unsigned link);
+#else
+void* poolAlloc (POOL* pPool);
+void poolFree (POOL* pPool, void* pObject);
+#endif
+void poolReset (POOL* pPool);
+POOL* poolDestroy (POOL* pPool);
+
+//	filter: Prototype Declarations
+FILTER* filterCreate (int expected);
+void filterAdd (FILTER* pFilter, DATA* pData);
+void filterRemove (FILTER* pFilter, DATA* pData);
+bool filterCheck (FILTER* pFilter, DATA* pData);
+void filterMissed (FILTER* pFilter);
+bool filterFits (FILTER* pFilter, int countKeys);
+FILTER* filterResize (FILTER* pFilter, DATA** records, int countRecords);
+void filterReport (FILTER* pFilter);
+FILTER* filterDestroy (FILTER* pFilter);
+
+//	cityindex: Prototype Declarations
+CITY_INDEX* cityIndexCreate (void);
+void cityIndexAdd (CITY_INDEX* pIndex, DATA* pData);
+void cityIndexRemove (CITY_INDEX* pIndex, DATA* pData);
+int citySearch (CITY_INDEX* pIndex, const char* name, CITY_MATCH mode,
+                DATA** results, int maxResults);
+CITY_INDEX* cityIndexDestroy (CITY_INDEX* pIndex);
+
+//	column: Prototype Declarations
+COLUMNS* columnCreate (void);
+void columnAdd (COLUMNS* pColumns, DATA* pData);
+void columnRemove (COLUMNS* pColumns, DATA* pData);
+void columnUpdate (COLUMNS* pColumns, DATA* pData);
+int columnScan (COLUMNS* pColumns, PREDICATE* predicates, int countPredicates, int* rows);
+COLUMNS* columnDestroy (COLUMNS* pColumns);
+
+//	shard: Prototype Declarations
+SHARDS* shardCreate (int countShards, int countRecords);
+int shardOf (SHARDS* pShards, DATA* pData);
+bool shardInsert (SHARDS* pShards, DATA* pData);
+bool shardRemove (SHARDS* pShards, DATA* pData);
+DATA* shardFind (SHARDS* pShards, DATA* target);
+int shardCount (HEAD* pHeader);
+HASH* shardTable (HEAD* pHeader, int shard);
+SHARDS* shardDestroy (SHARDS* pShards);
+
+//	asyncfile: Prototype Declarations
+ASYNC_FILE* asyncOpen (const char* fileName, bool write);
+bool asyncLine (ASYNC_FILE* pFile, char* line, int size);
+void asyncWrite (ASYNC_FILE* pFile, const char* text, int length);
+bool asyncClose (ASYNC_FILE* pFile);
+
+//	ingest: Prototype Declarations
+INGEST_POLICY ingestPolicy (const char* option);
+HEAD* ingestHead (HEAD* pHeader, char** files, int countFiles, INGEST_POLICY policy);
+HEAD* ingestReload (HEAD* pHeader);
+
+//	delta: Prototype Declarations
+bool applyDelta (HEAD* pHeader, const char* fileName);
+bool syncFile (HEAD* pHeader, const char* fileName);
+
+//	watch: Prototype Declarations
+bool watchStart (const char* fileName);
+void watchStop (void);
+bool watchActive (void);
+const char* watchFile (void);
+bool watchChanged (void);
+
+//	latency: Prototype Declarations
+unsigned long long latencyStart (void);
+void latencyRecord (LAT_OP op, unsigned long long start);
+void latencyReport (void);
+bool latencyDump (const char* fileName);
+const char* latencyName (LAT_OP op);
+unsigned long long latencyClock (void);
+
+//	profile: Prototype Declarations
+int profileStart (void);
+void profileStop (void);
+bool profileActive (void);
+void profileEnter (void);
+void profileLeave (LAT_OP op);
+void profileReport (void);
+
+//	trace: Prototype Declarations
+bool traceStart (const char* fileName);
+int traceStop (void);
+bool traceActive (void);
+void traceRecord (char op, DATA* pData);
+bool traceReplay (HEAD* pHeader, const char* fileName);
+
+//	frozen: Prototype Declarations
+FROZEN* frozenBuild (FROZEN* pFrozen, BST_TREE* tree);
+bool frozenFresh (FROZEN* pFrozen, BST_TREE* tree);
+DATA* frozenRetrieve (HEAD* pHeader, unsigned key);
+DATA* frozenFind (FROZEN* pFrozen, unsigned key);
+int frozenRank (FROZEN* pFrozen, unsigned key);
+void frozenAdd (FROZEN* pFrozen, BST_TREE* tree, DATA* pData);
+void frozenRemove (FROZEN* pFrozen, BST_TREE* tree, DATA* pData);
+int frozenRange (FROZEN* pFrozen, unsigned low, unsigned high, void (*process) (void* dataPtr));
+void frozenTraverse (FROZEN* pFrozen, void (*process) (void* dataPtr));
+FROZEN* frozenDestroy (FROZEN* pFrozen);
+
+//	disk: Prototype Declarations
+DISK* diskOpen (const char* fileName, int budget);
+DISK* diskClose (DISK* pDisk);
+bool diskFind (DISK* pDisk, unsigned key, DISK_AIRPORT* pAirport);
+bool diskInsert (DISK* pDisk, DISK_AIRPORT* pAirport);
+bool diskDelete (DISK* pDisk, unsigned key);
+int diskRange (DISK* pDisk, unsigned low, unsigned high, void (*process) (void* dataPtr));
+int diskImport (DISK* pDisk, const char* fileName);
+bool diskExport (DISK* pDisk, const char* fileName);
+void diskReport (DISK* pDisk);
+
+//	query: Prototype Declarations
+bool queryParse (const char* text, QUERY* pQuery);
+bool queryPlan (HEAD* pHeader, QUERY* pQuery);
+void queryExplain (QUERY* pQuery);
+int queryRun (HEAD* pHeader, QUERY* pQuery);
+
+//	export: Prototype Declarations
+bool exportSorted (HEAD* pHeader, const char* fileName);
 
 //	BST: Prototype Declarations for public functions
-BST_TREE* BST_Create (int (*compare) (void* argu1, void* argu2));
+BST_TREE* BST_Create (void);
 BST_TREE* BST_Destroy (BST_TREE* tree);
 
 bool  BST_Insert   (BST_TREE* tree, void* dataPtr);
+bool  BST_Build    (BST_TREE* tree, void** dataPtrs, int count);
 bool  BST_Delete   (BST_TREE* tree, void* dltKey);
 void* BST_Retrieve (BST_TREE* tree, void* keyPtr);
 void  BST_Traverse (BST_TREE* tree,
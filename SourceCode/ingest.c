@@ -0,0 +1,379 @@
+/* ingest.c
+ This file contains the definitons of the functions that load
+ the database from several data files at once. The files may
+ repeat or contradict each other. Each one is parsed and sorted
+ by code on its own thread, then the sorted files are merged
+ (k-way, through a heap) into one stream with a single record
+ per code, chosen by the conflict policy (lines that are not a
+ whole record are skipped and counted):
+
+ INGEST_FIRST    the record of the first file listed wins
+ INGEST_LAST     the record of the last file listed wins
+ INGEST_NEWEST   the coordinates come from the file changed
+                 last, the rest from the first file
+
+ The stream is already in key order and free of duplicates, so
+ the tree is linked balanced in one pass (BST_Build) and the
+ other structures are filled without searching for duplicates.
+
+ Functions:
+ ingestPolicy
+ ingestHead
+ ingestReload
+
+ Private Functions:
+ _parseSource
+ _compareRows
+ _rowBefore
+ _heapDown
+ */
+
+#include "header.h"
+#include <sys/stat.h>
+#include <time.h>
+#ifndef _MSC_VER
+#include <pthread.h>
+#endif
+
+#define INGEST_ROWS_START  256
+
+//	One line of a file, parsed but not yet stored
+typedef struct{
+    unsigned key;           // CODE_KEY of the code
+    int      line;          // position in the file
+    char     arpCode[4];
+    char     city[20];
+    float    latitude;
+    float    longitude;
+}INGEST_ROW;
+
+//	One input file
+typedef struct{
+    const char* fileName;
+    INGEST_ROW* rows;       // sorted by key, then line
+    int         countRows;
+    int         countRejected;  // lines that are not a whole record
+    int         capacity;
+    int         next;       // next row to merge
+    time_t      modified;
+}INGEST_SOURCE;
+
+static char** ingestFiles;  // sources of the last ingest, for reload
+static int ingestCount;
+static INGEST_POLICY ingestMode;
+
+static void* _parseSource (void* pSource);
+static int _compareRows (const void* row1, const void* row2);
+static bool _rowBefore (INGEST_SOURCE* sources, int source1, int source2);
+static void _heapDown (INGEST_SOURCE* sources, int* heap, int countHeap, int i);
+
+/*	================== ingestPolicy =================
+ This function reads the conflict policy option of the
+ command line.
+ Pre		option - "-first", "-last" or "-newest"
+ Post		exits with the usage on a wrong option
+ Return	the policy
+ */
+INGEST_POLICY ingestPolicy (const char* option)
+{
+	//	Statements
+    if (strcmp(option, "-first") == 0)
+        return INGEST_FIRST;
+    if (strcmp(option, "-last") == 0)
+        return INGEST_LAST;
+    if (strcmp(option, "-newest") == 0)
+        return INGEST_NEWEST;
+
+    printf("Usage: airports [-first | -last | -newest] file ...\n");
+    printf("       airports -disk[=KB] database [file ...]\n");
+    exit(180);
+}	// ingestPolicy
+
+
+/*	================== ingestHead =================
+ This function loads the database from several files,
+ keeping one record per code.
+ Pre		pHeader - pointer to HEAD structure emptied
+ by clearHead, or NULL to allocate a new one
+ files - names of the files
+ countFiles - number of files
+ policy - which record wins a conflict
+ Post		database holds the merged records
+ Return	pointer to the HEAD structure
+ */
+HEAD* ingestHead (HEAD* pHeader, char** files, int countFiles, INGEST_POLICY policy)
+{
+	//	Local Declarations
+    INGEST_SOURCE* sources;
+    INGEST_ROW* pRow;
+    INGEST_ROW* pFirst;
+    INGEST_ROW* pLast = NULL;
+    INGEST_ROW* pNewest;
+    INGEST_ROW* pWinner;
+    DATA** merged;
+    DATA* pData;
+    BST_TREE* pTree;
+    struct stat info;
+    time_t newest = 0;
+    unsigned key;
+    int* heap;
+    int countHeap = 0;
+    int countRows = 0;
+    int countRejected = 0;
+    int countMerged = 0;
+    int source;
+    int i;
+#ifndef _MSC_VER
+    pthread_t* threads;
+    bool* started;
+#endif
+    unsigned long long start = latencyStart();
+
+	//	Statements
+    ingestFiles = files;
+    ingestCount = countFiles;
+    ingestMode = policy;
+
+    if (!(sources = (INGEST_SOURCE*) memCalloc(MEM_INDEX, countFiles, sizeof(INGEST_SOURCE))) ||
+        !(heap = (int*) memAlloc(MEM_INDEX, countFiles * sizeof(int)))) {
+        printf("Memory allocation error\n");
+        exit(100);
+    }
+    for (i = 0; i < countFiles; i++)
+    {
+        sources[i].fileName = files[i];
+        if (stat(files[i], &info) != 0) {
+            printf("Error opening input file %s\n", files[i]);
+            exit(181);
+        }
+        sources[i].modified = info.st_mtime;
+    }
+
+    // every file is parsed and sorted on its own thread
+#ifndef _MSC_VER
+    threads = (pthread_t*) malloc(countFiles * sizeof(pthread_t));
+    started = (bool*) calloc(countFiles, sizeof(bool));
+    if (!threads || !started) {
+        printf("Memory allocation error\n");
+        exit(100);
+    }
+    for (i = 1; i < countFiles; i++)
+        started[i] = pthread_create(&threads[i], NULL, _parseSource, &sources[i]) == 0;
+    for (i = 0; i < countFiles; i++)
+        if (!started[i])
+            _parseSource(&sources[i]);
+    for (i = 1; i < countFiles; i++)
+        if (started[i])
+            pthread_join(threads[i], NULL);
+    free(threads);
+    free(started);
+#else
+    for (i = 0; i < countFiles; i++)
+        _parseSource(&sources[i]);
+#endif
+
+    for (i = 0; i < countFiles; i++)
+    {
+        countRows += sources[i].countRows;
+        countRejected += sources[i].countRejected;
+        if (sources[i].countRows > 0)
+            heap[countHeap++] = i;
+    }
+    if (!(merged = (DATA**) memAlloc(MEM_INDEX, (countRows + 1) * sizeof(DATA*)))) {
+        printf("Memory allocation error\n");
+        exit(100);
+    }
+    for (i = countHeap / 2 - 1; i >= 0; i--)
+        _heapDown(sources, heap, countHeap, i);
+
+    // k-way merge: the rows of one code come out in file order
+    while (countHeap > 0)
+    {
+        source = heap[0];
+        key = sources[source].rows[sources[source].next].key;
+        pFirst = pNewest = NULL;
+        while (countHeap > 0 && sources[heap[0]].rows[sources[heap[0]].next].key == key)
+        {
+            source = heap[0];
+            pRow = &sources[source].rows[sources[source].next++];
+            if (!pFirst)
+                pFirst = pRow;
+            pLast = pRow;
+            if (!pNewest || sources[source].modified >= newest) {
+                pNewest = pRow;
+                newest = sources[source].modified;
+            }
+            if (sources[source].next == sources[source].countRows)
+                heap[0] = heap[--countHeap];
+            _heapDown(sources, heap, countHeap, 0);
+        }
+
+        pWinner = policy == INGEST_LAST ? pLast : pFirst;
+        if (!(pData = recordAlloc())) {
+            printf("Could not alloc memory for airport.");
+            exit(800);
+        }
+        strcpy(pData->arpCode, pWinner->arpCode);
+        pData->city = cityIntern(pWinner->city);
+        if (policy == INGEST_NEWEST)
+            pWinner = pNewest;
+        pData->latitude = pWinner->latitude;
+        pData->longitude = pWinner->longitude;
+        merged[countMerged++] = pData;
+    }
+
+    // the tree is left out of insertRecord and built in bulk
+    // from the merged stream, which is already in key order
+    pHeader = createHead(pHeader, countMerged);
+    pTree = pHeader->pTree;
+    pHeader->pTree = NULL;
+    for (i = 0; i < countMerged; i++)
+        insertRecord(pHeader, merged[i]);
+    pHeader->pTree = pTree;
+    if (!BST_Build(pHeader->pTree, (void**) merged, countMerged)) {
+        printf("Memory allocation error\n");
+        exit(100);
+    }
+    if (countFiles > 1)
+        printf("Merged %d lines from %d files into %d airports (%d duplicates).\n",
+               countRows, countFiles, countMerged, countRows - countMerged);
+    if (countRejected > 0)
+        printf("Skipped %d lines that are not whole records.\n", countRejected);
+
+    for (i = 0; i < countFiles; i++)
+        memFree(MEM_INDEX, sources[i].rows, sources[i].capacity * sizeof(INGEST_ROW));
+    memFree(MEM_INDEX, merged, (countRows + 1) * sizeof(DATA*));
+    memFree(MEM_INDEX, heap, countFiles * sizeof(int));
+    memFree(MEM_INDEX, sources, countFiles * sizeof(INGEST_SOURCE));
+    latencyRecord(LAT_BUILD, start);
+    return pHeader;
+}	// ingestHead
+
+
+/*	================== ingestReload =================
+ This function loads the database again from the same
+ files as the last ingest, or from data.txt when the
+ program was not started with files.
+ Pre		pHeader - pointer to HEAD structure emptied
+ by clearHead
+ Post		database is loaded
+ Return	pointer to the HEAD structure
+ */
+HEAD* ingestReload (HEAD* pHeader)
+{
+	//	Statements
+    if (ingestCount > 0)
+        return ingestHead(pHeader, ingestFiles, ingestCount, ingestMode);
+    return buildHead(pHeader, "data.txt");
+}	// ingestReload
+
+
+/*	================== _parseSource =================
+ Reads every line of one file into its rows and sorts
+ them by code. Runs on a thread of its own, so it only
+ touches its own INGEST_SOURCE.
+ */
+static void* _parseSource (void* pSource)
+{
+	//	Local Declarations
+    INGEST_SOURCE* pS = (INGEST_SOURCE*) pSource;
+    INGEST_ROW* pRow;
+    INGEST_ROW* newRows;
+    ASYNC_FILE* fpIn;
+    char line[128];
+    int newCapacity;
+    int parsed;
+
+	//	Statements
+    if (!(fpIn = asyncOpen(pS->fileName, false))) {
+        printf("Error opening input file %s\n", pS->fileName);
+        exit(181);
+    }
+    while (asyncLine(fpIn, line, sizeof(line)))
+    {
+        if (pS->countRows == pS->capacity)
+        {
+            newCapacity = pS->capacity ? pS->capacity * 2 : INGEST_ROWS_START;
+            if (!(newRows = (INGEST_ROW*) memAlloc(MEM_INDEX, newCapacity * sizeof(INGEST_ROW)))) {
+                printf("Memory allocation error\n");
+                exit(100);
+            }
+            if (pS->rows)
+                memcpy(newRows, pS->rows, pS->countRows * sizeof(INGEST_ROW));
+            memFree(MEM_INDEX, pS->rows, pS->capacity * sizeof(INGEST_ROW));
+            pS->rows = newRows;
+            pS->capacity = newCapacity;
+        }
+        pRow = &pS->rows[pS->countRows];
+        parsed = parseLine(line, pRow->arpCode, pRow->city, &pRow->latitude, &pRow->longitude);
+        if (parsed > 0)
+        {
+            pRow->key = CODE_KEY(pRow->arpCode);
+            pRow->line = pS->countRows++;
+        }
+        else if (parsed < 0)
+            pS->countRejected++;
+    }
+    asyncClose(fpIn);
+
+    qsort(pS->rows, pS->countRows, sizeof(INGEST_ROW), _compareRows);
+    return NULL;
+}	// _parseSource
+
+
+/*	================== _compareRows =================
+ qsort order of the rows of one file: by code, then
+ by line, so repeated codes keep their file order.
+ */
+static int _compareRows (const void* row1, const void* row2)
+{
+	//	Local Declarations
+    const INGEST_ROW* pRow1 = (const INGEST_ROW*) row1;
+    const INGEST_ROW* pRow2 = (const INGEST_ROW*) row2;
+
+	//	Statements
+    if (pRow1->key != pRow2->key)
+        return pRow1->key < pRow2->key ? -1 : 1;
+    return pRow1->line - pRow2->line;
+}	// _compareRows
+
+
+/*	================== _rowBefore =================
+ Merge order of the next rows of two files: by code,
+ then by the position of the file in the list.
+ */
+static bool _rowBefore (INGEST_SOURCE* sources, int source1, int source2)
+{
+	//	Local Declarations
+    unsigned key1 = sources[source1].rows[sources[source1].next].key;
+    unsigned key2 = sources[source2].rows[sources[source2].next].key;
+
+	//	Statements
+    return key1 < key2 || (key1 == key2 && source1 < source2);
+}	// _rowBefore
+
+
+/*	================== _heapDown =================
+ Moves heap[i] down until both of its children come
+ after it in merge order.
+ */
+static void _heapDown (INGEST_SOURCE* sources, int* heap, int countHeap, int i)
+{
+	//	Local Declarations
+    int child;
+    int temp;
+
+	//	Statements
+    while ((child = 2 * i + 1) < countHeap)
+    {
+        if (child + 1 < countHeap && _rowBefore(sources, heap[child + 1], heap[child]))
+            child++;
+        if (!_rowBefore(sources, heap[child], heap[i]))
+            break;
+        temp = heap[i];
+        heap[i] = heap[child];
+        heap[child] = temp;
+        i = child;
+    }
+    return;
+}	// _heapDown
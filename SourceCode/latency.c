@@ -0,0 +1,306 @@
+/* latency.c
+ This file contains the definitons of the functions that time
+ the operations on the database. Every timed call adds its
+ duration, in nanoseconds, to the histogram of its operation.
+ The buckets are logarithmic with a few linear steps inside
+ each power of two (like an HDR histogram), so durations from
+ a few nanoseconds to several minutes are kept within about
+ 6% with a fixed, small table and no allocation:
+
+ 0 - 31 ns       one bucket per nanosecond
+ 32 - 63 ns      one bucket per 2 ns
+ 64 - 127 ns     one bucket per 4 ns, and so on
+
+ Recording costs two reads of the monotonic clock and a few
+ additions, so it is always on unless USE_LATENCY is false.
+
+ Functions:
+ latencyStart
+ latencyRecord
+ latencyReport
+ latencyDump
+ latencyName
+ latencyClock
+
+ Private Functions:
+ _bucketOf
+ _bucketValue
+ _percentile
+ */
+
+#include "header.h"
+#ifdef _MSC_VER
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define LAT_SUB_BITS     4
+#define LAT_SUB_BUCKETS  (1 << LAT_SUB_BITS)   // linear steps per power of two
+#define LAT_BUCKETS      (64 * LAT_SUB_BUCKETS)
+
+// The operations of a sharded table may be timed by several
+// threads at once, so the counters are updated atomically
+// where the compiler can.
+#ifdef __GNUC__
+#define LAT_ADD(counter, value)  ((void) __sync_fetch_and_add(&(counter), (value)))
+#else
+#define LAT_ADD(counter, value)  ((counter) += (value))
+#endif
+
+static unsigned long long latCounts[LAT_OPS][LAT_BUCKETS];
+static unsigned long long latTotal[LAT_OPS];
+static unsigned long long latMax[LAT_OPS];
+
+static const char* latNames[LAT_OPS] = {
+    "Find", "Insert", "Delete", "Resize",
+    "Tree insert", "Tree delete", "Tree search", "Write file", "Build"
+};
+
+static int _bucketOf (unsigned long long value);
+static unsigned long long _bucketValue (int bucket);
+static unsigned long long _percentile (LAT_OP op, double percent);
+
+/*	================== latencyStart =================
+ This function reads the clock at the start of a timed
+ operation.
+ Pre
+ Post
+ Return	start time to give to latencyRecord
+ */
+unsigned long long latencyStart (void)
+{
+	//	Statements
+    if (profileActive())
+        profileEnter();
+    if (!USE_LATENCY)
+        return 0;
+    return latencyClock();
+}	// latencyStart
+
+
+/*	================== latencyRecord =================
+ This function adds the time since the start of an
+ operation to its histogram.
+ Pre		op - operation timed
+ start - value returned by latencyStart
+ Post		histogram of op is updated
+ Return
+ */
+void latencyRecord (LAT_OP op, unsigned long long start)
+{
+	//	Local Declarations
+    unsigned long long elapsed;
+    unsigned long long max;
+
+	//	Statements
+    if (!USE_LATENCY)
+    {
+        if (profileActive())
+            profileLeave(op);
+        return;
+    }
+    elapsed = latencyClock() - start;
+    LAT_ADD(latCounts[op][_bucketOf(elapsed)], 1);
+    LAT_ADD(latTotal[op], elapsed);
+#ifdef __GNUC__
+    while (elapsed > (max = latMax[op]) &&
+           !__sync_bool_compare_and_swap(&latMax[op], max, elapsed))
+        ;
+#else
+    max = latMax[op];
+    if (elapsed > max)
+        latMax[op] = elapsed;
+#endif
+    if (profileActive())
+        profileLeave(op);
+    return;
+}	// latencyRecord
+
+
+/*	================== latencyReport =================
+ This function prints the number of calls and the
+ median, 90th and 99th percentile and longest time of
+ every operation timed so far.
+ Pre
+ Post		prints one line per operation
+ Return
+ */
+void latencyReport (void)
+{
+	//	Local Declarations
+    unsigned long long count;
+    int op;
+    int b;
+
+	//	Statements
+    printf("\nOperation        Calls  p50 (us)  p90 (us)  p99 (us)  max (us)\n");
+    for (op = 0; op < LAT_OPS; op++)
+    {
+        count = 0;
+        for (b = 0; b < LAT_BUCKETS; b++)
+            count += latCounts[op][b];
+        if (count == 0)
+            continue;
+        printf("%-12s %9llu %9.2f %9.2f %9.2f %9.2f\n", latNames[op], count,
+               _percentile((LAT_OP) op, 50) / 1000.0, _percentile((LAT_OP) op, 90) / 1000.0,
+               _percentile((LAT_OP) op, 99) / 1000.0, latMax[op] / 1000.0);
+    }
+    printf("\n");
+    return;
+}	// latencyReport
+
+
+/*	================== latencyDump =================
+ This function writes the whole histogram of every
+ operation to a file: one line per bucket in use, with
+ the highest time of the bucket in nanoseconds, the
+ number of calls in it and the fraction of the calls
+ taking at most that long.
+ Pre		fileName - name of the file to write
+ Post		file is written
+ Return	true if success
+ false if the file could not be written
+ */
+bool latencyDump (const char* fileName)
+{
+	//	Local Declarations
+    FILE* fpOut;
+    unsigned long long count;
+    unsigned long long seen;
+    int op;
+    int b;
+
+	//	Statements
+    if (!(fpOut = fopen(fileName, "w")))
+        return false;
+
+    for (op = 0; op < LAT_OPS; op++)
+    {
+        count = 0;
+        for (b = 0; b < LAT_BUCKETS; b++)
+            count += latCounts[op][b];
+        fprintf(fpOut, "# %s: %llu calls, %llu ns in total, %llu ns at most\n",
+                latNames[op], count, latTotal[op], latMax[op]);
+        fprintf(fpOut, "# value (ns)\tcount\tpercentile\n");
+        seen = 0;
+        for (b = 0; b < LAT_BUCKETS; b++)
+        {
+            if (latCounts[op][b] == 0)
+                continue;
+            seen += latCounts[op][b];
+            fprintf(fpOut, "%llu\t%llu\t%.6f\n",
+                    _bucketValue(b), latCounts[op][b], (double) seen / count);
+        }
+        fprintf(fpOut, "\n");
+    }
+    return fclose(fpOut) == 0;
+}	// latencyDump
+
+
+/*	================== latencyName =================
+ This function returns the name of an operation.
+ Pre		op - operation
+ Post
+ Return	name for the reports
+ */
+const char* latencyName (LAT_OP op)
+{
+	//	Statements
+    return latNames[op];
+}	// latencyName
+
+
+/*	================== latencyClock =================
+ This function reads the monotonic clock.
+ Pre
+ Post
+ Return	time in nanoseconds
+ */
+unsigned long long latencyClock (void)
+{
+	//	Local Declarations
+#ifdef _MSC_VER
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER now;
+#else
+    struct timespec now;
+#endif
+
+	//	Statements
+#ifdef _MSC_VER
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&now);
+    return (unsigned long long) (now.QuadPart * (1000000000.0 / frequency.QuadPart));
+#else
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long) now.tv_sec * 1000000000u + now.tv_nsec;
+#endif
+}	// latencyClock
+
+
+/*	================== _bucketOf =================
+ Finds the bucket of a duration: the power of two
+ of the duration picks the group of buckets, and the
+ next LAT_SUB_BITS bits the bucket inside it.
+ */
+static int _bucketOf (unsigned long long value)
+{
+	//	Local Declarations
+    int shift = 0;
+
+	//	Statements
+#ifdef __GNUC__
+    if (value >= 2 * LAT_SUB_BUCKETS)
+        shift = 63 - __builtin_clzll(value) - LAT_SUB_BITS;
+#else
+    while ((value >> shift) >= 2 * LAT_SUB_BUCKETS)
+        shift++;
+#endif
+    return shift * LAT_SUB_BUCKETS + (int) (value >> shift);
+}	// _bucketOf
+
+
+/*	================== _bucketValue =================
+ Returns the highest duration counted in a bucket.
+ */
+static unsigned long long _bucketValue (int bucket)
+{
+	//	Local Declarations
+    int shift;
+
+	//	Statements
+    if (bucket < 2 * LAT_SUB_BUCKETS)
+        return bucket;
+    shift = bucket / LAT_SUB_BUCKETS - 1;
+    return (((unsigned long long) (bucket - shift * LAT_SUB_BUCKETS) + 1) << shift) - 1;
+}	// _bucketValue
+
+
+/*	================== _percentile =================
+ Returns the duration that the given percentage of
+ the calls of an operation did not exceed.
+ */
+static unsigned long long _percentile (LAT_OP op, double percent)
+{
+	//	Local Declarations
+    unsigned long long count = 0;
+    unsigned long long seen = 0;
+    unsigned long long value;
+    int b;
+
+	//	Statements
+    for (b = 0; b < LAT_BUCKETS; b++)
+        count += latCounts[op][b];
+    for (b = 0; b < LAT_BUCKETS; b++)
+    {
+        seen += latCounts[op][b];
+        if (latCounts[op][b] && seen >= count * percent / 100)
+        {
+            value = _bucketValue(b);
+            return value < latMax[op] ? value : latMax[op];
+        }
+    }
+    return 0;
+}	// _percentile
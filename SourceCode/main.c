@@ -28,17 +28,46 @@
 
 
 
-int main (void)
+#ifndef EMBED_TOOL
+int main (int argc, char* argv[])
 {
 	//	Local Declarations
     HEAD* pHeader = NULL;
+    DISK* pDisk;
+    INGEST_POLICY policy = INGEST_FIRST;
+    int first = 1;
     
 	//	Statements
-    pHeader = buildHead(pHeader, "data.txt");
+    if (argc > 2 && strncmp(argv[1], "-disk", 5) == 0 && (argv[1][5] == '\0' || argv[1][5] == '=')) {
+        if (!(pDisk = diskOpen(argv[2], argv[1][5] ? atoi(argv[1] + 6) : DISK_BUDGET)))
+            exit(105);
+        for (first = 3; first < argc; first++)
+            if (diskImport(pDisk, argv[first]) < 0)
+                printf("Error opening %s\n", argv[first]);
+        getDiskOption(pDisk);
+        printf ("\nSaving data ... \n");
+        pDisk = diskClose(pDisk);
+        cityPoolDestroy();
+        return 0;
+    }
+    if (argc > 1 && argv[1][0] == '-') {
+        policy = ingestPolicy(argv[1]);
+        first = 2;
+    }
+    if (argc > first)
+        pHeader = ingestHead(pHeader, argv + first, argc - first, policy);
+    else
+#ifdef EMBEDDED_DATA
+        pHeader = buildEmbedded();
+#else
+        pHeader = buildHead(pHeader, "data.txt");
+#endif
     getOption(pHeader);
+    traceStop();
+    watchStop();
     
 	printf ("\nSaving data ... \n");
-	if (outputFile(pHeader->pHash))
+	if (outputFile(pHeader))
 		printf ("Successfully saved\n");
 	else
 		printf ("Could not save to file.\n");
@@ -50,27 +79,7 @@ int main (void)
 #endif
     return 0;
 }	// main
-
-
-/*	================== compareCode =================
- This function accepts two void pointers and casts
- them to DATA structure pointers, to compare the two
- keys of the data.
- Pre		airport1 is a void pointer to DATA
- airport2 is a void pointer to DATA
- Post
- Return	0 : if airport1 = airport2
- -1 : if airport1 < airport2
- 1: if airport1 > airport2
- */
-int  compareCode (void* airport1, void* airport2)
-{
-    
-	DATA station1 = *((DATA*)airport1);
-    DATA station2 = *((DATA*)airport2);
-    
-    return strcmp(station1.arpCode, station2.arpCode);
-}	// compareCode
+#endif
 
 
 /*	================== buildHead =================
@@ -78,7 +87,8 @@ int  compareCode (void* airport1, void* airport2)
  contains pointers to the tree and the hash table.
  It also calls other functions to read in the data
  file.
- Pre		pHeader - pointer to HEAD structure
+ Pre		pHeader - pointer to HEAD structure emptied
+ by clearHead, or NULL to allocate a new one
  fileInput - name of the file
  Post		both the tree and the hash table are
  created.
@@ -88,37 +98,69 @@ HEAD* buildHead (HEAD* pHeader, char* fileInput)
 {
 	//	Local Declarations
 	DATA* newAirport;
-    FILE* fpIn;
+    ASYNC_FILE* fpIn;
+    unsigned long long start = latencyStart();
     
 	//	Statements
-    fpIn = fopen(fileInput, "r");
+    fpIn = asyncOpen(fileInput, false);
     if (!fpIn) {
         printf("Error opening input file\n");
         exit(101);
     }
     
-    if ((pHeader = (HEAD*) malloc(sizeof(HEAD))))
+    pHeader = createHead(pHeader, countLines(fileInput));
+    while (getData(pHeader->pTree, fpIn, &newAirport)) {
+        insertRecord(pHeader, newAirport);
+    }
+    asyncClose(fpIn);
+    
+    latencyRecord(LAT_BUILD, start);
+    return pHeader;
+}	// buildHead
+
+
+/*	================== createHead =================
+ This function creates the empty hash table (or
+ shards), tree and indexes of the database, sized
+ for the number of records about to be loaded.
+ Pre		pHeader - pointer to HEAD structure emptied
+ by clearHead, or NULL to allocate a new one
+ countRecords - number of records expected
+ Post		every structure is created, empty
+ Return	pointer to the HEAD structure
+ */
+HEAD* createHead (HEAD* pHeader, int countRecords)
+{
+	//	Local Declarations
+    int s;
+    
+	//	Statements
+    if (pHeader || (pHeader = (HEAD*) memAlloc(MEM_HEADER, sizeof(HEAD))))
     {
-        pHeader->pHash = buildHash(2 * countLines(fileInput));
-        pHeader->pTree = BST_Create(compareCode);
+        pHeader->pHash = USE_SHARDS ? NULL : buildHash(2 * countRecords);
+        pHeader->pShards = USE_SHARDS ? shardCreate(SHARD_COUNT, countRecords) : NULL;
+        pHeader->pTree = BST_Create();
+        pHeader->pCity = cityIndexCreate();
+        pHeader->pColumns = USE_COLUMNS ? columnCreate() : NULL;
+        pHeader->pFrozen = NULL;
+        if (USE_FILTER)
+            for (s = 0; s < shardCount(pHeader); s++)
+                shardTable(pHeader, s)->pFilter = filterCreate(countRecords / shardCount(pHeader));
     }
     else{
         printf("Memory allocation error\n");
         exit(100);
     }
     
-    while (getData(pHeader->pTree, fpIn, &newAirport)) {
-        BST_Insert(pHeader->pTree, newAirport);
-        insertHash(pHeader->pHash, newAirport);
-    }
-    
     return pHeader;
-}	// buildHead
+}	// createHead
 
 
 /*	================== getData =================
  This function reads in the data from the input
- file and stores it into a DATA structure.
+ file and stores it into a DATA structure. Blank
+ lines and lines that are not a whole record are
+ skipped.
  Pre		pTree - pointer to the tree
  fpIn - pointer to input file
  airport - pointer to another
@@ -127,33 +169,70 @@ HEAD* buildHead (HEAD* pHeader, char* fileInput)
  Return	true if success
  false if fails
  */
-bool getData (BST_TREE* pTree, FILE* fpIn, DATA** airport)
+bool getData (BST_TREE* pTree, ASYNC_FILE* fpIn, DATA** airport)
 {
 	//	Local Declarations
 	bool result = false;
+	char line[128];
 	char airCode[4];
 	char city[20];
+	float latitude;
+	float longitude;
     
 	//	Statements
-	fscanf (fpIn, "%s", airCode);
-	if (!feof(fpIn))
+	while (!result && asyncLine (fpIn, line, sizeof(line)))
 	{
+		if (parseLine (line, airCode, city, &latitude, &longitude) != 1)
+			continue;
 		result = true;
-		fscanf (fpIn, "	%[^;]s", city);
         
-		*airport = (DATA*) malloc(sizeof(DATA));
+		*airport = recordAlloc();
 		if (!(*airport))
 			printf ("Could not alloc memory for airport."), exit (800);
         
 		strcpy ((*airport)->arpCode, airCode);
-		(*airport)->city = (char*) malloc (strlen(city) + 1);
-		strcpy ((*airport)->city, city);
-		fscanf (fpIn, ";	%f%f", &(*airport)->latitude, &(*airport)->longitude);
+		(*airport)->city = cityIntern (city);
+		(*airport)->latitude = latitude;
+		(*airport)->longitude = longitude;
 	}
     return result;
 }	// getData
 
 
+/*	================== parseLine =================
+ This function splits one line of a data file:
+ code, city up to the ';', latitude and longitude.
+ A line is only taken whole: the code must be three
+ letters, and the city and both coordinates must be
+ there.
+ Pre		line - line read from the file
+ airCode - receives the code (4 chars)
+ city - receives the city (20 chars)
+ latitude, longitude - receive the coordinates
+ Post		airCode holds what was read of the code
+ Return	1 for a record
+ 0 for a blank line
+ -1 for a line that is not a record
+ */
+int parseLine (const char* line, char* airCode, char* city, float* latitude, float* longitude)
+{
+	//	Local Declarations
+	int length = 0;
+	int i;
+    
+	//	Statements
+	if (sscanf (line, " %3s%n", airCode, &length) != 1)
+		return 0;
+	for (i = 0; i < 3; i++)
+		if (!isalpha ((unsigned char) airCode[i]))
+			return -1;
+	if (!isspace ((unsigned char) line[length]) ||
+		sscanf (line + length, " %19[^;]; %f %f", city, latitude, longitude) != 3)
+		return -1;
+	return 1;
+}	// parseLine
+
+
 /*	================== countLines =================
  This function counts the number of elements that
  are in the input file.
@@ -166,18 +245,19 @@ int countLines (char* fileName)
 	//	Local Declarations
 	int count = 0;
 	char tempLine[128];
-    FILE* fpIn;
+    ASYNC_FILE* fpIn;
     
 	//	Statements
-    fpIn = fopen(fileName, "r");
+    fpIn = asyncOpen(fileName, false);
     if (!fpIn) {
         printf("Error opening input file\n");
         exit(104);
     }
     
-    while (fgets(tempLine, sizeof(tempLine)-1, fpIn)) {
+    while (asyncLine(fpIn, tempLine, sizeof(tempLine))) {
         count++;
     }
+    asyncClose(fpIn);
     
     return count;
 }	// countLines
@@ -197,16 +277,19 @@ void getOption (HEAD* pHeader)
     char command;
     DATA target;
     DATA* airport = NULL;
+    char fileName[128];
 	int i;
     
 	//	Statements
     while ((command = menu()) != 'Q') {
+        if (watchChanged())
+            syncFile(pHeader, watchFile());
         switch (command)
         {
             case 'A':
                 if (addAirport(pHeader))
                 {
-                    while (checkHash(pHeader->pHash) == 1) {
+                    while (pHeader->pHash && checkHash(pHeader->pHash) == 1) {
                         pHeader->pHash = upsizeHash(pHeader->pHash);
                     }
 					printf ("\n Succesfully added data.\n\n");
@@ -215,10 +298,12 @@ void getOption (HEAD* pHeader)
             case 'D':
                 printf("Enter the airport code: ");
                 scanf(" %s", target.arpCode);
+                if (traceActive())
+                    traceRecord('D', &target);
                 
 				if (deleteHash (pHeader, target))
                 {
-                    while (checkHash(pHeader->pHash) == -1) {
+                    while (pHeader->pHash && checkHash(pHeader->pHash) == -1) {
                         pHeader->pHash = downsizeHash(pHeader->pHash);
                     }
 					printf ("\n Succesfully deleted data.\n\n");
@@ -232,32 +317,129 @@ void getOption (HEAD* pHeader)
 				for (i = 0; i < strlen(target.arpCode); i++) {
 					target.arpCode[i] = toupper(target.arpCode[i]);
 				}
-                airport = findHash(pHeader->pHash, &target);
+                if (traceActive())
+                    traceRecord('F', &target);
+                if (pHeader->pShards)
+                    airport = shardFind(pHeader->pShards, &target);
+                else
+                    airport = findHash(pHeader->pHash, &target);
                 if (airport != NULL) {
                     processScreen(airport);
                 }
                 else printf("No airport exists\n");
                 
+                break;
+            case 'C':
+                findCity(pHeader);
+                break;
+            case 'S':
+                scanCoordinates(pHeader);
                 break;
             case 'L':
-                printHash(pHeader->pHash);
+                for (i = 0; i < shardCount(pHeader); i++) {
+                    if (pHeader->pShards)
+                        printf("Shard %d:\n", i);
+                    printHash(shardTable(pHeader, i));
+                }
                 break;
             case 'K':
-                BST_Traverse(pHeader->pTree, processScreen);
+                pHeader->pFrozen = frozenBuild(pHeader->pFrozen, pHeader->pTree);
+                frozenTraverse(pHeader->pFrozen, processScreen);
+                break;
+            case 'G':
+                listRange(pHeader);
+                break;
+            case 'V':
+                runQuery(pHeader);
                 break;
             case 'P':
-                printTree(pHeader->pTree->root, 0);
+                printTree(pHeader->pTree, pHeader->pTree->root, 0);
 				printf("\n");
                 break;
             case 'W':
-				outputFile (pHeader->pHash);
+				outputFile (pHeader);
+                break;
+            case 'J':
+                printf("Enter the name of the output file: ");
+                scanf(" %127[^\n]", fileName);
+                if (exportSorted(pHeader, fileName))
+                    printf("\n Saved %d airports in key sequence.\n\n", BST_Count(pHeader->pTree));
+                else
+                    printf("Error writing %s\n", fileName);
                 break;
             case 'E':
-				efficiency(pHeader->pHash);
+				efficiency(pHeader);
+				memoryReport(pHeader);
+				latencyReport();
+				profileReport();
+                break;
+            case 'X':
+                if (profileActive()) {
+                    profileStop();
+                    printf("\n Profiling stopped.\n\n");
+                }
+                else
+                    printf("\n Profiling started with %d hardware counters.\n\n", profileStart());
+                break;
+            case 'T':
+                printf("Enter the name of the timing file: ");
+                scanf(" %127[^\n]", fileName);
+                if (latencyDump(fileName))
+                    printf("\n Saved the timing histograms.\n\n");
+                else
+                    printf("Error writing %s\n", fileName);
                 break;
 			case 'H':
-				pHeader->pHash = hashDemo(pHeader->pHash);
+				if (pHeader->pShards)
+					printf("The shards resize themselves.\n");
+				else
+					pHeader->pHash = hashDemo(pHeader->pHash);
 				break;
+            case 'U':
+                printf("Enter the name of the change file: ");
+                scanf(" %127[^\n]", fileName);
+                applyDelta(pHeader, fileName);
+                break;
+            case 'O':
+                if (traceActive()) {
+                    if ((i = traceStop()) >= 0)
+                        printf("\n Recorded %d operations.\n\n", i);
+                    else
+                        printf("Could not write the whole trace.\n");
+                }
+                else {
+                    printf("Enter the name of the trace file: ");
+                    scanf(" %127[^\n]", fileName);
+                    if (traceStart(fileName))
+                        printf("\n Recording to %s.\n\n", fileName);
+                    else
+                        printf("Error creating %s\n", fileName);
+                }
+                break;
+            case 'Y':
+                printf("Enter the name of the trace file: ");
+                scanf(" %127[^\n]", fileName);
+                traceReplay(pHeader, fileName);
+                break;
+            case 'N':
+                if (watchActive()) {
+                    watchStop();
+                    printf("\n Stopped watching.\n\n");
+                }
+                else {
+                    printf("Enter the name of the file to watch: ");
+                    scanf(" %127[^\n]", fileName);
+                    if (watchStart(fileName))
+                        printf("\n Watching %s: its changes are applied before each command.\n\n", fileName);
+                    else
+                        printf("Error opening %s\n", fileName);
+                }
+                break;
+            case 'R':
+                clearHead(pHeader);
+                ingestReload(pHeader);
+                printf("\n Reloaded %d airports.\n\n", BST_Count(pHeader->pTree));
+                break;
             default:
                 printf("Invalid choice. Choose again\n");
                 break;
@@ -267,6 +449,115 @@ void getOption (HEAD* pHeader)
 }	// getOption
 
 
+/*	================== getDiskOption =================
+ This function reads in the user's operations on a
+ disk database and performs them.
+ Pre		pDisk - pointer to the disk database
+ Post
+ Return
+ */
+void getDiskOption (DISK* pDisk)
+{
+	//	Local Declarations
+    char command;
+    char low[4];
+    char high[4];
+    char fileName[128];
+    DISK_AIRPORT airport;
+    int count;
+    int i;
+    
+	//	Statements
+    while ((command = diskMenu()) != 'Q') {
+        switch (command)
+        {
+            case 'A':
+                printf("Enter airport code: ");
+                scanf(" %3s", airport.arpCode);
+                for (i = 0; airport.arpCode[i]; i++)
+                    airport.arpCode[i] = toupper(airport.arpCode[i]);
+                if (strlen(airport.arpCode) != 3)
+                    printf("Your airport code has to have 3 characters\n");
+                else if (diskFind(pDisk, CODE_KEY(airport.arpCode), &airport))
+                    printf("This airport already exists\n");
+                else {
+                    printf("Enter airport city: ");
+                    scanf(" %19[^\n]", airport.city);
+                    printf("Enter airport latitude and longitude: ");
+                    while (scanf("%f %f", &airport.latitude, &airport.longitude) != 2)
+                    {
+                        printf("Invalid input, please try entering the coordinates again: ");
+                        while(getchar() != '\n');
+                    }
+                    diskInsert(pDisk, &airport);
+                    printf ("\n Succesfully added data.\n\n");
+                }
+                break;
+            case 'D':
+                printf("Enter the airport code: ");
+                scanf(" %3s", low);
+                for (i = 0; low[i]; i++)
+                    low[i] = toupper(low[i]);
+                if (diskDelete(pDisk, CODE_KEY(low)))
+                    printf ("\n Succesfully deleted data.\n\n");
+                else
+                    printf("No airport exists\n");
+                break;
+            case 'F':
+                printf("Enter the airport code: ");
+                scanf(" %3s", low);
+                for (i = 0; low[i]; i++)
+                    low[i] = toupper(low[i]);
+                if (diskFind(pDisk, CODE_KEY(low), &airport))
+                    processDiskScreen(&airport);
+                else
+                    printf("No airport exists\n");
+                break;
+            case 'K':
+                diskRange(pDisk, 0, 0xFFFFFFu, processDiskScreen);
+                break;
+            case 'G':
+                printf("Enter the first and last airport codes: ");
+                while (scanf(" %3s %3s", low, high) != 2)
+                {
+                    printf("Invalid input, please try entering the codes again: ");
+                    while(getchar() != '\n');
+                }
+                for (i = 0; low[i]; i++)
+                    low[i] = toupper(low[i]);
+                for (i = 0; high[i]; i++)
+                    high[i] = toupper(high[i]);
+                count = diskRange(pDisk, CODE_KEY(low), CODE_KEY(high), processDiskScreen);
+                printf("%d airports found\n", count);
+                break;
+            case 'I':
+                printf("Enter the name of the data file: ");
+                scanf(" %127[^\n]", fileName);
+                if ((count = diskImport(pDisk, fileName)) >= 0)
+                    printf("\n Imported %d airports.\n\n", count);
+                else
+                    printf("Error opening %s\n", fileName);
+                break;
+            case 'W':
+                if (diskExport(pDisk, "outputFile.txt"))
+                    printf("\n Saved to outputFile.txt.\n\n");
+                else
+                    printf("Could not save to file.\n");
+                break;
+            case 'E':
+                diskReport(pDisk);
+                latencyReport();
+                break;
+            default:
+                printf("Invalid choice. Choose again\n");
+                break;
+        }
+    }
+    
+    return;
+}	// getDiskOption
+
+
 /*	================== addAirport =================
  This function adds another element of data into
  both the tree and hash table, through the user's
@@ -300,18 +591,20 @@ bool addAirport (HEAD* pHeader)
     }
     
     strcpy(tempAirport.arpCode, tempCode);
-    newAirport = findHash(pHeader->pHash, &tempAirport);
+    if (pHeader->pShards)
+        newAirport = shardFind(pHeader->pShards, &tempAirport);
+    else
+        newAirport = findHash(pHeader->pHash, &tempAirport);
     if (newAirport == NULL)
     {
-        if (!(newAirport = (DATA*) malloc(sizeof(DATA)))) {
+        if (!(newAirport = recordAlloc())) {
             printf("Error allocating new airport\n");
             exit(100);
         }
         strcpy(newAirport->arpCode, tempCode);
         printf("Enter airport city: ");
         scanf(" %[^\n]", tempName);
-        newAirport->city = (char*) calloc(strlen(tempName) + 1, sizeof(char));
-        strcpy(newAirport->city, tempName);
+        newAirport->city = cityIntern(tempName);
         
         printf("Enter airport latitude: ");
         while(!(scanf("%f", &newAirport->latitude)))
@@ -326,18 +619,206 @@ bool addAirport (HEAD* pHeader)
             while(getchar() != '\n');
         }
         
-        insertHash(pHeader->pHash, newAirport);
-        BST_Insert(pHeader->pTree, newAirport);
+        insertRecord(pHeader, newAirport);
         result = true;
     }
     else{
         printf("This airport already exists\n");
         processScreen(newAirport);
     }
+    if (traceActive())
+        traceRecord('A', newAirport);
     return result;
 }	// addAirport
 
 
+/*	================== findCity =================
+ This function reads a city name from the user and
+ prints the airports in that city. When no city has
+ that exact name, the cities starting with it are
+ listed, and then the cities with a similar name.
+ Pre		pHeader - pointer to HEAD structure
+ Post		matching airports are printed
+ Return
+ */
+void findCity (HEAD* pHeader)
+{
+	//	Local Declarations
+    DATA* results[MAX_CITY_RESULTS];
+    char name[128];
+    int count;
+    int i;
+    
+	//	Statements
+    printf("Enter the city name: ");
+    scanf(" %127[^\n]", name);
+    
+    if ((count = citySearch(pHeader->pCity, name, CITY_EXACT, results, MAX_CITY_RESULTS)) == 0 &&
+        (count = citySearch(pHeader->pCity, name, CITY_PREFIX, results, MAX_CITY_RESULTS)) == 0)
+    {
+        if ((count = citySearch(pHeader->pCity, name, CITY_FUZZY, results, MAX_CITY_RESULTS)) > 0)
+            printf("No city is named %s. Did you mean:\n", name);
+    }
+    
+    if (count == 0)
+        printf("No airport exists\n");
+    for (i = 0; i < count && i < MAX_CITY_RESULTS; i++)
+        processScreen(results[i]);
+    if (count > MAX_CITY_RESULTS)
+        printf("... and %d more\n", count - MAX_CITY_RESULTS);
+    
+    return;
+}	// findCity
+
+
+/*	================== scanCoordinates =================
+ This function reads a range of latitudes and a range
+ of longitudes from the user and prints every airport
+ inside both ranges, using the column store.
+ Pre		pHeader - pointer to HEAD structure
+ Post		matching airports are printed
+ Return
+ */
+void scanCoordinates (HEAD* pHeader)
+{
+	//	Local Declarations
+    PREDICATE predicates[2];
+    int* rows;
+    int count;
+    int i;
+    
+	//	Statements
+    if (!pHeader->pColumns) {
+        printf("The column store is not in use\n");
+        return;
+    }
+    
+    predicates[0].column = COLUMN_LATITUDE;
+    predicates[1].column = COLUMN_LONGITUDE;
+    printf("Enter the lowest and highest latitude: ");
+    while (scanf("%f %f", &predicates[0].low, &predicates[0].high) != 2)
+    {
+        printf("Invalid input, please try entering the latitudes again: ");
+        while(getchar() != '\n');
+    }
+    printf("Enter the lowest and highest longitude: ");
+    while (scanf("%f %f", &predicates[1].low, &predicates[1].high) != 2)
+    {
+        printf("Invalid input, please try entering the longitudes again: ");
+        while(getchar() != '\n');
+    }
+    
+    if (!(rows = (int*) malloc((pHeader->pColumns->count + 1) * sizeof(int)))) {
+        printf("Memory allocation error\n");
+        exit(100);
+    }
+    count = columnScan(pHeader->pColumns, predicates, 2, rows);
+    for (i = 0; i < count; i++)
+        processScreen(pHeader->pColumns->records[rows[i]]);
+    printf("%d airports found\n", count);
+    free(rows);
+    
+    return;
+}	// scanCoordinates
+
+
+/*	================== listRange =================
+ This function reads two airport codes from the user
+ and prints, in key order, every airport whose code is
+ between them, using the frozen ordered index.
+ Pre		pHeader - pointer to HEAD structure
+ Post		matching airports are printed
+ Return
+ */
+void listRange (HEAD* pHeader)
+{
+	//	Local Declarations
+    char low[4];
+    char high[4];
+    int count;
+    int i;
+    
+	//	Statements
+    printf("Enter the first and last airport codes: ");
+    while (scanf(" %3s %3s", low, high) != 2)
+    {
+        printf("Invalid input, please try entering the codes again: ");
+        while(getchar() != '\n');
+    }
+    for (i = 0; low[i]; i++)
+        low[i] = toupper(low[i]);
+    for (i = 0; high[i]; i++)
+        high[i] = toupper(high[i]);
+    
+    pHeader->pFrozen = frozenBuild(pHeader->pFrozen, pHeader->pTree);
+    count = frozenRange(pHeader->pFrozen, CODE_KEY(low), CODE_KEY(high), processScreen);
+    printf("%d airports found\n", count);
+    
+    return;
+}	// listRange
+
+
+/*	================== runQuery =================
+ This function reads a compound query from the user,
+ prints the plan chosen for it and the airports that
+ meet it.
+ Pre		pHeader - pointer to HEAD structure
+ Post		matching airports are printed
+ Return
+ */
+void runQuery (HEAD* pHeader)
+{
+	//	Local Declarations
+    QUERY query;
+    char text[256];
+    int count;
+    
+	//	Statements
+    printf("Enter the query (for example: code S* near SEA 500 sort distance limit 20): ");
+    scanf(" %255[^\n]", text);
+    if (!queryParse(text, &query) || !queryPlan(pHeader, &query))
+        return;
+    
+    queryExplain(&query);
+    count = queryRun(pHeader, &query);
+    printf("%d airports found, %d records read\n", count, query.countRead);
+    
+    return;
+}	// runQuery
+
+
+/*	================== clearHead =================
+ This function releases every airport in one linear
+ pass, without deleting them one by one: the tree frees
+ its nodes and the records, the collision nodes go back
+ with their pool and the city names with the string
+ pool. The HEAD structure itself is kept so it can be
+ filled again by buildHead.
+ Pre		pHeader - pointer to HEAD structure
+ Post		hash table, tree, records and city names
+ are freed
+ Return
+ */
+void clearHead (HEAD* pHeader)
+{
+	//	Statements
+	pHeader->pCity = cityIndexDestroy(pHeader->pCity);
+	pHeader->pColumns = columnDestroy(pHeader->pColumns);
+	pHeader->pFrozen = frozenDestroy(pHeader->pFrozen);
+	pHeader->pTree = BST_Destroy(pHeader->pTree);
+	recordReset ();
+    
+	if (pHeader->pShards)
+		pHeader->pShards = shardDestroy (pHeader->pShards);
+	else{
+		pHeader->pHash = destroyHash (pHeader->pHash);
+	}
+	cityPoolDestroy ();
+    
+    return;
+}	// clearHead
+
+
 /*	================== destroy =================
  This function frees everything that was allocated
  throughout the entire program.
@@ -347,21 +828,9 @@ bool addAirport (HEAD* pHeader)
  */
 HEAD* destroy (HEAD* pHeader)
 {
-	//	Local Declarations
-	int i;
-    
 	//	Statements
-    for (i = 0; i < pHeader->pHash->arraySize; i++)
-    {
-        while (pHeader->pHash->pTable[i].pData != NULL)
-        {
-            deleteHash(pHeader, *pHeader->pHash->pTable[i].pData);
-        }
-    }
-	free (pHeader->pHash->pTable);
-	free (pHeader->pHash);
-	free (pHeader->pTree);
-	free (pHeader);
+	clearHead (pHeader);
+	memFree (MEM_HEADER, pHeader, sizeof(HEAD));
     
     return NULL;
 }	// destroy
@@ -0,0 +1,344 @@
+/* memory.c
+ This file contains the definitons of the functions that
+ allocate and free memory for the database while keeping
+ track of how many bytes and objects each part of the
+ database is using:
+
+ Functions:
+ memAlloc
+ memCalloc
+ memFree
+ memTrack
+ memOverhead
+ memStatic
+ memIsStatic
+ memAllocCalls
+ recordAlloc
+ recordFree
+ recordReset
+ memoryReport
+
+ */
+
+#include "header.h"
+
+// Estimated bookkeeping of a typical malloc implementation:
+// every block carries one size word and is rounded up to two
+// words, with a minimum block of four words.
+#define MEM_ALLOC_HEADER   sizeof(size_t)
+#define MEM_ALLOC_ALIGN    (2 * sizeof(size_t))
+#define MEM_ALLOC_MINIMUM  (4 * sizeof(size_t))
+
+// The counters are shared by the threads writing to a sharded
+// table, so they are updated atomically where the compiler can.
+#ifdef __GNUC__
+#define MEM_ADD(counter, value)  ((void) __sync_fetch_and_add(&(counter), (value)))
+#else
+#define MEM_ADD(counter, value)  ((counter) += (value))
+#endif
+
+static long memBytes[MEM_TYPES];
+static long memObjects[MEM_TYPES];
+static long memWaste;
+static long memCalls;
+static const char* memStaticStart;
+#ifdef COMPACT_LINKS
+POOL* recordPool;
+#endif
+static size_t memStaticSize;
+
+static const char* memNames[MEM_TYPES] = {
+    "Table slots", "Chain nodes", "Records",
+    "Strings", "Indexes", "Headers"
+};
+
+/*	================== memAlloc =================
+ This function allocates a block of memory and adds
+ it to the count of its category.
+ Pre		type - category of the block
+ size - number of bytes required
+ Post		block is allocated and counted
+ Return	pointer to the block or
+ NULL if out of memory
+ */
+void* memAlloc (MEM_TYPE type, size_t size)
+{
+	//	Local Declarations
+    void* pBlock;
+
+	//	Statements
+    MEM_ADD(memCalls, 1);
+    if ((pBlock = malloc(size)))
+        memTrack(type, (long) size, 1);
+
+    return pBlock;
+}	// memAlloc
+
+
+/*	================== memCalloc =================
+ This function allocates a zero filled array and adds
+ it to the count of its category.
+ Pre		type - category of the array
+ count - number of elements
+ size - size of each element
+ Post		array is allocated and counted
+ Return	pointer to the array or
+ NULL if out of memory
+ */
+void* memCalloc (MEM_TYPE type, size_t count, size_t size)
+{
+	//	Local Declarations
+    void* pBlock;
+
+	//	Statements
+    MEM_ADD(memCalls, 1);
+    if ((pBlock = calloc(count, size)))
+        memTrack(type, (long) (count * size), 1);
+
+    return pBlock;
+}	// memCalloc
+
+
+/*	================== memFree =================
+ This function frees a block of memory that was
+ allocated by memAlloc or memCalloc. Blocks inside
+ the static region (see memStatic) are only removed
+ from the count.
+ Pre		type - category the block was counted in
+ pBlock - pointer to the block (may be NULL)
+ size - number of bytes of the block
+ Post		block is freed and removed from the count
+ Return
+ */
+void memFree (MEM_TYPE type, void* pBlock, size_t size)
+{
+	//	Statements
+    if (pBlock)
+    {
+        if (!memIsStatic(pBlock))
+            free(pBlock);
+        memTrack(type, -(long) size, -1);
+    }
+    return;
+}	// memFree
+
+
+/*	================== memTrack =================
+ This function updates the count of a category. It is
+ used directly for blocks that are not allocated by
+ memAlloc (the embedded database).
+ Pre		type - category to update
+ size - bytes added (negative when freed)
+ objects - blocks added (negative when freed)
+ Post		counters are updated
+ Return
+ */
+void memTrack (MEM_TYPE type, long size, int objects)
+{
+	//	Local Declarations
+    long block;
+
+	//	Statements
+    block = objects ? size / objects : 0;
+    MEM_ADD(memBytes[type], size);
+    MEM_ADD(memObjects[type], objects);
+    MEM_ADD(memWaste, objects * memOverhead(block));
+    return;
+}	// memTrack
+
+
+/*	================== memOverhead =================
+ This function estimates how many bytes the allocator
+ spends on top of a block of the given size.
+ Pre		size - number of bytes requested
+ Post
+ Return	estimated overhead in bytes
+ */
+long memOverhead (long size)
+{
+	//	Local Declarations
+    long block;
+
+	//	Statements
+    if (size < 0)
+        size = -size;
+    block = (size + MEM_ALLOC_HEADER + MEM_ALLOC_ALIGN - 1) / MEM_ALLOC_ALIGN * MEM_ALLOC_ALIGN;
+    if (block < (long) MEM_ALLOC_MINIMUM)
+        block = MEM_ALLOC_MINIMUM;
+
+    return block - size;
+}	// memOverhead
+
+
+/*	================== memStatic =================
+ This function marks a region of static memory (the
+ embedded database) whose blocks are used like
+ allocated ones but must never be given to free.
+ Pre		pStart - start of the region
+ size - size of the region in bytes
+ Post		region is remembered
+ Return
+ */
+void memStatic (const void* pStart, size_t size)
+{
+	//	Statements
+    memStaticStart = (const char*) pStart;
+    memStaticSize = size;
+    return;
+}	// memStatic
+
+
+/*	================== memIsStatic =================
+ This function tells whether a block lies inside the
+ static region.
+ Pre		pBlock - block to check
+ Post
+ Return	true if the block must not be freed
+ */
+bool memIsStatic (const void* pBlock)
+{
+	//	Statements
+    return memStaticStart != NULL && (const char*) pBlock >= memStaticStart &&
+           (const char*) pBlock < memStaticStart + memStaticSize;
+}	// memIsStatic
+
+
+/*	================== memAllocCalls =================
+ This function returns the number of calls made to
+ memAlloc and memCalloc so far.
+ Pre
+ Post
+ Return	number of allocation calls
+ */
+long memAllocCalls (void)
+{
+	//	Statements
+    return memCalls;
+}	// memAllocCalls
+
+
+/*	================== recordAlloc =================
+ This function allocates one airport record. With
+ COMPACT_LINKS the record comes from the record pool
+ and knows its own position in it. The record has
+ no city yet.
+ Pre
+ Post		record is allocated and counted
+ Return	pointer to the record or
+ NULL if out of memory
+ */
+DATA* recordAlloc (void)
+{
+	//	Local Declarations
+    DATA* pData;
+#ifdef COMPACT_LINKS
+    unsigned link;
+#endif
+
+	//	Statements
+#ifdef COMPACT_LINKS
+    if (!recordPool)
+        recordPool = poolCreate(MEM_RECORD, sizeof(DATA), 0);
+    link = poolAllocIndex(recordPool);
+    pData = REC(link);
+    pData->link = link;
+#else
+    pData = (DATA*) memAlloc(MEM_RECORD, sizeof(DATA));
+#endif
+    if (pData)
+        pData->city = CITY_NONE;
+    return pData;
+}	// recordAlloc
+
+
+/*	================== recordFree =================
+ This function frees a record allocated by
+ recordAlloc (or a record of the embedded database),
+ and gives back its city name.
+ Pre		pData - record no longer linked anywhere
+ Post		record is freed and removed from the count
+ Return
+ */
+void recordFree (DATA* pData)
+{
+	//	Statements
+    cityRelease(pData->city);
+#ifdef COMPACT_LINKS
+    poolFreeIndex(recordPool, pData->link);
+#else
+    memFree(MEM_RECORD, pData, sizeof(DATA));
+#endif
+    return;
+}	// recordFree
+
+
+/*	================== recordReset =================
+ This function releases the record pool once every
+ record has been freed. Nothing to do without
+ COMPACT_LINKS.
+ Pre
+ Post		record pool is released
+ Return
+ */
+void recordReset (void)
+{
+	//	Statements
+#ifdef COMPACT_LINKS
+    recordPool = poolDestroy(recordPool);
+#endif
+    return;
+}	// recordReset
+
+
+/*	================== memoryReport =================
+ This function prints how much memory each part of the
+ database uses, the bytes spent per record and the
+ space taken by empty hash slots.
+ Pre		pHeader - pointer to HEAD structure
+ Post		prints : bytes and objects per category
+ allocator overhead
+ bytes per record
+ wasted slot space
+ Return
+ */
+void memoryReport (HEAD* pHeader)
+{
+	//	Local Declarations
+    long total = 0;
+    long emptySlots = 0;
+    HASH* pHash;
+    int arraySize = 0;
+    int records;
+    int s;
+    int i;
+
+	//	Statements
+    printf("%-14s %10s %12s\n", "Category", "Objects", "Bytes");
+    for (i = 0; i < MEM_TYPES; i++)
+    {
+        printf("%-14s %10ld %12ld\n", memNames[i], memObjects[i], memBytes[i]);
+        total += memBytes[i];
+    }
+    printf("%-14s %10s %12ld\n", "Allocator", "", memWaste);
+    total += memWaste;
+    printf("%-14s %10s %12ld\n\n", "Total", "", total);
+
+    for (s = 0; s < shardCount(pHeader); s++)
+    {
+        pHash = shardTable(pHeader, s);
+        arraySize += pHash->arraySize;
+        for (i = 0; i < pHash->arraySize; i++)
+        {
+            if (pHash->pTable[i].pData == LINK_NONE)
+                emptySlots++;
+        }
+    }
+
+    records = BST_Count(pHeader->pTree);
+    if (records > 0)
+        printf("The memory used per record is %.2f bytes.\n", (float) total / records);
+    printf("The empty hash slots waste %ld bytes (%ld of %d slots).\n\n",
+           emptySlots * (long) sizeof(HASH_NODE), emptySlots, arraySize);
+
+    return;
+}	// memoryReport
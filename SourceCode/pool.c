@@ -0,0 +1,264 @@
+/* pool.c
+ This file contains the definitons of the functions to maintain
+ a pool of fixed size objects. Objects are carved out of large
+ slabs and freed objects are kept on a free list, so getting
+ a node costs no call to malloc and the whole pool can be
+ released at once.
+
+ With COMPACT_LINKS an object is known by its position in the
+ pool instead of its address: slab k holds the positions
+ k << POOL_SHIFT and up, a directory of the slabs turns a
+ position into an address (POOL_AT), and the free list is
+ kept as positions. Position 0 is never handed out, so it can
+ stand for no link:
+
+ Functions:
+ poolCreate
+ poolAlloc
+ poolFree
+ poolAllocIndex
+ poolFreeIndex
+ poolReset
+ poolDestroy
+
+ */
+
+#include "header.h"
+
+#define POOL_DIRECTORY_START  8     // slabs the directory has room for at first
+
+/*	================== poolCreate =================
+ This function creates an empty pool.
+ Pre		type - memory category of the objects
+ objSize - size of one object
+ perSlab - number of objects per slab
+ Post		pool is initialized, no slab allocated yet
+ Return	pointer to the pool
+ */
+POOL* poolCreate (MEM_TYPE type, size_t objSize, int perSlab)
+{
+	//	Local Declarations
+    POOL* pPool;
+
+	//	Statements
+    if (!(pPool = (POOL*) memAlloc(MEM_HEADER, sizeof(POOL)))) {
+        printf("Memory allocation error\n");
+        exit(120);
+    }
+
+    // every free object must be able to hold the free list link
+#ifdef COMPACT_LINKS
+    if (objSize < sizeof(unsigned))
+        objSize = sizeof(unsigned);
+    objSize = (objSize + sizeof(unsigned) - 1) / sizeof(unsigned) * sizeof(unsigned);
+    perSlab = 1 << POOL_SHIFT;
+    pPool->pIndex = NULL;
+    pPool->freeLink = 0;
+    pPool->capacitySlabs = 0;
+#else
+    if (objSize < sizeof(void*))
+        objSize = sizeof(void*);
+    objSize = (objSize + sizeof(void*) - 1) / sizeof(void*) * sizeof(void*);
+#endif
+
+    pPool->type = type;
+    pPool->objSize = objSize;
+    pPool->perSlab = perSlab;
+    pPool->pSlabs = NULL;
+    pPool->pFree = NULL;
+    pPool->countSlabs = 0;
+    pPool->countUsed = 0;
+
+    return pPool;
+}	// poolCreate
+
+
+#ifndef COMPACT_LINKS
+/*	================== poolAlloc =================
+ This function takes one object out of the pool. A new
+ slab is allocated when the free list is empty.
+ Pre		pPool - pointer to the pool
+ Post		object is marked as used
+ Return	pointer to the object
+ */
+void* poolAlloc (POOL* pPool)
+{
+	//	Local Declarations
+    char* pSlab;
+    void* pObject;
+    int i;
+
+	//	Statements
+    if (pPool->pFree == NULL)
+    {
+        // the first word of each slab links it to the previous slab
+        if (!(pSlab = (char*) memAlloc(pPool->type, sizeof(void*) + pPool->objSize * pPool->perSlab))) {
+            printf("Error allocating pool slab\n");
+            exit(121);
+        }
+        *(void**) pSlab = pPool->pSlabs;
+        pPool->pSlabs = pSlab;
+        pPool->countSlabs++;
+
+        pSlab += sizeof(void*);
+        for (i = pPool->perSlab - 1; i >= 0; i--)
+        {
+            *(void**) (pSlab + i * pPool->objSize) = pPool->pFree;
+            pPool->pFree = pSlab + i * pPool->objSize;
+        }
+    }
+
+    pObject = pPool->pFree;
+    pPool->pFree = *(void**) pObject;
+    pPool->countUsed++;
+
+    return pObject;
+}	// poolAlloc
+
+
+/*	================== poolFree =================
+ This function gives an object back to the pool.
+ Pre		pPool - pointer to the pool
+ pObject - object taken by poolAlloc
+ Post		object is on the free list
+ Return
+ */
+void poolFree (POOL* pPool, void* pObject)
+{
+	//	Statements
+    *(void**) pObject = pPool->pFree;
+    pPool->pFree = pObject;
+    pPool->countUsed--;
+    return;
+}	// poolFree
+#else
+
+
+/*	================== poolAllocIndex =================
+ This function takes one object out of the pool and
+ returns its position. A new slab is allocated (and
+ the directory grown) when the free list is empty.
+ Pre		pPool - pointer to the pool
+ Post		object is marked as used
+ Return	position of the object, never 0
+ */
+unsigned poolAllocIndex (POOL* pPool)
+{
+	//	Local Declarations
+    char** newIndex;
+    unsigned link;
+    int capacity;
+    int i;
+
+	//	Statements
+    if (pPool->freeLink == 0)
+    {
+        if (pPool->countSlabs == pPool->capacitySlabs)
+        {
+            capacity = pPool->capacitySlabs ? pPool->capacitySlabs * 2 : POOL_DIRECTORY_START;
+            if (!(newIndex = (char**) memAlloc(pPool->type, capacity * sizeof(char*)))) {
+                printf("Error allocating pool directory\n");
+                exit(122);
+            }
+            if (pPool->pIndex)
+                memcpy(newIndex, pPool->pIndex, pPool->countSlabs * sizeof(char*));
+            memFree(pPool->type, pPool->pIndex, pPool->capacitySlabs * sizeof(char*));
+            pPool->pIndex = newIndex;
+            pPool->capacitySlabs = capacity;
+        }
+        if (!(pPool->pIndex[pPool->countSlabs] = (char*) memAlloc(pPool->type, pPool->objSize * pPool->perSlab))) {
+            printf("Error allocating pool slab\n");
+            exit(121);
+        }
+        pPool->countSlabs++;
+
+        // position 0 stays unused: it means no link
+        for (i = pPool->perSlab - 1; i >= 0; i--)
+        {
+            link = (unsigned) (pPool->countSlabs - 1) << POOL_SHIFT | (unsigned) i;
+            if (link == 0)
+                break;
+            *(unsigned*) POOL_AT(pPool, link) = pPool->freeLink;
+            pPool->freeLink = link;
+        }
+    }
+
+    link = pPool->freeLink;
+    pPool->freeLink = *(unsigned*) POOL_AT(pPool, link);
+    pPool->countUsed++;
+
+    return link;
+}	// poolAllocIndex
+
+
+/*	================== poolFreeIndex =================
+ This function gives an object back to the pool.
+ Pre		pPool - pointer to the pool
+ link - position returned by poolAllocIndex
+ Post		object is on the free list
+ Return
+ */
+void poolFreeIndex (POOL* pPool, unsigned link)
+{
+	//	Statements
+    *(unsigned*) POOL_AT(pPool, link) = pPool->freeLink;
+    pPool->freeLink = link;
+    pPool->countUsed--;
+    return;
+}	// poolFreeIndex
+#endif
+
+
+/*	================== poolReset =================
+ This function releases every slab of the pool at once,
+ without visiting the objects that are still in use.
+ Pre		pPool - pointer to the pool
+ Post		pool is empty
+ Return
+ */
+void poolReset (POOL* pPool)
+{
+	//	Local Declarations
+    void* pSlab;
+#ifdef COMPACT_LINKS
+    int i;
+#endif
+
+	//	Statements
+#ifdef COMPACT_LINKS
+    for (i = 0; i < pPool->countSlabs; i++)
+        memFree(pPool->type, pPool->pIndex[i], pPool->objSize * pPool->perSlab);
+    memFree(pPool->type, pPool->pIndex, pPool->capacitySlabs * sizeof(char*));
+    pPool->pIndex = NULL;
+    pPool->freeLink = 0;
+    pPool->capacitySlabs = 0;
+#endif
+    while (pPool->pSlabs != NULL)
+    {
+        pSlab = pPool->pSlabs;
+        pPool->pSlabs = *(void**) pSlab;
+        memFree(pPool->type, pSlab, sizeof(void*) + pPool->objSize * pPool->perSlab);
+    }
+    pPool->pFree = NULL;
+    pPool->countSlabs = 0;
+    pPool->countUsed = 0;
+    return;
+}	// poolReset
+
+
+/*	================== poolDestroy =================
+ This function releases the pool and all its slabs.
+ Pre		pPool - pointer to the pool (may be NULL)
+ Post		everything is freed
+ Return	NULL
+ */
+POOL* poolDestroy (POOL* pPool)
+{
+	//	Statements
+    if (pPool)
+    {
+        poolReset(pPool);
+        memFree(MEM_HEADER, pPool, sizeof(POOL));
+    }
+    return NULL;
+}	// poolDestroy
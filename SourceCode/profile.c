@@ -0,0 +1,313 @@
+/* profile.c
+ This file contains the definitons of the functions of the
+ profiling mode. While it is on, every operation timed by the
+ latency functions also reads the hardware counters of the
+ processor (Linux perf_event) before and after it runs, and
+ adds the difference to the totals of the operation:
+
+ cycles, instructions, L1 data cache read misses, last level
+ cache misses and branch mispredictions
+
+ together with the number of blocks allocated through memAlloc
+ and memCalloc. A nested operation (the tree delete inside a
+ delete) is also counted in the operation around it. Reading
+ the counters takes a system call, so the mode is only on when
+ asked for. The counters follow the thread that started the
+ profiling; counters the processor (or a virtual machine) does
+ not offer are reported as n/a.
+
+ Functions:
+ profileStart
+ profileStop
+ profileActive
+ profileEnter
+ profileLeave
+ profileReport
+
+ Private Functions:
+ _openCounter
+ _readCounters
+ _printRow
+ */
+
+#include "header.h"
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define PROFILE_PERF
+#endif
+
+#define PROF_DEPTH  32      // operations nested in each other
+
+typedef enum {
+    PROF_CYCLES, PROF_INSTRUCTIONS, PROF_L1_MISSES, PROF_LLC_MISSES,
+    PROF_BRANCH_MISSES, PROF_COUNTERS,
+    PROF_MALLOCS = PROF_COUNTERS, PROF_EVENTS
+}PROF_EVENT;
+
+static bool profOn;
+static int profLeader = -1;               // counter read for the whole group
+static int profFds[PROF_COUNTERS];
+static int profSlot[PROF_COUNTERS];     // position in a read of the group, -1 if not counted
+static int profCountOpen;
+static unsigned long long profMarks[PROF_DEPTH][PROF_EVENTS];
+static int profDepth;
+static unsigned long long profCalls[LAT_OPS];
+static unsigned long long profTotals[LAT_OPS][PROF_EVENTS];
+static const int profWidths[PROF_COUNTERS] = {12, 12, 11, 11, 11};
+
+static int _openCounter (int event, int leader);
+static void _readCounters (unsigned long long* values);
+static void _printRow (const char* name, unsigned long long calls,
+                       unsigned long long* totals, unsigned long long divisor);
+
+/*	================== profileStart =================
+ This function turns the profiling mode on with empty
+ totals and opens the hardware counters.
+ Pre
+ Post		operations are profiled
+ Return	number of hardware counters available
+ */
+int profileStart (void)
+{
+	//	Local Declarations
+    int e;
+
+	//	Statements
+    if (profOn)
+        profileStop();
+    memset(profCalls, 0, sizeof(profCalls));
+    memset(profTotals, 0, sizeof(profTotals));
+    profDepth = 0;
+    profCountOpen = 0;
+    profLeader = -1;
+    for (e = 0; e < PROF_COUNTERS; e++)
+    {
+        profSlot[e] = -1;
+        if ((profFds[e] = _openCounter(e, profLeader)) >= 0)
+        {
+            if (profLeader < 0)
+                profLeader = profFds[e];
+            profSlot[e] = profCountOpen++;
+        }
+    }
+    profOn = true;
+    return profCountOpen;
+}	// profileStart
+
+
+/*	================== profileStop =================
+ This function turns the profiling mode off. The
+ totals are kept for profileReport.
+ Pre
+ Post		hardware counters are closed
+ Return
+ */
+void profileStop (void)
+{
+	//	Local Declarations
+    int e;
+
+	//	Statements
+    if (!profOn)
+        return;
+    profOn = false;
+#ifdef PROFILE_PERF
+    for (e = PROF_COUNTERS - 1; e >= 0; e--)
+        if (profFds[e] >= 0)
+            close(profFds[e]);
+#endif
+    for (e = 0; e < PROF_COUNTERS; e++)
+        profFds[e] = -1;
+    profLeader = -1;
+    return;
+}	// profileStop
+
+
+/*	================== profileActive =================
+ This function tells whether the profiling mode is on.
+ Pre
+ Post
+ Return	true if on
+ */
+bool profileActive (void)
+{
+	//	Statements
+    return profOn;
+}	// profileActive
+
+
+/*	================== profileEnter =================
+ This function remembers the counters at the start of
+ an operation.
+ Pre		profiling mode is on
+ Post		counters are pushed on the stack of operations
+ Return
+ */
+void profileEnter (void)
+{
+	//	Statements
+    if (profDepth < PROF_DEPTH)
+        _readCounters(profMarks[profDepth]);
+    profDepth++;
+    return;
+}	// profileEnter
+
+
+/*	================== profileLeave =================
+ This function adds what the counters counted since
+ the matching profileEnter to the totals of an
+ operation.
+ Pre		op - operation ending
+ Post		totals of op are updated
+ Return
+ */
+void profileLeave (LAT_OP op)
+{
+	//	Local Declarations
+    unsigned long long now[PROF_EVENTS];
+    int e;
+
+	//	Statements
+    if (profDepth == 0)
+        return;
+    if (--profDepth < PROF_DEPTH)
+    {
+        _readCounters(now);
+        for (e = 0; e < PROF_EVENTS; e++)
+            profTotals[op][e] += now[e] - profMarks[profDepth][e];
+        profCalls[op]++;
+    }
+    return;
+}	// profileLeave
+
+
+/*	================== profileReport =================
+ This function prints the totals and the averages per
+ call of every operation profiled.
+ Pre
+ Post		prints two tables, nothing if no operation
+ was profiled
+ Return
+ */
+void profileReport (void)
+{
+	//	Local Declarations
+    int op;
+    bool any = false;
+
+	//	Statements
+    for (op = 0; op < LAT_OPS; op++)
+        if (profCalls[op])
+            any = true;
+    if (!any)
+        return;
+
+    printf("Profile totals   Calls       Cycles Instructions   L1 misses  LLC misses  Br. misses   Mallocs\n");
+    for (op = 0; op < LAT_OPS; op++)
+        if (profCalls[op])
+            _printRow(latencyName((LAT_OP) op), profCalls[op], profTotals[op], 1);
+    printf("\nPer call         Calls       Cycles Instructions   L1 misses  LLC misses  Br. misses   Mallocs\n");
+    for (op = 0; op < LAT_OPS; op++)
+        if (profCalls[op])
+            _printRow(latencyName((LAT_OP) op), profCalls[op], profTotals[op], profCalls[op]);
+    if (profCountOpen < PROF_COUNTERS)
+        printf("\n%d of %d hardware counters are available here.\n", profCountOpen, PROF_COUNTERS);
+    printf("\n");
+    return;
+}	// profileReport
+
+
+/*	================== _openCounter =================
+ Opens one hardware counter of the calling thread, in
+ the group of leader (or as the leader when leader is
+ -1), counting user mode only.
+ Return	file descriptor or -1 if not available
+ */
+static int _openCounter (int event, int leader)
+{
+#ifdef PROFILE_PERF
+	//	Local Declarations
+    struct perf_event_attr attr;
+
+	//	Statements
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    switch (event)
+    {
+        case PROF_CYCLES:
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PROF_INSTRUCTIONS:
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PROF_L1_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D | PERF_COUNT_HW_CACHE_OP_READ << 8 |
+                          PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+            break;
+        case PROF_LLC_MISSES:
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        default:
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+    }
+    return (int) syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0);
+#else
+	//	Statements
+    return -1;
+#endif
+}	// _openCounter
+
+
+/*	================== _readCounters =================
+ Reads the whole group of counters at once, and the
+ number of allocations. Counters not available stay 0.
+ */
+static void _readCounters (unsigned long long* values)
+{
+	//	Local Declarations
+    unsigned long long group[PROF_COUNTERS + 1];
+    int e;
+
+	//	Statements
+    memset(group, 0, sizeof(group));
+#ifdef PROFILE_PERF
+    if (profLeader >= 0 && read(profLeader, group, sizeof(group)) < 0)
+        memset(group, 0, sizeof(group));
+#endif
+    for (e = 0; e < PROF_COUNTERS; e++)
+        values[e] = profSlot[e] >= 0 ? group[1 + profSlot[e]] : 0;
+    values[PROF_MALLOCS] = (unsigned long long) memAllocCalls();
+    return;
+}	// _readCounters
+
+
+/*	================== _printRow =================
+ Prints the totals of one operation divided by
+ divisor, n/a for the counters not available.
+ */
+static void _printRow (const char* name, unsigned long long calls,
+                       unsigned long long* totals, unsigned long long divisor)
+{
+	//	Local Declarations
+    int e;
+
+	//	Statements
+    printf("%-12s %9llu", name, calls);
+    for (e = 0; e < PROF_COUNTERS; e++)
+    {
+        if (profSlot[e] < 0)
+            printf(" %*s", profWidths[e], "n/a");
+        else
+            printf(" %*.1f", profWidths[e], (double) totals[e] / divisor);
+    }
+    printf(" %9.1f\n", (double) totals[PROF_MALLOCS] / divisor);
+    return;
+}	// _printRow
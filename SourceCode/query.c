@@ -0,0 +1,722 @@
+/* query.c
+ This file contains the definitons of the functions that parse,
+ plan and run the compound queries typed in the menu. A query is
+ a list of clauses, all of which must hold:
+
+ code LAX           one code
+ code S*            the codes starting with S
+ code BOS..LAX      a range of codes
+ city Seattle       a city name ("Los Angeles" with quotes, and
+ city Sea*          Sea* for the names starting with Sea)
+ lat 30 40          a range of latitudes
+ lon -125 -100      a range of longitudes
+ near SEA 500       within 500 km of an airport (or of a point:
+                    near 47.4 -122.3 500)
+ sort code          order of the results: code, city or distance
+ limit 20           at most 20 results
+
+ The planner estimates how many records each way of reading the
+ database would go through, and picks the cheapest:
+
+ hash lookup        a single code
+ ordered index      a range of codes, in code order (the whole
+                    index when nothing better applies)
+ city index         a city name or the start of one
+ column scan        the coordinates (and the box around a near
+                    clause); the scan reads two float arrays, so
+                    it is counted as a quarter of its rows
+
+ The clauses the path does not cover are checked on each record
+ read. When the path returns the records in the order asked for,
+ they are printed as they are found and the run stops at the
+ limit; otherwise only the best limit records are kept while
+ reading, then printed in order.
+
+ Functions:
+ queryParse
+ queryPlan
+ queryExplain
+ queryRun
+
+ Private Functions:
+ _nextToken
+ _parseCode
+ _nearBox
+ _offer
+ _matches
+ _distance
+ _sameName
+ _compareRows
+ */
+
+#include "header.h"
+#include <math.h>
+
+#define QUERY_ALL_CODES      0xFFFFFFu   // highest CODE_KEY
+#define QUERY_NO_BOUND       1e9f        // coordinate range of no clause
+#define QUERY_COLUMN_COST    4           // column rows scanned per record read
+#define QUERY_ROWS_START     64
+#define QUERY_EARTH_KM       6371.0
+#define QUERY_KM_PER_DEGREE  111.195
+#define QUERY_PI             3.14159265358979
+
+//	A record kept for the sorted output
+typedef struct{
+    DATA* pData;
+    float distance;
+}QUERY_ROW;
+
+//	State of one run of a query
+typedef struct{
+    QUERY*     pQuery;
+    QUERY_ROW* rows;
+    int        countRows;
+    int        capacity;
+    int        countPrinted;
+}QUERY_RUN;
+
+static const char* queryPaths[] = {
+    "hash lookup", "ordered index", "city index", "column scan"
+};
+static QUERY_ORDER sortOrder;       // order used by _compareRows
+
+static const char* _nextToken (const char* text, char* token, int size);
+static bool _parseCode (const char* token, QUERY* pQuery);
+static void _nearBox (QUERY* pQuery);
+static bool _offer (QUERY_RUN* pRun, DATA* pData);
+static bool _matches (QUERY* pQuery, DATA* pData, float* distance);
+static double _distance (float latitude1, float longitude1, float latitude2, float longitude2);
+static bool _sameName (const char* name1, const char* name2, int length);
+static int _compareRows (const void* row1, const void* row2);
+
+/*	================== queryParse =================
+ This function reads the clauses of a query.
+ Pre		text - the query
+ pQuery - receives the query
+ Post		pQuery holds the clauses, or an error
+ is printed
+ Return	true if the query is valid
+ */
+bool queryParse (const char* text, QUERY* pQuery)
+{
+	//	Local Declarations
+    char clause[32];
+    char token[32];
+    char extra[32];
+    float value;
+    int length;
+    int i;
+
+	//	Statements
+    memset(pQuery, 0, sizeof(QUERY));
+    pQuery->codeLow = 0;
+    pQuery->codeHigh = QUERY_ALL_CODES;
+    pQuery->box[0].column = COLUMN_LATITUDE;
+    pQuery->box[1].column = COLUMN_LONGITUDE;
+    for (i = 0; i < 2; i++) {
+        pQuery->box[i].low = -QUERY_NO_BOUND;
+        pQuery->box[i].high = QUERY_NO_BOUND;
+    }
+    pQuery->order = ORDER_NONE;
+
+    while ((text = _nextToken(text, clause, sizeof(clause))))
+    {
+        if (!(text = _nextToken(text, token, sizeof(token)))) {
+            printf("Query error: %s needs a value\n", clause);
+            return false;
+        }
+        if (_sameName(clause, "code", -1))
+        {
+            if (!_parseCode(token, pQuery))
+                return false;
+        }
+        else if (_sameName(clause, "city", -1))
+        {
+            length = (int) strlen(token);
+            pQuery->cityPrefix = length > 0 && token[length - 1] == '*';
+            if (pQuery->cityPrefix)
+                token[--length] = '\0';
+            if (length == 0 || length >= (int) sizeof(pQuery->city)) {
+                printf("Query error: bad city name %s\n", token);
+                return false;
+            }
+            strcpy(pQuery->city, token);
+        }
+        else if (_sameName(clause, "lat", -1) || _sameName(clause, "lon", -1))
+        {
+            i = _sameName(clause, "lat", -1) ? 0 : 1;
+            if (!(text = _nextToken(text, extra, sizeof(extra))) ||
+                sscanf(token, "%f", &pQuery->box[i].low) != 1 ||
+                sscanf(extra, "%f", &pQuery->box[i].high) != 1) {
+                printf("Query error: %s needs the lowest and highest value\n", clause);
+                return false;
+            }
+        }
+        else if (_sameName(clause, "near", -1))
+        {
+            pQuery->near = true;
+            if (sscanf(token, "%f", &value) == 1)
+            {
+                pQuery->nearLatitude = value;
+                if (!(text = _nextToken(text, token, sizeof(token))) ||
+                    sscanf(token, "%f", &pQuery->nearLongitude) != 1) {
+                    printf("Query error: near needs a code or a latitude and longitude\n");
+                    return false;
+                }
+            }
+            else
+            {
+                if (strlen(token) > 3) {
+                    printf("Query error: bad airport code %s\n", token);
+                    return false;
+                }
+                for (i = 0; token[i]; i++)
+                    pQuery->nearCode[i] = toupper(token[i]);
+                pQuery->nearCode[i] = '\0';
+            }
+            if (!(text = _nextToken(text, token, sizeof(token))) ||
+                sscanf(token, "%f", &pQuery->radius) != 1 || pQuery->radius < 0) {
+                printf("Query error: near needs a distance in km\n");
+                return false;
+            }
+        }
+        else if (_sameName(clause, "sort", -1))
+        {
+            if (_sameName(token, "code", -1))
+                pQuery->order = ORDER_CODE;
+            else if (_sameName(token, "city", -1))
+                pQuery->order = ORDER_CITY;
+            else if (_sameName(token, "distance", -1))
+                pQuery->order = ORDER_DISTANCE;
+            else {
+                printf("Query error: cannot sort by %s\n", token);
+                return false;
+            }
+        }
+        else if (_sameName(clause, "limit", -1))
+        {
+            if (sscanf(token, "%d", &pQuery->limit) != 1 || pQuery->limit < 1) {
+                printf("Query error: bad limit %s\n", token);
+                return false;
+            }
+        }
+        else
+        {
+            printf("Query error: unknown clause %s\n", clause);
+            return false;
+        }
+    }
+    if (pQuery->order == ORDER_DISTANCE && !pQuery->near) {
+        printf("Query error: sort distance needs a near clause\n");
+        return false;
+    }
+    return true;
+}	// queryParse
+
+
+/*	================== queryPlan =================
+ This function picks the cheapest way to run a query.
+ The frozen index is brought up to date first, so the
+ records in a range of codes are counted exactly.
+ Pre		pHeader - pointer to HEAD structure
+ pQuery - parsed query
+ Post		path, estimate and ordered are set
+ Return	false if the airport of a near clause
+ does not exist
+ */
+bool queryPlan (HEAD* pHeader, QUERY* pQuery)
+{
+	//	Local Declarations
+    DATA target;
+    DATA* pCenter;
+    bool boxed;
+    double matches;
+    int count;
+    int cities;
+    int estimate;
+    int last;
+
+	//	Statements
+    if (pQuery->nearCode[0])
+    {
+        strcpy(target.arpCode, pQuery->nearCode);
+        if (pHeader->pShards)
+            pCenter = shardFind(pHeader->pShards, &target);
+        else
+            pCenter = findHash(pHeader->pHash, &target);
+        if (!pCenter) {
+            printf("Query error: no airport %s\n", pQuery->nearCode);
+            return false;
+        }
+        pQuery->nearLatitude = pCenter->latitude;
+        pQuery->nearLongitude = pCenter->longitude;
+    }
+    if (pQuery->near)
+        _nearBox(pQuery);
+    boxed = pQuery->box[0].low > -QUERY_NO_BOUND || pQuery->box[0].high < QUERY_NO_BOUND ||
+            pQuery->box[1].low > -QUERY_NO_BOUND || pQuery->box[1].high < QUERY_NO_BOUND;
+
+    // the ordered index can always run the query
+    pHeader->pFrozen = frozenBuild(pHeader->pFrozen, pHeader->pTree);
+    count = pHeader->pFrozen->count;
+    last = pQuery->codeHigh >= QUERY_ALL_CODES ? count : frozenRank(pHeader->pFrozen, pQuery->codeHigh + 1);
+    pQuery->path = QUERY_RANGE;
+    pQuery->estimate = pQuery->codeLow > pQuery->codeHigh ? 0 :
+                       last - frozenRank(pHeader->pFrozen, pQuery->codeLow);
+    cities = pQuery->city[0] ? citySearch(pHeader->pCity, pQuery->city,
+                                          pQuery->cityPrefix ? CITY_PREFIX : CITY_EXACT, NULL, 0) : count;
+
+    // in code order the scan stops at the limit: the share of the
+    // records of the city gives how far it should go
+    if (pQuery->limit && !boxed && count > 0 &&
+        (pQuery->order == ORDER_NONE || pQuery->order == ORDER_CODE))
+    {
+        matches = (double) pQuery->estimate * cities / count;
+        if (matches > pQuery->limit)
+            pQuery->estimate = (int) ceil(pQuery->estimate * pQuery->limit / matches);
+    }
+
+    if (pQuery->codeLow == pQuery->codeHigh)
+    {
+        pQuery->path = QUERY_POINT;
+        pQuery->estimate = 1;
+    }
+    if (pQuery->city[0] && cities < pQuery->estimate)
+    {
+        pQuery->path = QUERY_CITY;
+        pQuery->estimate = cities;
+    }
+    if (boxed && pHeader->pColumns)
+    {
+        estimate = (count + QUERY_COLUMN_COST - 1) / QUERY_COLUMN_COST;
+        if (estimate < pQuery->estimate) {
+            pQuery->path = QUERY_COLUMNS;
+            pQuery->estimate = estimate;
+        }
+    }
+
+    pQuery->ordered = pQuery->order == ORDER_NONE ||
+                      (pQuery->order == ORDER_CODE &&
+                       (pQuery->path == QUERY_RANGE || pQuery->path == QUERY_POINT)) ||
+                      (pQuery->order == ORDER_CITY && pQuery->path == QUERY_CITY);
+    if (pQuery->path == QUERY_CITY && pQuery->ordered && pQuery->limit && !boxed &&
+        pQuery->codeLow == 0 && pQuery->codeHigh == QUERY_ALL_CODES && pQuery->estimate > pQuery->limit)
+        pQuery->estimate = pQuery->limit;
+    return true;
+}	// queryPlan
+
+
+/*	================== queryExplain =================
+ This function prints the plan chosen for a query.
+ Pre		pQuery - planned query
+ Post		plan is printed
+ Return
+ */
+void queryExplain (QUERY* pQuery)
+{
+	//	Statements
+    printf("Plan: %s, about %d records to read", queryPaths[pQuery->path], pQuery->estimate);
+    if (!pQuery->ordered)
+        printf(", then sorted");
+    else if (pQuery->limit)
+        printf(", stops at the limit");
+    printf("\n");
+    return;
+}	// queryExplain
+
+
+/*	================== queryRun =================
+ This function runs a planned query and prints the
+ records that meet it.
+ Pre		pHeader - pointer to HEAD structure
+ pQuery - planned query
+ Post		records are printed, countRead is set
+ Return	number of records printed
+ */
+int queryRun (HEAD* pHeader, QUERY* pQuery)
+{
+	//	Local Declarations
+    QUERY_RUN run;
+    FROZEN* pFrozen = pHeader->pFrozen;
+    DATA target;
+    DATA* pData;
+    DATA** records;
+    int* rows;
+    int count;
+    int rank;
+    int i;
+
+	//	Statements
+    run.pQuery = pQuery;
+    run.rows = NULL;
+    run.countRows = 0;
+    run.capacity = 0;
+    run.countPrinted = 0;
+    pQuery->countRead = 0;
+
+    switch (pQuery->path)
+    {
+        case QUERY_POINT:
+            target.arpCode[0] = (char) (pQuery->codeLow >> 16);
+            target.arpCode[1] = (char) (pQuery->codeLow >> 8 & 0xFF);
+            target.arpCode[2] = (char) (pQuery->codeLow & 0xFF);
+            target.arpCode[3] = '\0';
+            if (pHeader->pShards)
+                pData = shardFind(pHeader->pShards, &target);
+            else
+                pData = findHash(pHeader->pHash, &target);
+            if (pData)
+                _offer(&run, pData);
+            break;
+        case QUERY_RANGE:
+            for (rank = frozenRank(pFrozen, pQuery->codeLow);
+                 rank < pFrozen->count && CODE_KEY(pFrozen->sorted[rank]->arpCode) <= pQuery->codeHigh;
+                 rank++)
+                if (!_offer(&run, pFrozen->sorted[rank]))
+                    break;
+            break;
+        case QUERY_CITY:
+            count = citySearch(pHeader->pCity, pQuery->city,
+                               pQuery->cityPrefix ? CITY_PREFIX : CITY_EXACT, NULL, 0);
+            if (!(records = (DATA**) memAlloc(MEM_INDEX, (count + 1) * sizeof(DATA*)))) {
+                printf("Memory allocation error\n");
+                exit(200);
+            }
+            citySearch(pHeader->pCity, pQuery->city,
+                       pQuery->cityPrefix ? CITY_PREFIX : CITY_EXACT, records, count);
+            for (i = 0; i < count && _offer(&run, records[i]); i++)
+                ;
+            memFree(MEM_INDEX, records, (count + 1) * sizeof(DATA*));
+            break;
+        case QUERY_COLUMNS:
+            if (!(rows = (int*) memAlloc(MEM_INDEX, (pHeader->pColumns->count + 1) * sizeof(int)))) {
+                printf("Memory allocation error\n");
+                exit(200);
+            }
+            count = columnScan(pHeader->pColumns, pQuery->box, 2, rows);
+            for (i = 0; i < count && _offer(&run, pHeader->pColumns->records[rows[i]]); i++)
+                ;
+            memFree(MEM_INDEX, rows, (pHeader->pColumns->count + 1) * sizeof(int));
+            break;
+    }
+
+    // records kept for sorting
+    if (!pQuery->limit && run.countRows > 1) {
+        sortOrder = pQuery->order;
+        qsort(run.rows, run.countRows, sizeof(QUERY_ROW), _compareRows);
+    }
+    for (i = 0; i < run.countRows; i++)
+    {
+        if (pQuery->near)
+            printf("%8.1f km  ", run.rows[i].distance);
+        processScreen(run.rows[i].pData);
+        run.countPrinted++;
+    }
+    memFree(MEM_INDEX, run.rows, run.capacity * sizeof(QUERY_ROW));
+    return run.countPrinted;
+}	// queryRun
+
+
+/*	================== _nextToken =================
+ Copies the next word of text into token; a word in
+ double quotes may hold spaces. Returns the text after
+ the word, NULL when there is none left.
+ */
+static const char* _nextToken (const char* text, char* token, int size)
+{
+	//	Local Declarations
+    char end = ' ';
+    int length = 0;
+
+	//	Statements
+    while (*text == ' ' || *text == '\t')
+        text++;
+    if (*text == '\0')
+        return NULL;
+    if (*text == '"')
+        end = *text++;
+    while (*text && *text != end && !(end == ' ' && *text == '\t'))
+    {
+        if (length < size - 1)
+            token[length++] = *text;
+        text++;
+    }
+    if (*text == '"')
+        text++;
+    token[length] = '\0';
+    return text;
+}	// _nextToken
+
+
+/*	================== _parseCode =================
+ Narrows the range of codes of a query to one code,
+ the codes starting with a prefix (S*) or a range
+ (BOS..LAX).
+ */
+static bool _parseCode (const char* token, QUERY* pQuery)
+{
+	//	Local Declarations
+    char low[8];
+    char high[8];
+    const char* dots;
+    unsigned keyLow;
+    unsigned keyHigh;
+    int length;
+    int i;
+
+	//	Statements
+    memset(low, 0, sizeof(low));
+    memset(high, 0, sizeof(high));
+    if ((dots = strstr(token, "..")))
+    {
+        length = (int) (dots - token);
+        if (length > 3 || strlen(dots + 2) > 3) {
+            printf("Query error: bad range of codes %s\n", token);
+            return false;
+        }
+        memcpy(low, token, length);
+        strcpy(high, dots + 2);
+        for (i = 0; i < 3; i++) {
+            low[i] = toupper(low[i]);
+            high[i] = toupper(high[i]);
+        }
+        keyLow = CODE_KEY(low);
+        keyHigh = CODE_KEY(high);
+    }
+    else
+    {
+        length = (int) strlen(token);
+        if (length > 0 && token[length - 1] == '*')
+            length--;
+        if (length > 3) {
+            printf("Query error: bad airport code %s\n", token);
+            return false;
+        }
+        for (i = 0; i < length; i++)
+            low[i] = toupper(token[i]);
+        keyLow = CODE_KEY(low);
+        keyHigh = length < (int) strlen(token) ? keyLow | QUERY_ALL_CODES >> (8 * length) : keyLow;
+    }
+
+    // several code clauses must all hold
+    if (keyLow > pQuery->codeLow)
+        pQuery->codeLow = keyLow;
+    if (keyHigh < pQuery->codeHigh)
+        pQuery->codeHigh = keyHigh;
+    return true;
+}	// _parseCode
+
+
+/*	================== _nearBox =================
+ Narrows the coordinate ranges of a query to the box
+ around its near clause, so the column store can be
+ used for it. The longitudes are left alone when the
+ box would cross a pole or the 180th meridian.
+ */
+static void _nearBox (QUERY* pQuery)
+{
+	//	Local Declarations
+    double degrees;
+    double widest;
+    double spread;
+    PREDICATE* pLatitude = &pQuery->box[0];
+    PREDICATE* pLongitude = &pQuery->box[1];
+
+	//	Statements
+    degrees = pQuery->radius / QUERY_KM_PER_DEGREE;
+    if (pQuery->nearLatitude - degrees > pLatitude->low)
+        pLatitude->low = (float) (pQuery->nearLatitude - degrees);
+    if (pQuery->nearLatitude + degrees < pLatitude->high)
+        pLatitude->high = (float) (pQuery->nearLatitude + degrees);
+
+    widest = fabs(pQuery->nearLatitude) + degrees;
+    if (widest >= 89.0)
+        return;
+    spread = degrees / cos(widest * QUERY_PI / 180);
+    if (pQuery->nearLongitude - spread < -180 || pQuery->nearLongitude + spread > 180)
+        return;
+    if (pQuery->nearLongitude - spread > pLongitude->low)
+        pLongitude->low = (float) (pQuery->nearLongitude - spread);
+    if (pQuery->nearLongitude + spread < pLongitude->high)
+        pLongitude->high = (float) (pQuery->nearLongitude + spread);
+    return;
+}	// _nearBox
+
+
+/*	================== _offer =================
+ Hands one record read by the path to the run: a record
+ meeting the query is printed at once when the path is
+ in order, otherwise kept (the best limit of them).
+ Returns false when the run can stop.
+ */
+static bool _offer (QUERY_RUN* pRun, DATA* pData)
+{
+	//	Local Declarations
+    QUERY* pQuery = pRun->pQuery;
+    QUERY_ROW row;
+    QUERY_ROW* newRows;
+    int capacity;
+    int i;
+
+	//	Statements
+    pQuery->countRead++;
+    if (!_matches(pQuery, pData, &row.distance))
+        return true;
+    row.pData = pData;
+
+    if (pQuery->ordered)
+    {
+        if (pQuery->near)
+            printf("%8.1f km  ", row.distance);
+        processScreen(pData);
+        pRun->countPrinted++;
+        return !pQuery->limit || pRun->countPrinted < pQuery->limit;
+    }
+
+    if (pRun->countRows == pRun->capacity && (!pQuery->limit || pRun->countRows < pQuery->limit))
+    {
+        capacity = pRun->capacity ? pRun->capacity * 2 : QUERY_ROWS_START;
+        if (pQuery->limit && capacity > pQuery->limit)
+            capacity = pQuery->limit;
+        if (!(newRows = (QUERY_ROW*) memAlloc(MEM_INDEX, capacity * sizeof(QUERY_ROW)))) {
+            printf("Memory allocation error\n");
+            exit(200);
+        }
+        if (pRun->rows)
+            memcpy(newRows, pRun->rows, pRun->countRows * sizeof(QUERY_ROW));
+        memFree(MEM_INDEX, pRun->rows, pRun->capacity * sizeof(QUERY_ROW));
+        pRun->rows = newRows;
+        pRun->capacity = capacity;
+    }
+    if (!pQuery->limit)
+    {
+        pRun->rows[pRun->countRows++] = row;
+        return true;
+    }
+
+    // keep the best limit records in order
+    sortOrder = pQuery->order;
+    i = pRun->countRows;
+    if (i == pQuery->limit)
+    {
+        if (_compareRows(&row, &pRun->rows[i - 1]) >= 0)
+            return true;
+        i--;
+    }
+    else
+        pRun->countRows++;
+    while (i > 0 && _compareRows(&row, &pRun->rows[i - 1]) < 0)
+    {
+        pRun->rows[i] = pRun->rows[i - 1];
+        i--;
+    }
+    pRun->rows[i] = row;
+    return true;
+}	// _offer
+
+
+/*	================== _matches =================
+ Checks every clause of a query on a record, and gives
+ its distance to the near point.
+ */
+static bool _matches (QUERY* pQuery, DATA* pData, float* distance)
+{
+	//	Local Declarations
+    unsigned key = CODE_KEY(pData->arpCode);
+
+	//	Statements
+    *distance = 0;
+    if (key < pQuery->codeLow || key > pQuery->codeHigh)
+        return false;
+    if (pQuery->city[0] &&
+        !_sameName(cityName(pData->city), pQuery->city,
+                   pQuery->cityPrefix ? (int) strlen(pQuery->city) : -1))
+        return false;
+    if (pData->latitude < pQuery->box[0].low || pData->latitude > pQuery->box[0].high ||
+        pData->longitude < pQuery->box[1].low || pData->longitude > pQuery->box[1].high)
+        return false;
+    if (pQuery->near)
+    {
+        *distance = (float) _distance(pQuery->nearLatitude, pQuery->nearLongitude,
+                                      pData->latitude, pData->longitude);
+        if (*distance > pQuery->radius)
+            return false;
+    }
+    return true;
+}	// _matches
+
+
+/*	================== _distance =================
+ Returns the great circle distance in km between two
+ points (haversine formula).
+ */
+static double _distance (float latitude1, float longitude1, float latitude2, float longitude2)
+{
+	//	Local Declarations
+    double toRadians = QUERY_PI / 180;
+    double sinLatitude = sin((latitude2 - latitude1) * toRadians / 2);
+    double sinLongitude = sin((longitude2 - longitude1) * toRadians / 2);
+    double h;
+
+	//	Statements
+    h = sinLatitude * sinLatitude +
+        cos(latitude1 * toRadians) * cos(latitude2 * toRadians) * sinLongitude * sinLongitude;
+    if (h > 1)
+        h = 1;
+    return 2 * QUERY_EARTH_KM * asin(sqrt(h));
+}	// _distance
+
+
+/*	================== _sameName =================
+ Compares two names ignoring case, only their first
+ length letters when length is not -1.
+ */
+static bool _sameName (const char* name1, const char* name2, int length)
+{
+	//	Local Declarations
+    int i;
+
+	//	Statements
+    for (i = 0; length < 0 || i < length; i++)
+    {
+        if (toupper((unsigned char) name1[i]) != toupper((unsigned char) name2[i]))
+            return false;
+        if (name1[i] == '\0')
+            return true;
+    }
+    return true;
+}	// _sameName
+
+
+/*	================== _compareRows =================
+ qsort order of the kept records: by sortOrder, then
+ by code.
+ */
+static int _compareRows (const void* row1, const void* row2)
+{
+	//	Local Declarations
+    const QUERY_ROW* pRow1 = (const QUERY_ROW*) row1;
+    const QUERY_ROW* pRow2 = (const QUERY_ROW*) row2;
+    unsigned key1 = CODE_KEY(pRow1->pData->arpCode);
+    unsigned key2 = CODE_KEY(pRow2->pData->arpCode);
+    const char* name1;
+    const char* name2;
+    int i;
+
+	//	Statements
+    if (sortOrder == ORDER_DISTANCE && pRow1->distance != pRow2->distance)
+        return pRow1->distance < pRow2->distance ? -1 : 1;
+    if (sortOrder == ORDER_CITY)
+    {
+        name1 = cityName(pRow1->pData->city);
+        name2 = cityName(pRow2->pData->city);
+        for (i = 0; toupper((unsigned char) name1[i]) == toupper((unsigned char) name2[i]); i++)
+            if (name1[i] == '\0')
+                break;
+        if (toupper((unsigned char) name1[i]) != toupper((unsigned char) name2[i]))
+            return toupper((unsigned char) name1[i]) < toupper((unsigned char) name2[i]) ? -1 : 1;
+    }
+    if (key1 != key2)
+        return key1 < key2 ? -1 : 1;
+    return 0;
+}	// _compareRows
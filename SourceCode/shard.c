@@ -0,0 +1,261 @@
+/* shard.c
+ This file contains the definitons of the functions to maintain
+ a sharded hash table. The codes are split between independent
+ sub-tables (shards) by a hash of the code that does not depend
+ on the size of any table. Each shard is a complete HASH, with
+ its own size, load factor, resizing, collision pool and filter,
+ and its own lock: writers on different shards never wait for
+ each other, and a resize only holds up the shard it resizes.
+
+ The shard functions may be called from several threads at
+ once; the locks cover the shard tables and nothing else.
+ Concurrent writes to the database are not supported: the
+ tree, the frozen index, the city index, the column store and
+ the record and name pools have no locks, and insertRecord and
+ deleteRecord update them all, so they are called by one
+ thread. Without pthreads (Microsoft C) the locks do nothing
+ and the table is used by one thread.
+
+ Functions:
+ shardCreate
+ shardOf
+ shardInsert
+ shardRemove
+ shardFind
+ shardCount
+ shardTable
+ shardDestroy
+
+ Private Functions:
+ _lockShard
+ _unlockShard
+ */
+
+#include "header.h"
+#ifndef _MSC_VER
+#include <pthread.h>
+#endif
+
+static void _lockShard (SHARDS* pShards, int shard);
+static void _unlockShard (SHARDS* pShards, int shard);
+
+/*	================== shardCreate =================
+ This function creates the shards, sharing the slots
+ for the expected records evenly between them.
+ Pre		countShards - number of sub-tables
+ countRecords - number of records expected
+ Post		every shard is an empty hash table
+ Return	pointer to the sharded table
+ */
+SHARDS* shardCreate (int countShards, int countRecords)
+{
+	//	Local Declarations
+    SHARDS* pShards;
+    int sizeHash;
+    int s;
+
+	//	Statements
+    if (!(pShards = (SHARDS*) memAlloc(MEM_HEADER, sizeof(SHARDS))) ||
+        !(pShards->pTables = (HASH**) memAlloc(MEM_HEADER, countShards * sizeof(HASH*)))) {
+        printf("Error allocating shards\n");
+        exit(160);
+    }
+#ifndef _MSC_VER
+    if (!(pShards->pLocks = memAlloc(MEM_HEADER, countShards * sizeof(pthread_mutex_t)))) {
+        printf("Error allocating shards\n");
+        exit(160);
+    }
+#else
+    pShards->pLocks = NULL;
+#endif
+    pShards->countShards = countShards;
+
+    sizeHash = 2 * countRecords / countShards;
+    if (sizeHash < 1)
+        sizeHash = 1;
+    for (s = 0; s < countShards; s++) {
+        pShards->pTables[s] = buildHash(sizeHash);
+#ifndef _MSC_VER
+        pthread_mutex_init((pthread_mutex_t*) pShards->pLocks + s, NULL);
+#endif
+    }
+    return pShards;
+}	// shardCreate
+
+
+/*	================== shardOf =================
+ This function picks the shard of a record. The code
+ is mixed by a multiplicative hash and the middle bits
+ are used, so the shard does not follow the slot the
+ code gets inside a table (CODE_INDEX).
+ Pre		pShards - pointer to the sharded table
+ pData - record or target code
+ Post
+ Return	index of the shard
+ */
+int shardOf (SHARDS* pShards, DATA* pData)
+{
+	//	Statements
+    return (int) ((CODE_KEY(pData->arpCode) * 2654435761u >> 16) % (unsigned) pShards->countShards);
+}	// shardOf
+
+
+/*	================== shardInsert =================
+ This function inserts a record into its shard and
+ grows that shard alone when its load factor gets too
+ high.
+ Pre		pShards - pointer to the sharded table
+ pData - record to be inserted
+ Post		record is in its shard
+ Return	true if success
+ false if fail
+ */
+bool shardInsert (SHARDS* pShards, DATA* pData)
+{
+	//	Local Declarations
+    bool result;
+    int shard = shardOf(pShards, pData);
+
+	//	Statements
+    _lockShard(pShards, shard);
+    result = insertHash(pShards->pTables[shard], pData);
+    while (checkHash(pShards->pTables[shard]) == 1)
+        pShards->pTables[shard] = upsizeHash(pShards->pTables[shard]);
+    _unlockShard(pShards, shard);
+    return result;
+}	// shardInsert
+
+
+/*	================== shardRemove =================
+ This function takes a record out of its shard and
+ shrinks that shard alone when it gets too empty. The
+ record itself is not freed.
+ Pre		pShards - pointer to the sharded table
+ pData - record stored in the table
+ Post		record is no longer in its shard
+ Return	true if the record was found
+ */
+bool shardRemove (SHARDS* pShards, DATA* pData)
+{
+	//	Local Declarations
+    bool result;
+    int shard = shardOf(pShards, pData);
+
+	//	Statements
+    _lockShard(pShards, shard);
+    result = removeHash(pShards->pTables[shard], pData);
+    while (checkHash(pShards->pTables[shard]) == -1 && pShards->pTables[shard]->arraySize > 1)
+        pShards->pTables[shard] = downsizeHash(pShards->pTables[shard]);
+    _unlockShard(pShards, shard);
+    return result;
+}	// shardRemove
+
+
+/*	================== shardFind =================
+ This function searches the shard of a code. The search
+ reorders the collision list, so it holds the lock too.
+ Pre		pShards - pointer to the sharded table
+ target - pointer to searched DATA structure
+ Post
+ Return	pointer to the record or NULL if not found
+ */
+DATA* shardFind (SHARDS* pShards, DATA* target)
+{
+	//	Local Declarations
+    DATA* pFound;
+    int shard = shardOf(pShards, target);
+
+	//	Statements
+    _lockShard(pShards, shard);
+    pFound = findHash(pShards->pTables[shard], target);
+    _unlockShard(pShards, shard);
+    return pFound;
+}	// shardFind
+
+
+/*	================== shardCount =================
+ This function returns the number of hash tables of the
+ database: the number of shards, or 1 when the hash
+ table is not sharded.
+ Pre		pHeader - pointer to HEAD structure
+ Post
+ Return	number of tables
+ */
+int shardCount (HEAD* pHeader)
+{
+	//	Statements
+    return pHeader->pShards ? pHeader->pShards->countShards : 1;
+}	// shardCount
+
+
+/*	================== shardTable =================
+ This function returns one of the hash tables of the
+ database, so code that walks every table works the
+ same with and without shards. It takes no lock.
+ Pre		pHeader - pointer to HEAD structure
+ shard - 0 to shardCount - 1
+ Post
+ Return	pointer to the table
+ */
+HASH* shardTable (HEAD* pHeader, int shard)
+{
+	//	Statements
+    return pHeader->pShards ? pHeader->pShards->pTables[shard] : pHeader->pHash;
+}	// shardTable
+
+
+/*	================== shardDestroy =================
+ This function frees every shard with its collision
+ nodes and filter. The records are not freed.
+ Pre		pShards - pointer to the sharded table (may be NULL)
+ Post		shards are freed
+ Return	NULL
+ */
+SHARDS* shardDestroy (SHARDS* pShards)
+{
+	//	Local Declarations
+    int s;
+
+	//	Statements
+    if (pShards)
+    {
+        for (s = 0; s < pShards->countShards; s++) {
+            pShards->pTables[s] = destroyHash(pShards->pTables[s]);
+#ifndef _MSC_VER
+            pthread_mutex_destroy((pthread_mutex_t*) pShards->pLocks + s);
+#endif
+        }
+#ifndef _MSC_VER
+        memFree(MEM_HEADER, pShards->pLocks, pShards->countShards * sizeof(pthread_mutex_t));
+#endif
+        memFree(MEM_HEADER, pShards->pTables, pShards->countShards * sizeof(HASH*));
+        memFree(MEM_HEADER, pShards, sizeof(SHARDS));
+    }
+    return NULL;
+}	// shardDestroy
+
+
+/*	================== _lockShard =================
+ Waits until the calling thread owns the shard.
+ */
+static void _lockShard (SHARDS* pShards, int shard)
+{
+	//	Statements
+#ifndef _MSC_VER
+    pthread_mutex_lock((pthread_mutex_t*) pShards->pLocks + shard);
+#endif
+    return;
+}	// _lockShard
+
+
+/*	================== _unlockShard =================
+ Lets other threads use the shard again.
+ */
+static void _unlockShard (SHARDS* pShards, int shard)
+{
+	//	Statements
+#ifndef _MSC_VER
+    pthread_mutex_unlock((pthread_mutex_t*) pShards->pLocks + shard);
+#endif
+    return;
+}	// _unlockShard
@@ -0,0 +1,384 @@
+/* strpool.c
+ This file contains the definitons of the functions to maintain
+ the pool of city names. Every distinct name is stored once,
+ one after another in a single buffer, and a record only keeps
+ the 32-bit handle of its name. Two records are in the same
+ city when their handles are equal.
+
+ A handle is a position in the names table, which holds where
+ the text is in the buffer and how many records use it. When
+ the count drops to zero (delete, update to another city,
+ reload) the name leaves the lookup index and its handle is
+ reused by the next new name. The text stays in the buffer
+ until the buffer is full: the live names are then packed into
+ a new buffer instead of doubling it, as long as at least half
+ of the bytes belong to released names. Handles do not move
+ when the buffer is packed.
+
+ Functions:
+ cityIntern
+ cityFind
+ cityRelease
+ cityName
+ cityPoolState
+ cityPoolDestroy
+
+ Private Functions:
+ _hashName
+ _growIndex
+ _growBuffer
+ _newHandle
+ _unlinkName
+ */
+
+#include "header.h"
+
+#define POOL_BUFFER_START   512
+#define POOL_INDEX_START    64
+#define POOL_NAMES_START    32
+
+static STR_POOL cityPool;
+
+static unsigned _hashName (const char* name);
+static void _growIndex (void);
+static void _growBuffer (unsigned length);
+static unsigned _newHandle (void);
+static void _unlinkName (unsigned handle);
+
+/*	================== cityIntern =================
+ This function returns the handle of a city name,
+ adding the name to the pool if it is not there yet.
+ Every call takes one reference on the name, to be
+ given back with cityRelease.
+ Pre		name - city name to be stored
+ Post		name is stored in the pool once
+ Return	handle of the name
+ */
+unsigned cityIntern (const char* name)
+{
+	//	Local Declarations
+    unsigned slot;
+    unsigned handle;
+    unsigned length;
+
+	//	Statements
+    if ((handle = cityFind(name)) != CITY_NONE) {
+        cityPool.names[handle].refs++;
+        return handle;
+    }
+
+    if ((cityPool.countNames + 1) * 2 > cityPool.indexSize)
+        _growIndex();
+
+    length = (unsigned) strlen(name) + 1;
+    if (cityPool.used + length > cityPool.capacity)
+        _growBuffer(length);
+
+    handle = _newHandle();
+    cityPool.names[handle].offset = cityPool.used;
+    cityPool.names[handle].refs = 1;
+    memcpy(cityPool.buffer + cityPool.used, name, length);
+    cityPool.used += length;
+
+    slot = _hashName(name) & (cityPool.indexSize - 1);
+    while (cityPool.index[slot] != 0)
+        slot = (slot + 1) & (cityPool.indexSize - 1);
+    cityPool.index[slot] = handle + 1;
+    cityPool.countNames++;
+
+    return handle;
+}	// cityIntern
+
+
+/*	================== cityFind =================
+ This function looks up a city name without adding it.
+ Pre		name - city name to search for
+ Post
+ Return	handle of the name or
+ CITY_NONE if the name is not in the pool
+ */
+unsigned cityFind (const char* name)
+{
+	//	Local Declarations
+    unsigned slot;
+
+	//	Statements
+    if (cityPool.indexSize == 0)
+        return CITY_NONE;
+
+    slot = _hashName(name) & (cityPool.indexSize - 1);
+    while (cityPool.index[slot] != 0)
+    {
+        if (strcmp(cityName(cityPool.index[slot] - 1), name) == 0)
+            return cityPool.index[slot] - 1;
+        slot = (slot + 1) & (cityPool.indexSize - 1);
+    }
+    return CITY_NONE;
+}	// cityFind
+
+
+/*	================== cityRelease =================
+ This function gives back one reference on a name.
+ The last one removes the name from the pool.
+ Pre		handle - handle returned by cityIntern, or
+ CITY_NONE (nothing to release)
+ Post		name is removed if no record uses it
+ Return
+ */
+void cityRelease (unsigned handle)
+{
+	//	Statements
+    if (handle == CITY_NONE || --cityPool.names[handle].refs > 0)
+        return;
+
+    _unlinkName(handle);
+    cityPool.released += (unsigned) strlen(cityName(handle)) + 1;
+    cityPool.names[handle].offset = cityPool.freeHandle;
+    cityPool.freeHandle = handle + 1;
+    cityPool.countNames--;
+
+    // no name left: the buffer and the handles start over
+    if (cityPool.countNames == 0) {
+        cityPool.used = 0;
+        cityPool.released = 0;
+        cityPool.countHandles = 0;
+        cityPool.freeHandle = 0;
+    }
+    return;
+}	// cityRelease
+
+
+/*	================== cityName =================
+ This function returns the text of a city handle.
+ The text lives inside the pool and must not be freed.
+ Pre		handle - handle returned by cityIntern
+ Post
+ Return	pointer to the city name
+ */
+const char* cityName (unsigned handle)
+{
+	//	Statements
+    return cityPool.buffer + cityPool.names[handle].offset;
+}	// cityName
+
+
+/*	================== cityPoolState =================
+ This function gives access to the pool itself, so a
+ prebuilt pool can be saved or installed as a whole.
+ Pre
+ Post
+ Return	pointer to the pool
+ */
+STR_POOL* cityPoolState (void)
+{
+	//	Statements
+    return &cityPool;
+}	// cityPoolState
+
+
+/*	================== cityPoolDestroy =================
+ This function frees the whole pool. Every handle given
+ out before becomes invalid.
+ Pre
+ Post		pool is empty
+ Return
+ */
+void cityPoolDestroy (void)
+{
+	//	Statements
+    memFree(MEM_STRING, cityPool.buffer, cityPool.capacity);
+    memFree(MEM_STRING, cityPool.names, cityPool.nameCapacity * sizeof(STR_NAME));
+    memFree(MEM_STRING, cityPool.index, cityPool.indexSize * sizeof(unsigned));
+    memset(&cityPool, 0, sizeof(STR_POOL));
+    return;
+}	// cityPoolDestroy
+
+
+/*	================== _hashName =================
+ FNV-1a hash of a city name.
+ Pre		name - '\0' terminated string
+ Return	32-bit hash value
+ */
+static unsigned _hashName (const char* name)
+{
+	//	Local Declarations
+    unsigned hash = 2166136261u;
+
+	//	Statements
+    while (*name)
+    {
+        hash ^= (unsigned char) *name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}	// _hashName
+
+
+/*	================== _growIndex =================
+ Doubles the lookup index of the pool and places the
+ existing handles again.
+ Pre		pool index is at least half full
+ Post		index is twice as large
+ */
+static void _growIndex (void)
+{
+	//	Local Declarations
+    unsigned* newIndex;
+    unsigned newSize;
+    unsigned slot;
+    unsigned i;
+
+	//	Statements
+    newSize = cityPool.indexSize ? cityPool.indexSize * 2 : POOL_INDEX_START;
+    if (!(newIndex = (unsigned*) memCalloc(MEM_STRING, newSize, sizeof(unsigned)))) {
+        printf("Error allocating city pool\n");
+        exit(110);
+    }
+
+    for (i = 0; i < cityPool.indexSize; i++)
+    {
+        if (cityPool.index[i] != 0)
+        {
+            slot = _hashName(cityName(cityPool.index[i] - 1)) & (newSize - 1);
+            while (newIndex[slot] != 0)
+                slot = (slot + 1) & (newSize - 1);
+            newIndex[slot] = cityPool.index[i];
+        }
+    }
+
+    memFree(MEM_STRING, cityPool.index, cityPool.indexSize * sizeof(unsigned));
+    cityPool.index = newIndex;
+    cityPool.indexSize = newSize;
+    return;
+}	// _growIndex
+
+
+/*	================== _growBuffer =================
+ Makes room for a name of length bytes. When at least
+ half of the buffer is released names, only the live
+ names are copied, packed, into a buffer sized for
+ them (which may be smaller). Otherwise the buffer is
+ doubled.
+ Pre		length - bytes of the name, with its '\0'
+ Post		buffer has room for the name
+ */
+static void _growBuffer (unsigned length)
+{
+	//	Local Declarations
+    char* newBuffer;
+    unsigned newCapacity;
+    unsigned newUsed = 0;
+    unsigned size;
+    unsigned i;
+    bool pack;
+
+	//	Statements
+    pack = cityPool.released * 2 >= cityPool.used;
+    if (pack) {
+        newCapacity = POOL_BUFFER_START;
+        while (cityPool.used - cityPool.released + length > newCapacity)
+            newCapacity *= 2;
+    }
+    else {
+        newCapacity = cityPool.capacity;
+        while (cityPool.used + length > newCapacity)
+            newCapacity *= 2;
+    }
+    if (!(newBuffer = (char*) memAlloc(MEM_STRING, newCapacity))) {
+        printf("Error allocating city pool\n");
+        exit(110);
+    }
+
+    if (pack) {
+        for (i = 0; i < cityPool.countHandles; i++)
+        {
+            if (cityPool.names[i].refs > 0)
+            {
+                size = (unsigned) strlen(cityName(i)) + 1;
+                memcpy(newBuffer + newUsed, cityName(i), size);
+                cityPool.names[i].offset = newUsed;
+                newUsed += size;
+            }
+        }
+        cityPool.used = newUsed;
+        cityPool.released = 0;
+    }
+    else
+        memcpy(newBuffer, cityPool.buffer, cityPool.used);
+
+    memFree(MEM_STRING, cityPool.buffer, cityPool.capacity);
+    cityPool.buffer = newBuffer;
+    cityPool.capacity = newCapacity;
+    return;
+}	// _growBuffer
+
+
+/*	================== _newHandle =================
+ Takes a released handle, or the next new one, growing
+ the names table when it is full.
+ Return	unused handle
+ */
+static unsigned _newHandle (void)
+{
+	//	Local Declarations
+    STR_NAME* newNames;
+    unsigned newCapacity;
+    unsigned handle;
+
+	//	Statements
+    if (cityPool.freeHandle != 0) {
+        handle = cityPool.freeHandle - 1;
+        cityPool.freeHandle = cityPool.names[handle].offset;
+        return handle;
+    }
+
+    if (cityPool.countHandles == cityPool.nameCapacity)
+    {
+        newCapacity = cityPool.nameCapacity ? cityPool.nameCapacity * 2 : POOL_NAMES_START;
+        if (!(newNames = (STR_NAME*) memAlloc(MEM_STRING, newCapacity * sizeof(STR_NAME)))) {
+            printf("Error allocating city pool\n");
+            exit(110);
+        }
+        if (cityPool.names)
+            memcpy(newNames, cityPool.names, cityPool.countHandles * sizeof(STR_NAME));
+        memFree(MEM_STRING, cityPool.names, cityPool.nameCapacity * sizeof(STR_NAME));
+        cityPool.names = newNames;
+        cityPool.nameCapacity = newCapacity;
+    }
+    return cityPool.countHandles++;
+}	// _newHandle
+
+
+/*	================== _unlinkName =================
+ Takes a handle out of the lookup index. The entries
+ after it in the probe run are moved back, so no
+ search stops early at the hole.
+ Pre		handle - name in the index
+ Post		handle is no longer found by cityFind
+ */
+static void _unlinkName (unsigned handle)
+{
+	//	Local Declarations
+    unsigned mask = cityPool.indexSize - 1;
+    unsigned hole;
+    unsigned slot;
+    unsigned home;
+
+	//	Statements
+    hole = _hashName(cityName(handle)) & mask;
+    while (cityPool.index[hole] != handle + 1)
+        hole = (hole + 1) & mask;
+
+    for (slot = (hole + 1) & mask; cityPool.index[slot] != 0; slot = (slot + 1) & mask)
+    {
+        // an entry stays when its home is after the hole
+        // (cyclically) and not after its own slot
+        home = _hashName(cityName(cityPool.index[slot] - 1)) & mask;
+        if (hole <= slot ? (hole < home && home <= slot) : (hole < home || home <= slot))
+            continue;
+        cityPool.index[hole] = cityPool.index[slot];
+        hole = slot;
+    }
+    cityPool.index[hole] = 0;
+    return;
+}	// _unlinkName
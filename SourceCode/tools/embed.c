@@ -0,0 +1,329 @@
+/* embed.c
+ Build step that turns an airport data file into a C header
+ holding the whole database, already indexed, as one static
+ structure. A program compiled with EMBEDDED_DATA starts from
+ that structure (see embedded.c) without reading, parsing or
+ allocating anything, and runtime adds and deletes work on it
+ like on a database loaded with buildHead.
+
+ The file is loaded with the program's own functions, then:
+ - the hash table gets the smallest size (from twice the number
+ of airports up) at which no two codes collide, so every code
+ has a slot of its own: a perfect hash
+ - the tree is rebuilt perfectly balanced, each record holding
+ its own node
+ Every structure is then written out as a static initializer
+ listing every field in order, as C89 has no designated
+ initializers.
+
+ Build and run from the SourceCode directory:
+ gcc -DEMBED_TOOL -o embed tools/embed.c *.c
+ ./embed data.txt data_embedded.h
+ gcc -DEMBEDDED_DATA -o airports *.c
+
+ Functions:
+ main
+ collect
+ balance
+ findChain
+ */
+
+#include "../header.h"
+
+#ifdef COMPACT_LINKS
+#error "the embedded database is linked by pointers, build it without COMPACT_LINKS"
+#endif
+
+#define MAX_PERFECT_FACTOR  8   // give up looking for a perfect size at 8 x count
+
+static DATA** sorted;
+static int countSorted;
+static int* leftChild;
+static int* rightChild;
+static int* rankOf;
+static COLLISION** chains;
+static int countChains;
+
+void collect (void* dataPtr);
+int balance (int low, int high);
+int findChain (COLLISION* pNode);
+
+int main (int argc, char* argv[])
+{
+	//	Local Declarations
+    char* fileInput = argc > 1 ? argv[1] : "data.txt";
+    char* fileOutput = argc > 2 ? argv[2] : "data_embedded.h";
+    HEAD* pHeader = NULL;
+    HASH* pHash;
+    STR_POOL* pPool;
+    COLLISION* pWalker;
+    FILE* fpOut;
+    int countRecords;
+    int countCity = 0;
+    int size;
+    int root;
+    int i;
+    int j;
+    char* used;
+
+	//	Statements
+    pHeader = buildHead(pHeader, fileInput);
+    if (!pHeader->pColumns || pHeader->pShards) {
+        printf("The column store must be in use and the hash table not sharded\n");
+        exit(1);
+    }
+    countRecords = BST_Count(pHeader->pTree);
+
+    // smallest table size without collisions
+    used = (char*) malloc(MAX_PERFECT_FACTOR * (countRecords + 1));
+    for (size = 2 * countRecords; size <= MAX_PERFECT_FACTOR * countRecords; size++)
+    {
+        memset(used, 0, size);
+        for (i = 0; i < countRecords; i++) {
+            j = converter(pHeader->pColumns->records[i], size);
+            if (used[j]++)
+                break;
+        }
+        if (i == countRecords)
+            break;
+    }
+    free(used);
+    if (size <= MAX_PERFECT_FACTOR * countRecords && size != pHeader->pHash->arraySize)
+        pHeader->pHash = rehash(pHeader->pHash, size);
+    pHash = pHeader->pHash;
+
+    // balanced tree over the records in key order
+    sorted = (DATA**) malloc((countRecords + 1) * sizeof(DATA*));
+    leftChild = (int*) malloc((countRecords + 1) * sizeof(int));
+    rightChild = (int*) malloc((countRecords + 1) * sizeof(int));
+    rankOf = (int*) malloc((countRecords + 1) * sizeof(int));
+    BST_Traverse(pHeader->pTree, collect);
+    root = balance(0, countRecords - 1);
+    for (i = 0; i < countRecords; i++)
+        rankOf[sorted[i]->row] = i;
+
+    chains = (COLLISION**) malloc((countRecords + 1) * sizeof(COLLISION*));
+    for (i = 0; i < pHash->arraySize; i++)
+        for (pWalker = pHash->pTable[i].pCollision; pWalker; pWalker = pWalker->next)
+            chains[countChains++] = pWalker;
+    for (i = 0; i < pHeader->pCity->count; i++)
+        countCity += pHeader->pCity->entries[i].countRecords;
+    pPool = cityPoolState();
+
+    if (!(fpOut = fopen(fileOutput, "w"))) {
+        printf("Error opening output file\n");
+        exit(2);
+    }
+
+    fprintf(fpOut, "/*\t%s\n Generated by tools/embed.c from %s. Do not edit.\n */\n\n",
+            fileOutput, fileInput);
+    fprintf(fpOut, "#define EMBEDDED_RECORDS %d\n\n", countRecords);
+    fprintf(fpOut, "typedef struct{\n");
+    fprintf(fpOut, "    HEAD       head;\n    HASH       hash;\n    BST_TREE   tree;\n");
+    fprintf(fpOut, "    POOL       chainPool;\n    FILTER     filter;\n    STR_POOL   cityPool;\n");
+    fprintf(fpOut, "    CITY_INDEX cityIndex;\n    COLUMNS    columns;\n");
+    fprintf(fpOut, "    DATA       records[%d];\n", countRecords + 1);
+    fprintf(fpOut, "    HASH_NODE  table[%d];\n", pHash->arraySize);
+    fprintf(fpOut, "    COLLISION  chains[%d];\n", countChains + 1);
+    fprintf(fpOut, "    unsigned char filterCounters[%u];\n",
+            pHash->pFilter ? pHash->pFilter->countBlocks * 64 : 1);
+    fprintf(fpOut, "    char       cityBuffer[%u];\n", pPool->used + 1);
+    fprintf(fpOut, "    STR_NAME   cityNames[%u];\n", pPool->countHandles + 1);
+    fprintf(fpOut, "    unsigned   cityIndexSlots[%u];\n", pPool->indexSize);
+    fprintf(fpOut, "    CITY_ENTRY cityEntries[%d];\n", pHeader->pCity->count + 1);
+    fprintf(fpOut, "    DATA*      cityRecords[%d];\n", countCity + 1);
+    fprintf(fpOut, "    char       columnCodes[%d];\n", 4 * countRecords + 4);
+    fprintf(fpOut, "    float      columnLatitude[%d];\n", countRecords + 1);
+    fprintf(fpOut, "    float      columnLongitude[%d];\n", countRecords + 1);
+    fprintf(fpOut, "    unsigned   columnCity[%d];\n", countRecords + 1);
+    fprintf(fpOut, "    DATA*      columnRecords[%d];\n", countRecords + 1);
+    fprintf(fpOut, "}EMBEDDED_DB;\n\n");
+
+    fprintf(fpOut, "static EMBEDDED_DB embedded = {\n");
+    fprintf(fpOut, "    { &embedded.hash, &embedded.tree, &embedded.cityIndex, &embedded.columns, "
+            "NULL, NULL },\n");
+    fprintf(fpOut, "    { %d, %d, embedded.table, &embedded.chainPool, %s },\n",
+            pHash->arraySize, pHash->countUsed, pHash->pFilter ? "&embedded.filter" : "NULL");
+    fprintf(fpOut, "    { %d, &embedded.records[%d].node, %d },\n",
+            countRecords, sorted[root]->row, pHeader->pTree->changes);
+    fprintf(fpOut, "    { MEM_CHAIN, %u, %d, NULL, NULL, 0, %d },\n",
+            (unsigned) pHash->pChains->objSize, pHash->pChains->perSlab, countChains);
+    if (pHash->pFilter)
+        fprintf(fpOut, "    { embedded.filterCounters, %u, %d, 0, 0, 0 },\n",
+                pHash->pFilter->countBlocks, pHash->pFilter->countKeys);
+    else
+        fprintf(fpOut, "    { NULL, 0, 0, 0, 0, 0 },\n");
+    fprintf(fpOut, "    { embedded.cityBuffer, %u, %u, %u, embedded.cityNames, %u, %u, %u, "
+            "embedded.cityIndexSlots, %u, %u },\n",
+            pPool->used, pPool->used, pPool->released, pPool->countHandles,
+            pPool->countHandles, pPool->freeHandle, pPool->indexSize, pPool->countNames);
+    fprintf(fpOut, "    { %d, %d, embedded.cityEntries, NULL, 0, 0 },\n",
+            pHeader->pCity->count, pHeader->pCity->count);
+    fprintf(fpOut, "    { %d, %d, embedded.columnCodes, embedded.columnLatitude, "
+            "embedded.columnLongitude, embedded.columnCity, embedded.columnRecords },\n",
+            countRecords, countRecords);
+
+    // records, in the order of the column store rows, each with
+    // its tree node
+    fprintf(fpOut, "    {\n");
+    for (i = 0; i < countRecords; i++) {
+        DATA* pData = pHeader->pColumns->records[i];
+        int rank = rankOf[pData->row];
+        fprintf(fpOut, "        { { %uu, ", CODE_KEY(pData->arpCode));
+        if (leftChild[rank] < 0)
+            fprintf(fpOut, "NULL, ");
+        else
+            fprintf(fpOut, "&embedded.records[%d].node, ", sorted[leftChild[rank]]->row);
+        if (rightChild[rank] < 0)
+            fprintf(fpOut, "NULL }, ");
+        else
+            fprintf(fpOut, "&embedded.records[%d].node }, ", sorted[rightChild[rank]]->row);
+        fprintf(fpOut, "\"%s\", %u, %.9gf, %.9gf, %d },\n", pData->arpCode,
+                pData->city, pData->latitude, pData->longitude, pData->row);
+    }
+    fprintf(fpOut, "    },\n");
+
+    fprintf(fpOut, "    {\n");
+    for (i = 0; i < pHash->arraySize; i++) {
+        if (pHash->pTable[i].pData == NULL)
+            fprintf(fpOut, "        { 0, 0, NULL, NULL },\n");
+        else if (pHash->pTable[i].pCollision == NULL)
+            fprintf(fpOut, "        { 0, %uu, &embedded.records[%d], NULL },\n",
+                    pHash->pTable[i].key, pHash->pTable[i].pData->row);
+        else
+            fprintf(fpOut, "        { %d, %uu, &embedded.records[%d], &embedded.chains[%d] },\n",
+                    pHash->pTable[i].countCollision, pHash->pTable[i].key,
+                    pHash->pTable[i].pData->row,
+                    findChain(pHash->pTable[i].pCollision));
+    }
+    fprintf(fpOut, "    },\n");
+
+    fprintf(fpOut, "    {\n");
+    for (i = 0; i < countChains; i++) {
+        fprintf(fpOut, "        { %uu, &embedded.records[%d], ", chains[i]->key, chains[i]->pData->row);
+        if (chains[i]->next)
+            fprintf(fpOut, "&embedded.chains[%d] },\n", findChain(chains[i]->next));
+        else
+            fprintf(fpOut, "NULL },\n");
+    }
+    fprintf(fpOut, "        { 0, NULL, NULL }\n    },\n");
+
+    fprintf(fpOut, "    {");
+    if (pHash->pFilter)
+        for (i = 0; i < (int) pHash->pFilter->countBlocks * 64; i++)
+            fprintf(fpOut, "%s%d,", i % 32 ? "" : "\n        ", pHash->pFilter->counters[i]);
+    else
+        fprintf(fpOut, " 0");
+    fprintf(fpOut, "\n    },\n");
+
+    fprintf(fpOut, "    {");
+    for (i = 0; i < (int) pPool->used; i++)
+        fprintf(fpOut, "%s%d,", i % 16 ? "" : "\n        ", pPool->buffer[i]);
+    fprintf(fpOut, " 0\n    },\n");
+
+    fprintf(fpOut, "    {\n");
+    for (i = 0; i < (int) pPool->countHandles; i++)
+        fprintf(fpOut, "        { %u, %u },\n", pPool->names[i].offset, pPool->names[i].refs);
+    fprintf(fpOut, "        { 0, 0 }\n    },\n");
+
+    fprintf(fpOut, "    {");
+    for (i = 0; i < (int) pPool->indexSize; i++)
+        fprintf(fpOut, "%s%u,", i % 16 ? "" : "\n        ", pPool->index[i]);
+    fprintf(fpOut, "\n    },\n");
+
+    fprintf(fpOut, "    {\n");
+    for (i = 0, j = 0; i < pHeader->pCity->count; i++) {
+        fprintf(fpOut, "        { %u, %d, %d, &embedded.cityRecords[%d] },\n",
+                pHeader->pCity->entries[i].city, pHeader->pCity->entries[i].countRecords,
+                pHeader->pCity->entries[i].countRecords, j);
+        j += pHeader->pCity->entries[i].countRecords;
+    }
+    fprintf(fpOut, "        { 0, 0, 0, NULL }\n    },\n");
+
+    fprintf(fpOut, "    {");
+    for (i = 0; i < pHeader->pCity->count; i++)
+        for (j = 0; j < pHeader->pCity->entries[i].countRecords; j++)
+            fprintf(fpOut, "\n        &embedded.records[%d],", pHeader->pCity->entries[i].records[j]->row);
+    fprintf(fpOut, " NULL\n    },\n");
+
+    fprintf(fpOut, "    {");
+    for (i = 0; i < countRecords; i++)
+        fprintf(fpOut, "%s'%c','%c','%c',0,", i % 8 ? " " : "\n        ",
+                pHeader->pColumns->codes[4 * i], pHeader->pColumns->codes[4 * i + 1],
+                pHeader->pColumns->codes[4 * i + 2]);
+    fprintf(fpOut, " 0\n    },\n");
+
+    fprintf(fpOut, "    {");
+    for (i = 0; i < countRecords; i++)
+        fprintf(fpOut, "%s%.9gf,", i % 8 ? " " : "\n        ", pHeader->pColumns->latitude[i]);
+    fprintf(fpOut, " 0\n    },\n");
+    fprintf(fpOut, "    {");
+    for (i = 0; i < countRecords; i++)
+        fprintf(fpOut, "%s%.9gf,", i % 8 ? " " : "\n        ", pHeader->pColumns->longitude[i]);
+    fprintf(fpOut, " 0\n    },\n");
+    fprintf(fpOut, "    {");
+    for (i = 0; i < countRecords; i++)
+        fprintf(fpOut, "%s%u,", i % 8 ? " " : "\n        ", pHeader->pColumns->city[i]);
+    fprintf(fpOut, " 0\n    },\n");
+    fprintf(fpOut, "    {");
+    for (i = 0; i < countRecords; i++)
+        fprintf(fpOut, "\n        &embedded.records[%d],", i);
+    fprintf(fpOut, " NULL\n    }\n};\n");
+
+    fclose(fpOut);
+    printf("Embedded %d airports, %d hash slots, %d collisions into %s\n",
+           countRecords, pHash->arraySize, countChains, fileOutput);
+
+    free(sorted);
+    free(leftChild);
+    free(rightChild);
+    free(rankOf);
+    free(chains);
+    pHeader = destroy(pHeader);
+    return 0;
+}	// main
+
+
+/*	================== collect =================
+ Traversal callback that lists the records in key order.
+ */
+void collect (void* dataPtr)
+{
+	//	Statements
+    sorted[countSorted++] = (DATA*) dataPtr;
+    return;
+}	// collect
+
+
+/*	================== balance =================
+ Links the sorted nodes low..high into a balanced tree.
+ Return	node at the root of the subtree, -1 if empty
+ */
+int balance (int low, int high)
+{
+	//	Local Declarations
+    int middle;
+
+	//	Statements
+    if (low > high)
+        return -1;
+    middle = (low + high) / 2;
+    leftChild[middle] = balance(low, middle - 1);
+    rightChild[middle] = balance(middle + 1, high);
+    return middle;
+}	// balance
+
+
+/*	================== findChain =================
+ Position of a collision node in the chains array.
+ */
+int findChain (COLLISION* pNode)
+{
+	//	Local Declarations
+    int i;
+
+	//	Statements
+    for (i = 0; i < countChains && chains[i] != pNode; i++)
+        ;
+    return i;
+}	// findChain
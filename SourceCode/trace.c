@@ -0,0 +1,375 @@
+/* trace.c
+ This file contains the definitons of the functions that record
+ the operations typed in the menu to a trace file, and replay a
+ trace at full speed against the database. A trace starts with
+ "ATR1" and holds one record per operation, in the byte order
+ of the machine that wrote it:
+
+ 'F' or 'D'   op (1 byte), code (3 bytes)
+ 'A'          op (1 byte), code (3 bytes), latitude (float),
+              longitude (float), length of the city (1 byte),
+              city (without '\0')
+
+ A replay loads the whole trace first, so the file is not part
+ of the times, then runs the operations one after the other
+ without any output, with the same resizing as the menu, and
+ reports the throughput and the latencies of each kind of
+ operation. The table configuration is the one the program was
+ compiled with (USE_SHARDS, USE_FILTER ...).
+
+ Functions:
+ traceStart
+ traceStop
+ traceActive
+ traceRecord
+ traceReplay
+
+ Private Functions:
+ _loadTrace
+ _replayAdd
+ _reportKind
+ _compareTimes
+ */
+
+#include "header.h"
+
+#define TRACE_MAGIC  "ATR1"
+
+//	One operation of a loaded trace
+typedef struct{
+    char  op;
+    char  arpCode[4];
+    char  city[20];
+    float latitude;
+    float longitude;
+}TRACE_OP;
+
+static FILE* traceFile;
+static int traceCount;
+
+static TRACE_OP* _loadTrace (const char* fileName, int* countOps, int* capacity);
+static bool _replayAdd (HEAD* pHeader, TRACE_OP* pOp);
+static void _reportKind (const char* name, char op, TRACE_OP* ops, unsigned long long* times,
+                         int countOps, int hits);
+static int _compareTimes (const void* time1, const void* time2);
+
+/*	================== traceStart =================
+ This function starts recording the operations of the
+ menu to a new trace file.
+ Pre		fileName - name of the trace file
+ Post		file is created
+ Return	true if the file could be created
+ */
+bool traceStart (const char* fileName)
+{
+	//	Statements
+    traceStop();
+    if (!(traceFile = fopen(fileName, "wb")))
+        return false;
+    fwrite(TRACE_MAGIC, 1, 4, traceFile);
+    traceCount = 0;
+    return true;
+}	// traceStart
+
+
+/*	================== traceStop =================
+ This function stops recording and closes the trace.
+ Pre
+ Post		trace file is closed
+ Return	number of operations recorded, -1 if the
+ trace could not be written completely
+ */
+int traceStop (void)
+{
+	//	Local Declarations
+    bool written;
+
+	//	Statements
+    if (!traceFile)
+        return 0;
+    written = !ferror(traceFile);
+    if (fclose(traceFile) != 0)
+        written = false;
+    traceFile = NULL;
+    return written ? traceCount : -1;
+}	// traceStop
+
+
+/*	================== traceActive =================
+ This function tells whether operations are recorded.
+ Pre
+ Post
+ Return	true if recording
+ */
+bool traceActive (void)
+{
+	//	Statements
+    return traceFile != NULL;
+}	// traceActive
+
+
+/*	================== traceRecord =================
+ This function appends one operation to the trace.
+ Pre		op - 'A', 'F' or 'D'
+ pData - record added, or target of a find or
+ delete (only its code is used)
+ Post		operation is recorded
+ Return
+ */
+void traceRecord (char op, DATA* pData)
+{
+	//	Local Declarations
+    char code[3];
+    const char* city;
+    unsigned char length;
+    int i;
+
+	//	Statements
+    if (!traceFile)
+        return;
+    memset(code, 0, sizeof(code));
+    for (i = 0; i < 3 && pData->arpCode[i]; i++)
+        code[i] = toupper(pData->arpCode[i]);
+    fputc(op, traceFile);
+    fwrite(code, 1, 3, traceFile);
+    if (op == 'A')
+    {
+        city = cityName(pData->city);
+        length = (unsigned char) (strlen(city) < 19 ? strlen(city) : 19);
+        fwrite(&pData->latitude, sizeof(float), 1, traceFile);
+        fwrite(&pData->longitude, sizeof(float), 1, traceFile);
+        fputc(length, traceFile);
+        fwrite(city, 1, length, traceFile);
+    }
+    traceCount++;
+    return;
+}	// traceRecord
+
+
+/*	================== traceReplay =================
+ This function runs every operation of a trace against
+ the database and prints the throughput and latencies.
+ Pre		pHeader - pointer to HEAD structure
+ fileName - name of the trace file
+ Post		database holds the result of the trace
+ Return	false if the trace could not be read
+ */
+bool traceReplay (HEAD* pHeader, const char* fileName)
+{
+	//	Local Declarations
+    TRACE_OP* ops;
+    TRACE_OP* pOp;
+    DATA target;
+    DATA* pData;
+    unsigned long long* times;
+    unsigned long long begin;
+    unsigned long long start;
+    unsigned long long elapsed;
+    int countOps;
+    int capacity;
+    int added = 0;
+    int found = 0;
+    int deleted = 0;
+    int i;
+
+	//	Statements
+    if (!(ops = _loadTrace(fileName, &countOps, &capacity)))
+        return false;
+    if (!(times = (unsigned long long*) memAlloc(MEM_INDEX, (countOps + 1) * sizeof(unsigned long long)))) {
+        printf("Memory allocation error\n");
+        exit(100);
+    }
+
+    begin = latencyClock();
+    for (i = 0; i < countOps; i++)
+    {
+        pOp = &ops[i];
+        start = latencyClock();
+        strcpy(target.arpCode, pOp->arpCode);
+        if (pHeader->pShards)
+            pData = shardFind(pHeader->pShards, &target);
+        else
+            pData = findHash(pHeader->pHash, &target);
+        switch (pOp->op)
+        {
+            case 'A':
+                if (!pData && _replayAdd(pHeader, pOp))
+                    added++;
+                break;
+            case 'D':
+                if (pData && deleteRecord(pHeader, pData))
+                {
+                    while (pHeader->pHash && checkHash(pHeader->pHash) == -1)
+                        pHeader->pHash = downsizeHash(pHeader->pHash);
+                    deleted++;
+                }
+                break;
+            default:
+                if (pData)
+                    found++;
+                break;
+        }
+        times[i] = latencyClock() - start;
+    }
+    elapsed = latencyClock() - begin;
+    if (pHeader->pFrozen)
+        pHeader->pFrozen = frozenBuild(pHeader->pFrozen, pHeader->pTree);
+
+    printf("\nReplayed %d operations in %.3f ms: %.0f operations per second.\n",
+           countOps, elapsed / 1e6, elapsed ? countOps * 1e9 / elapsed : 0.0);
+    printf("Operation        Calls      Hits  p50 (us)  p90 (us)  p99 (us)  max (us)\n");
+    _reportKind("Add", 'A', ops, times, countOps, added);
+    _reportKind("Find", 'F', ops, times, countOps, found);
+    _reportKind("Delete", 'D', ops, times, countOps, deleted);
+    printf("\n");
+
+    memFree(MEM_INDEX, times, (countOps + 1) * sizeof(unsigned long long));
+    memFree(MEM_INDEX, ops, capacity * sizeof(TRACE_OP));
+    return true;
+}	// traceReplay
+
+
+/*	================== _loadTrace =================
+ Reads a whole trace file into an array of operations
+ with room for capacity of them. Returns NULL (with a
+ message) if the file cannot be read or is not a trace.
+ */
+static TRACE_OP* _loadTrace (const char* fileName, int* countOps, int* capacity)
+{
+	//	Local Declarations
+    FILE* fpIn;
+    TRACE_OP* ops;
+    TRACE_OP* pOp;
+    unsigned char* buffer;
+    long size;
+    long pos = 4;
+    int length;
+
+	//	Statements
+    if (!(fpIn = fopen(fileName, "rb"))) {
+        printf("Error opening trace file %s\n", fileName);
+        return NULL;
+    }
+    fseek(fpIn, 0, SEEK_END);
+    size = ftell(fpIn);
+    fseek(fpIn, 0, SEEK_SET);
+    *capacity = (int) (size / 4 + 1);
+    if (!(buffer = (unsigned char*) memAlloc(MEM_INDEX, size + 1)) ||
+        !(ops = (TRACE_OP*) memAlloc(MEM_INDEX, *capacity * sizeof(TRACE_OP)))) {
+        printf("Memory allocation error\n");
+        exit(100);
+    }
+    if (size < 4 || fread(buffer, 1, size, fpIn) != (size_t) size ||
+        memcmp(buffer, TRACE_MAGIC, 4) != 0)
+    {
+        printf("%s is not a trace file\n", fileName);
+        fclose(fpIn);
+        memFree(MEM_INDEX, buffer, size + 1);
+        memFree(MEM_INDEX, ops, *capacity * sizeof(TRACE_OP));
+        return NULL;
+    }
+    fclose(fpIn);
+
+    *countOps = 0;
+    while (pos + 4 <= size)
+    {
+        pOp = &ops[*countOps];
+        pOp->op = buffer[pos];
+        if (pOp->op != 'A' && pOp->op != 'F' && pOp->op != 'D')
+            break;
+        memcpy(pOp->arpCode, buffer + pos + 1, 3);
+        pOp->arpCode[3] = '\0';
+        pos += 4;
+        if (pOp->op == 'A')
+        {
+            if (pos + (long) (2 * sizeof(float)) + 1 > size)
+                break;
+            memcpy(&pOp->latitude, buffer + pos, sizeof(float));
+            memcpy(&pOp->longitude, buffer + pos + sizeof(float), sizeof(float));
+            pos += 2 * sizeof(float);
+            length = buffer[pos++];
+            if (length > 19 || pos + length > size)
+                break;
+            memcpy(pOp->city, buffer + pos, length);
+            pOp->city[length] = '\0';
+            pos += length;
+        }
+        (*countOps)++;
+    }
+    if (pos < size)
+        printf("The trace %s is cut short after %d operations.\n", fileName, *countOps);
+
+    memFree(MEM_INDEX, buffer, size + 1);
+    return ops;
+}	// _loadTrace
+
+
+/*	================== _replayAdd =================
+ Adds the record of an 'A' operation to the database
+ and grows the hash table like the menu does.
+ */
+static bool _replayAdd (HEAD* pHeader, TRACE_OP* pOp)
+{
+	//	Local Declarations
+    DATA* newAirport;
+
+	//	Statements
+    if (!(newAirport = recordAlloc())) {
+        printf("Error allocating new airport\n");
+        exit(100);
+    }
+    strcpy(newAirport->arpCode, pOp->arpCode);
+    newAirport->city = cityIntern(pOp->city);
+    newAirport->latitude = pOp->latitude;
+    newAirport->longitude = pOp->longitude;
+    insertRecord(pHeader, newAirport);
+    while (pHeader->pHash && checkHash(pHeader->pHash) == 1)
+        pHeader->pHash = upsizeHash(pHeader->pHash);
+    return true;
+}	// _replayAdd
+
+
+/*	================== _reportKind =================
+ Prints the number of calls, hits and the latency
+ percentiles of one kind of operation.
+ */
+static void _reportKind (const char* name, char op, TRACE_OP* ops, unsigned long long* times,
+                         int countOps, int hits)
+{
+	//	Local Declarations
+    unsigned long long* kind;
+    int count = 0;
+    int i;
+
+	//	Statements
+    if (!(kind = (unsigned long long*) memAlloc(MEM_INDEX, (countOps + 1) * sizeof(unsigned long long)))) {
+        printf("Memory allocation error\n");
+        exit(100);
+    }
+    for (i = 0; i < countOps; i++)
+        if (ops[i].op == op)
+            kind[count++] = times[i];
+    if (count > 0)
+    {
+        qsort(kind, count, sizeof(unsigned long long), _compareTimes);
+        printf("%-12s %9d %9d %9.2f %9.2f %9.2f %9.2f\n", name, count, hits,
+               kind[(count - 1) / 2] / 1000.0, kind[(int) ((count - 1) * 0.9)] / 1000.0,
+               kind[(int) ((count - 1) * 0.99)] / 1000.0, kind[count - 1] / 1000.0);
+    }
+    memFree(MEM_INDEX, kind, (countOps + 1) * sizeof(unsigned long long));
+    return;
+}	// _reportKind
+
+
+/*	================== _compareTimes =================
+ qsort order of the latencies: shortest first.
+ */
+static int _compareTimes (const void* time1, const void* time2)
+{
+	//	Local Declarations
+    unsigned long long t1 = *(const unsigned long long*) time1;
+    unsigned long long t2 = *(const unsigned long long*) time2;
+
+	//	Statements
+    return t1 < t2 ? -1 : t1 > t2;
+}	// _compareTimes
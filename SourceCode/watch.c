@@ -0,0 +1,168 @@
+/* watch.c
+ This file contains the definitons of the functions that watch
+ a data file for changes, so the menu can bring the database in
+ line with it (syncFile) before running the next command. On
+ Linux the directory of the file is watched through inotify,
+ which reports a file written and closed, or renamed over the
+ old one as editors do when they save; the events are read
+ without waiting. Elsewhere, or if inotify cannot be used, the
+ time the file was last changed is compared instead.
+
+ Functions:
+ watchStart
+ watchStop
+ watchActive
+ watchFile
+ watchChanged
+ */
+
+#include "header.h"
+#include <sys/stat.h>
+#include <time.h>
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#define WATCH_INOTIFY
+#endif
+
+static char watchName[128];     // file watched, "" for none
+static time_t watchModified;    // last change seen by the fallback
+#ifdef WATCH_INOTIFY
+static int watchFd = -1;
+static const char* watchBase;   // name of the file in its directory
+#endif
+
+/*	================== watchStart =================
+ This function starts watching a data file.
+ Pre		fileName - name of the file
+ Post		changes of the file are noticed from now on
+ Return	false if the file does not exist
+ */
+bool watchStart (const char* fileName)
+{
+	//	Local Declarations
+    struct stat info;
+#ifdef WATCH_INOTIFY
+    char directory[128];
+    const char* slash;
+#endif
+
+	//	Statements
+    watchStop();
+    if (stat(fileName, &info) != 0 || strlen(fileName) >= sizeof(watchName))
+        return false;
+    strcpy(watchName, fileName);
+    watchModified = info.st_mtime;
+
+#ifdef WATCH_INOTIFY
+    slash = strrchr(watchName, '/');
+    watchBase = slash ? slash + 1 : watchName;
+    if (!slash)
+        strcpy(directory, ".");
+    else if (slash == watchName)
+        strcpy(directory, "/");
+    else {
+        memcpy(directory, watchName, slash - watchName);
+        directory[slash - watchName] = '\0';
+    }
+    if ((watchFd = inotify_init1(IN_NONBLOCK)) >= 0 &&
+        inotify_add_watch(watchFd, directory, IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        close(watchFd);
+        watchFd = -1;
+    }
+#endif
+    return true;
+}	// watchStart
+
+
+/*	================== watchStop =================
+ This function stops watching the file.
+ Pre
+ Post		no file is watched
+ Return
+ */
+void watchStop (void)
+{
+	//	Statements
+#ifdef WATCH_INOTIFY
+    if (watchFd >= 0)
+        close(watchFd);
+    watchFd = -1;
+#endif
+    watchName[0] = '\0';
+    return;
+}	// watchStop
+
+
+/*	================== watchActive =================
+ This function tells whether a file is watched.
+ Pre
+ Post
+ Return	true if watching
+ */
+bool watchActive (void)
+{
+	//	Statements
+    return watchName[0] != '\0';
+}	// watchActive
+
+
+/*	================== watchFile =================
+ This function gives the name of the watched file.
+ Pre
+ Post
+ Return	name of the file, "" if none
+ */
+const char* watchFile (void)
+{
+	//	Statements
+    return watchName;
+}	// watchFile
+
+
+/*	================== watchChanged =================
+ This function tells, without waiting, whether the
+ watched file changed since the last call.
+ Pre
+ Post		pending events are consumed
+ Return	true if the file changed
+ */
+bool watchChanged (void)
+{
+	//	Local Declarations
+    struct stat info;
+#ifdef WATCH_INOTIFY
+    union {
+        struct inotify_event event;
+        char bytes[4096];
+    }buffer;
+    struct inotify_event* pEvent;
+    bool changed = false;
+    ssize_t length;
+    ssize_t pos;
+#endif
+
+	//	Statements
+    if (!watchName[0])
+        return false;
+#ifdef WATCH_INOTIFY
+    if (watchFd >= 0)
+    {
+        while ((length = read(watchFd, buffer.bytes, sizeof(buffer))) > 0)
+        {
+            for (pos = 0; pos < length; pos += sizeof(struct inotify_event) + pEvent->len)
+            {
+                pEvent = (struct inotify_event*) (buffer.bytes + pos);
+                if (pEvent->len && strcmp(pEvent->name, watchBase) == 0)
+                    changed = true;
+            }
+        }
+        return changed;
+    }
+#endif
+    if (stat(watchName, &info) == 0 && info.st_mtime != watchModified) {
+        watchModified = info.st_mtime;
+        return true;
+    }
+    return false;
+}	// watchChanged